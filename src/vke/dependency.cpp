@@ -4,15 +4,151 @@
 
 #include "dependency.hpp"
 
+#include "vke/global.hpp"
+#include "vke/vke.hpp"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
 namespace vke {
-    Ownable::~Ownable() {
-        for (const auto child : m_Children) {
-            delete child;
+    namespace {
+        // Blocks come in multiples of 64 bytes up to 1 KiB, carved out of 64 KiB slabs which are kept for the lifetime of the process. Anything
+        // larger goes to the global heap.
+        constexpr std::size_t GRANULE     = 64;
+        constexpr std::size_t CLASS_COUNT = 16;
+        constexpr std::size_t SLAB_SIZE   = 64 * 1024;
+
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        struct Pool {
+            std::mutex                          mutex;
+            std::array<FreeBlock*, CLASS_COUNT> free{};
+        };
+
+        Pool& pool() {
+            // Never destroyed: an Ownable held by a global may be destroyed after the function local statics are.
+            static auto* pool = new Pool();
+            return *pool;
+        }
+
+        std::size_t size_class(const std::size_t size) {
+            return (std::max<std::size_t>(size, 1) + GRANULE - 1) / GRANULE - 1;
+        }
+    } // namespace
+
+    void* Ownable::operator new(const std::size_t size) {
+        const std::size_t index = size_class(size);
+        if (index >= CLASS_COUNT) { return ::operator new(size); }
+
+        auto&            pool = vke::pool();
+        std::scoped_lock lock(pool.mutex);
+        if (!pool.free[index]) {
+            const std::size_t block_size = (index + 1) * GRANULE;
+            auto*             slab       = static_cast<std::byte*>(::operator new(SLAB_SIZE));
+            for (std::size_t offset = 0; offset + block_size <= SLAB_SIZE; offset += block_size) {
+                pool.free[index] = ::new (slab + offset) FreeBlock{pool.free[index]};
+            }
         }
+
+        FreeBlock* block = pool.free[index];
+        pool.free[index] = block->next;
+        return block;
+    }
+
+    void Ownable::operator delete(void* pointer, const std::size_t size) noexcept {
+        if (!pointer) { return; }
+
+        const std::size_t index = size_class(size);
+        if (index >= CLASS_COUNT) {
+            ::operator delete(pointer);
+            return;
+        }
+
+        auto&            pool = vke::pool();
+        std::scoped_lock lock(pool.mutex);
+        pool.free[index] = ::new (pointer) FreeBlock{pool.free[index]};
+    }
+
+    Ownable::~Ownable() {
+        destroy_children();
+        if (m_Owner) { m_Owner->unlink(*this); }
     }
 
     void Ownable::owns(std::unique_ptr<Ownable> object) {
-        object->m_Owner = this;
-        m_Children.emplace_back(object.release());
+        link(*object.release());
+    }
+
+    std::unique_ptr<Ownable> Ownable::release(Ownable& child) {
+        if (child.m_Owner != this) { throw std::invalid_argument("Object is not owned by this object"); }
+
+        unlink(child);
+        return std::unique_ptr<Ownable>(&child);
+    }
+
+    void Ownable::transfer(Ownable& child, Ownable& new_owner) {
+        if (child.m_Owner != this) { throw std::invalid_argument("Object is not owned by this object"); }
+        for (const Ownable* ancestor = &new_owner; ancestor; ancestor = ancestor->m_Owner) {
+            if (ancestor == &child) { throw std::invalid_argument("An object can't be owned by one of its descendants"); }
+        }
+
+        unlink(child);
+        new_owner.link(child);
+    }
+
+    void Ownable::destroy_children() {
+        while (m_FirstChild) { delete m_FirstChild; }
+    }
+
+    void Ownable::retire_children() {
+        if (!m_FirstChild) { return; }
+        if (!global::g_Device) {
+            destroy_children();
+            return;
+        }
+
+        // The whole list moves to a holder at once, only the children's owner has to be set one by one.
+        auto* holder = new Ownable();
+        for (Ownable* child = m_FirstChild; child; child = child->m_NextSibling) { child->m_Owner = holder; }
+        holder->m_FirstChild = std::exchange(m_FirstChild, nullptr);
+        holder->m_LastChild  = std::exchange(m_LastChild, nullptr);
+        holder->m_ChildCount = std::exchange(m_ChildCount, 0);
+
+        global::g_Device->defer([holder] { delete holder; });
+    }
+
+    void Ownable::link(Ownable& child) {
+        child.m_Owner       = this;
+        child.m_PrevSibling = m_LastChild;
+        child.m_NextSibling = nullptr;
+        if (m_LastChild) {
+            m_LastChild->m_NextSibling = &child;
+        } else {
+            m_FirstChild = &child;
+        }
+        m_LastChild = &child;
+        m_ChildCount++;
+    }
+
+    void Ownable::unlink(Ownable& child) noexcept {
+        if (child.m_PrevSibling) {
+            child.m_PrevSibling->m_NextSibling = child.m_NextSibling;
+        } else {
+            m_FirstChild = child.m_NextSibling;
+        }
+        if (child.m_NextSibling) {
+            child.m_NextSibling->m_PrevSibling = child.m_PrevSibling;
+        } else {
+            m_LastChild = child.m_PrevSibling;
+        }
+        child.m_Owner       = nullptr;
+        child.m_PrevSibling = nullptr;
+        child.m_NextSibling = nullptr;
+        m_ChildCount--;
     }
 } // namespace vke
@@ -3,20 +3,63 @@
 //
 
 #pragma once
+#include <cstddef>
 #include <memory>
-#include <vector>
 
 #include "vke/pre.hpp"
 
 namespace vke {
+    /**
+     * A node of an ownership tree: an Ownable destroys the objects it owns when it is destroyed, in the order it was given them.
+     *
+     * Children are linked through their siblings, so owning, releasing and moving a child to another owner are O(1), and a child destroyed
+     * by other means unlinks itself. Ownables are allocated from pools of fixed size blocks shared by the whole engine, so a tree of many
+     * small objects doesn't go through the general purpose heap for each of them.
+     *
+     * Not thread safe: a tree is built and torn down on one thread.
+     */
     class VKE_API Ownable {
       public:
+        Ownable() = default;
         virtual ~Ownable();
 
+        Ownable(const Ownable&)            = delete;
+        Ownable& operator=(const Ownable&) = delete;
+
         void owns(std::unique_ptr<Ownable> object);
 
+        // Hands a child back to the caller. Throws std::invalid_argument if it isn't one of this object's children.
+        std::unique_ptr<Ownable> release(Ownable& child);
+
+        // Moves a child to another owner, as its last child. Throws std::invalid_argument if it isn't one of this object's children, or if the
+        // new owner is the child or one of its descendants.
+        void transfer(Ownable& child, Ownable& new_owner);
+
+        void destroy_children();
+
+        /**
+         * Detaches every child at once and destroys them from the device's deferred queue, once the GPU has finished what was submitted so far,
+         * instead of making the caller wait on each of them. Only for children nothing else refers to any more: a child listening to this
+         * object's signals, or pushed to the renderer stack, has to be destroyed with destroy_children(). Destroys them right away if there is
+         * no device.
+         */
+        void retire_children();
+
+        [[nodiscard]] inline Ownable*    owner() const noexcept { return m_Owner; }
+        [[nodiscard]] inline std::size_t child_count() const noexcept { return m_ChildCount; }
+
+        static void* operator new(std::size_t size);
+        static void  operator delete(void* pointer, std::size_t size) noexcept;
+
       private:
-        std::vector<Ownable*> m_Children;
-        Ownable*              m_Owner = nullptr;
+        void link(Ownable& child);
+        void unlink(Ownable& child) noexcept;
+
+        Ownable*    m_Owner       = nullptr;
+        Ownable*    m_FirstChild  = nullptr;
+        Ownable*    m_LastChild   = nullptr;
+        Ownable*    m_PrevSibling = nullptr;
+        Ownable*    m_NextSibling = nullptr;
+        std::size_t m_ChildCount  = 0;
     };
 } // namespace vke
@@ -0,0 +1,60 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#include "vke/event_queue.hpp"
+
+namespace vke {
+    EventQueue::~EventQueue() {
+        for (Posted* posted = m_Posted.exchange(nullptr, std::memory_order_acquire); posted;) { delete std::exchange(posted, posted->next); }
+    }
+
+    void EventQueue::resize(const vk::Extent2D extent) {
+        if (m_Resize) { m_Coalesced++; }
+        m_Resize = extent;
+    }
+
+    void EventQueue::input(const InputEvent& event) {
+        if (event.type == InputEventType::MouseMove && !m_Input.empty() && m_Input.back().type == InputEventType::MouseMove) {
+            m_Input.back() = event;
+            m_Coalesced++;
+            return;
+        }
+        m_Input.push_back(event);
+    }
+
+    void EventQueue::post(const InputEvent& event) {
+        post([this, event] { input(event); });
+    }
+
+    void EventQueue::post(callback_t callback) {
+        auto* posted = new Posted{m_Posted.load(std::memory_order_relaxed), std::move(callback)};
+        while (!m_Posted.compare_exchange_weak(posted->next, posted, std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+
+    void EventQueue::run_posted() {
+        // Taken all at once, so the only contention is between posting threads. Reversed to run in the order they were posted.
+        Posted* posted = m_Posted.exchange(nullptr, std::memory_order_acquire);
+        Posted* oldest = nullptr;
+        while (posted) {
+            Posted* next = posted->next;
+            posted->next = oldest;
+            oldest       = std::exchange(posted, next);
+        }
+
+        while (oldest) {
+            oldest->callback();
+            delete std::exchange(oldest, oldest->next);
+        }
+    }
+
+    std::optional<vk::Extent2D> EventQueue::take_resize() {
+        return std::exchange(m_Resize, std::nullopt);
+    }
+
+    std::span<const InputEvent> EventQueue::take_input() {
+        m_Dispatching.clear();
+        std::swap(m_Input, m_Dispatching);
+        return m_Dispatching;
+    }
+} // namespace vke
@@ -0,0 +1,85 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include <atomic>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace vke {
+    enum class InputEventType : uint8_t {
+        KeyDown,
+        KeyUp,
+        Char,
+        MouseMove,
+        MouseButtonDown,
+        MouseButtonUp,
+        MouseWheel,
+        FocusGained,
+        FocusLost,
+    };
+
+    struct InputEvent {
+        InputEventType type;
+        uint32_t       code     = 0;  // virtual key, UTF-16 code unit, or mouse button (0 left, 1 right, 2 middle, 3 and 4 the side buttons)
+        glm::ivec2     position = {}; // of the cursor, in client coordinates, for mouse events
+        float          wheel    = 0;  // notches, positive away from the user
+    };
+
+    /**
+     * Holds a window's events between the OS handing them over and the engine dispatching them, once per frame, right after the OS is polled.
+     *
+     * Events are coalesced on the way in: only the last resize of a frame is kept, and mouse moves following each other become one. Input
+     * events are dispatched in one batch, in the order they came in. Both are main thread only, as that's where the OS delivers them.
+     *
+     * Any thread may post input events or callbacks. They go through a lock-free queue and are run on the main thread at the start of the next
+     * dispatch, before the batch is handed out, so posted input lands in the same batch as the OS's.
+     */
+    class VKE_API EventQueue {
+      public:
+        using callback_t = InlineFunction<void()>;
+
+        EventQueue() = default;
+        ~EventQueue();
+
+        EventQueue(const EventQueue&)            = delete;
+        EventQueue& operator=(const EventQueue&) = delete;
+
+        void resize(vk::Extent2D extent);
+        void input(const InputEvent& event);
+
+        // Thread safe.
+        void post(const InputEvent& event);
+        void post(callback_t callback);
+
+        // Runs what was posted since the last call. Main thread.
+        void run_posted();
+
+        // Main thread. The span stays valid until the next call, input queued while it is being dispatched goes into the next batch.
+        [[nodiscard]] std::optional<vk::Extent2D> take_resize();
+        [[nodiscard]] std::span<const InputEvent> take_input();
+
+        // Events that never reached a listener because a later one replaced them.
+        [[nodiscard]] inline uint64_t coalesced_count() const noexcept { return m_Coalesced; }
+
+      private:
+        struct Posted {
+            Posted*    next;
+            callback_t callback;
+        };
+
+        std::optional<vk::Extent2D> m_Resize;
+        std::vector<InputEvent>     m_Input;
+        std::vector<InputEvent>     m_Dispatching; // swapped with m_Input, so neither gives its memory back
+        uint64_t                    m_Coalesced = 0;
+
+        std::atomic<Posted*> m_Posted = nullptr; // newest first
+    };
+} // namespace vke
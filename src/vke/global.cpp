@@ -4,6 +4,8 @@
 
 #include "global.hpp"
 
+#include "vke/resource/handle.hpp"
+#include "vke/utils/job_system.hpp"
 #include "vke/vke.hpp"
 
 namespace vke::global {
@@ -14,4 +16,7 @@ namespace vke::global {
     int                            g_ExitCode  = 0;
     std::shared_ptr<WindowManager> g_WindowManager;
     std::shared_ptr<RendererStack> g_RendererStack;
+    std::shared_ptr<JobSystem>     g_JobSystem;
+    // Constant initialized, so handles resolve (to nullptr) even from other translation units' static initializers.
+    constinit res::ResourceSlotMap g_ResourceSlots;
 } // namespace vke::global
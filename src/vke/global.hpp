@@ -6,6 +6,10 @@
 
 #include "pre.hpp"
 
+namespace vke::res {
+    class VKE_API ResourceSlotMap;
+} // namespace vke::res
+
 namespace vke::global {
     extern VKE_API std::shared_ptr<Instance> g_Instance;
     extern VKE_API std::optional<PhysicalDevice> g_PhysicalDevice;
@@ -14,4 +18,6 @@ namespace vke::global {
     extern VKE_API int                     g_ExitCode;
     extern VKE_API std::shared_ptr<WindowManager> g_WindowManager;
     extern VKE_API std::shared_ptr<RendererStack> g_RendererStack;
+    extern VKE_API std::shared_ptr<JobSystem> g_JobSystem;
+    extern VKE_API res::ResourceSlotMap       g_ResourceSlots;
 } // namespace vke::global
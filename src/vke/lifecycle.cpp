@@ -6,6 +6,7 @@
 
 #include "vke/global.hpp"
 #include "vke/renderer/renderer.hpp"
+#include "vke/utils/job_system.hpp"
 #include "vke/window.hpp"
 #include "vke/window_manager.hpp"
 
@@ -33,16 +34,22 @@ namespace vke::lifecycle {
 
     Signal<void()> vulkan_is_available;
 
+    Signal<void()> device_ready;
+    Signal<void()> device_cleanup;
+
     namespace internal {
         Signal<void(const std::shared_ptr<Window>&)> register_new_window;
         Signal<void()>                               post_instance;
         Signal<void()>                               post_physical_device;
         Signal<void()>                               post_device;
         Signal<void()>                               os_poll;
+        Signal<void()>                               dispatch_events;
     } // namespace internal
 
     void setup_listeners() {
         start.append([] {
+            global::g_JobSystem = std::make_shared<JobSystem>();
+
             load_vulkan();
             vulkan_is_available();
 
@@ -62,6 +69,8 @@ namespace vke::lifecycle {
 
             global::g_WindowManager = std::make_shared<WindowManager>();
             global::g_RendererStack = std::make_shared<RendererStack>();
+
+            device_ready();
         });
 
         cleanup.append([] {
@@ -71,17 +80,26 @@ namespace vke::lifecycle {
             global::g_RendererStack.reset();
             global::g_WindowManager.reset();
 
+            device_cleanup();
+
+            // Retired objects in the deferred queue keep the device alive, it would never be destroyed with them still in there.
+            global::g_Device->drain();
             global::g_Device.reset();
             global::g_PhysicalDevice.reset();
             global::g_Instance.reset();
+
+            global::g_JobSystem.reset();
         });
 
         internal::register_new_window.append([](const std::shared_ptr<Window>& window) {
             window->register_listener(internal::os_poll, internal::os_poll.append([window = window->weak_from_this()] {
                 if (!window.lock()->process_events()) global::g_WantsQuit = true;
             }));
+            window->register_listener(internal::dispatch_events, internal::dispatch_events.append([window = window->weak_from_this()] {
+                if (const auto locked = window.lock()) { locked->dispatch_events(); }
+            }));
 
-            global::g_WindowManager->add(window);
+            global::g_WindowManager->add(window, window->initial_present_policy());
         });
     }
 
@@ -102,6 +120,7 @@ namespace vke::lifecycle {
         lifecycle::should_close(should_close);
         while (!should_close && !global::g_WantsQuit) {
             internal::os_poll();
+            internal::dispatch_events();
 
             pre_update();
             update();
@@ -36,6 +36,11 @@ namespace vke::lifecycle {
 
     extern VKE_API Signal<void()> vulkan_is_available;
 
+    // The device exists and the `image` resource scope opens. device_cleanup is emitted during cleanup, after the renderers are gone and before the
+    // device is destroyed, so resources which hold device objects can release them.
+    extern VKE_API Signal<void()> device_ready;
+    extern VKE_API Signal<void()> device_cleanup;
+
     VKE_API void run();
     VKE_API void mainloop();
 
@@ -45,5 +50,6 @@ namespace vke::lifecycle {
         extern VKE_API Signal<void()> post_physical_device;
         extern VKE_API Signal<void()> post_device;
         extern VKE_API Signal<void()> os_poll;
+        extern VKE_API Signal<void()> dispatch_events; // right after os_poll, windows emit what they queued during it
     } // namespace internal
 } // namespace vke::lifecycle
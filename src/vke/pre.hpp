@@ -34,7 +34,13 @@
 
 #include <vulkan/vulkan.hpp>
 
-#include <eventpp/callbacklist.h>
+#include "vke/utils/signal.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <vector>
 
 namespace vke {
     template<typename T>
@@ -56,45 +62,64 @@ namespace vke {
     class VKE_API RendererStack;
     class VKE_API Renderer;
     class VKE_API ImageSupplier;
-
-    template<typename F>
-    class Signal;
-
-    template<typename... Args>
-    class Signal<void(Args...)> {
-        eventpp::CallbackList<void(Args...)> m_CallbackList;
-        using cb_base_t = eventpp::internal_::CallbackListBase<void(Args...), eventpp::DefaultPolicies>;
-
-      public:
-        using callback_t = typename cb_base_t::Callback;
-        using handle_t   = typename cb_base_t::Handle;
-
-        inline void operator()(Args... args) const { m_CallbackList(args...); }
-        inline void invoke(Args... args) const { m_CallbackList(args...); }
-
-        inline auto append(const callback_t& callback) { return m_CallbackList.append(callback); }
-        inline void remove(const handle_t& handle) { m_CallbackList.remove(handle); }
-    };
+    class VKE_API JobSystem;
 
     template<void (*callable)()>
     struct run_at_static_init {
         run_at_static_init() { callable(); }
     };
 
+    // Removes the callbacks it registered from their signals when it is destroyed. A subscription is a function pointer, the signal and the
+    // handle: the first few are stored inline, so subscribing doesn't allocate, and each is removed in O(1).
     class ScopedSlotSubscriber {
-        std::vector<std::function<void()>> m_Unsubscribers;
-
       public:
+        ScopedSlotSubscriber() = default;
+
+        ScopedSlotSubscriber(const ScopedSlotSubscriber&)            = delete;
+        ScopedSlotSubscriber& operator=(const ScopedSlotSubscriber&) = delete;
+
         virtual inline ~ScopedSlotSubscriber() {
-            for (auto& callback : m_Unsubscribers) {
-                callback();
-            }
+            for (uint32_t i = 0; i < m_InlineCount; i++) { m_Inline[i].remove(m_Inline[i].slot, m_Inline[i].handle); }
+            for (const auto& subscription : m_Overflow) { subscription.remove(subscription.slot, subscription.handle); }
         }
 
         template<typename F>
         void register_listener(Signal<F>& slot, typename Signal<F>::handle_t handle) {
-            Signal<F>* p_slot = &slot;
-            m_Unsubscribers.emplace_back([p_slot, handle] { p_slot->remove(handle); });
+            subscribe<Signal<F>>(slot, handle);
+        }
+
+        template<typename F>
+        void register_listener(ConcurrentSignal<F>& slot, typename ConcurrentSignal<F>::handle_t handle) {
+            subscribe<ConcurrentSignal<F>>(slot, handle);
         }
+
+      private:
+        static constexpr uint32_t INLINE_SUBSCRIPTIONS = 4;
+
+        struct Subscription {
+            void (*remove)(void* slot, uint64_t handle);
+            void*    slot;
+            uint64_t handle;
+        };
+
+        template<typename S>
+        void subscribe(S& slot, typename S::handle_t handle) {
+            static_assert(sizeof(typename S::handle_t) == sizeof(uint64_t) && std::is_trivially_copyable_v<typename S::handle_t>);
+
+            const Subscription subscription{
+              [](void* slot, const uint64_t handle) { static_cast<S*>(slot)->remove(std::bit_cast<typename S::handle_t>(handle)); },
+              &slot,
+              std::bit_cast<uint64_t>(handle),
+            };
+            if (m_InlineCount < INLINE_SUBSCRIPTIONS) {
+                m_Inline[m_InlineCount++] = subscription;
+            } else {
+                m_Overflow.push_back(subscription);
+            }
+        }
+
+        std::array<Subscription, INLINE_SUBSCRIPTIONS> m_Inline{};
+        uint32_t                                       m_InlineCount = 0;
+        std::vector<Subscription>                      m_Overflow;
     };
 } // namespace vke
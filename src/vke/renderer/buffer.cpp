@@ -0,0 +1,49 @@
+//
+// Created by andy on 3/24/2025.
+//
+
+#include "buffer.hpp"
+
+#include "vke/global.hpp"
+
+#include <cstring>
+
+namespace vke {
+    Buffer::Buffer(const Settings& settings) : m_Device(global::g_Device), m_Size(settings.size) {
+        vk::BufferCreateInfo create_info{};
+        create_info.size        = settings.size;
+        create_info.usage       = settings.usage;
+        create_info.sharingMode = vk::SharingMode::eExclusive;
+        m_Buffer                = m_Device->handle().createBuffer(create_info);
+
+        const auto requirements = m_Device->handle().getBufferMemoryRequirements(m_Buffer);
+        m_Memory                = m_Device->allocate_memory(requirements, settings.memory_properties);
+        m_Device->handle().bindBufferMemory(m_Buffer, m_Memory, 0);
+
+        if (settings.memory_properties & vk::MemoryPropertyFlagBits::eHostVisible) {
+            m_Mapped   = m_Device->handle().mapMemory(m_Memory, 0, vk::WholeSize);
+            m_Coherent = static_cast<bool>(settings.memory_properties & vk::MemoryPropertyFlagBits::eHostCoherent);
+        }
+    }
+
+    std::shared_ptr<Buffer> Buffer::create(const Settings& settings) {
+        return std::shared_ptr<Buffer>(new Buffer(settings));
+    }
+
+    Buffer::~Buffer() {
+        if (m_Mapped) { m_Device->handle().unmapMemory(m_Memory); }
+        // The GPU may still be reading it.
+        m_Device->defer([device = m_Device->handle(), buffer = m_Buffer, memory = m_Memory] {
+            device.destroy(buffer);
+            device.freeMemory(memory);
+        });
+    }
+
+    void Buffer::write(const void* data, const vk::DeviceSize size, const vk::DeviceSize offset) const {
+        VKE_ASSERT(m_Mapped != nullptr, "Buffer isn't host visible");
+        VKE_ASSERT(offset + size <= m_Size, "Write is out of bounds");
+
+        std::memcpy(static_cast<std::byte*>(m_Mapped) + offset, data, size);
+        if (!m_Coherent) { m_Device->handle().flushMappedMemoryRanges(vk::MappedMemoryRange{m_Memory, 0, vk::WholeSize}); }
+    }
+} // namespace vke
@@ -0,0 +1,55 @@
+//
+// Created by andy on 3/24/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/vke.hpp"
+
+#include <span>
+
+namespace vke {
+
+    class VKE_API Buffer {
+      public:
+        struct Settings {
+            vk::DeviceSize          size;
+            vk::BufferUsageFlags    usage;
+            vk::MemoryPropertyFlags memory_properties = vk::MemoryPropertyFlagBits::eDeviceLocal;
+        };
+
+      private:
+        explicit Buffer(const Settings& settings);
+
+      public:
+        static std::shared_ptr<Buffer> create(const Settings& settings);
+
+        ~Buffer();
+
+        [[nodiscard]] inline vk::Buffer       handle() const noexcept { return m_Buffer; }
+        [[nodiscard]] inline vk::DeviceMemory memory() const noexcept { return m_Memory; }
+        [[nodiscard]] inline vk::DeviceSize   size() const noexcept { return m_Size; }
+
+        // Host visible buffers are persistently mapped. This is nullptr for buffers which aren't host visible.
+        [[nodiscard]] inline void* mapped() const noexcept { return m_Mapped; }
+
+        template<typename T>
+        [[nodiscard]] inline std::span<T> mapped_as() const noexcept {
+            return {static_cast<T*>(m_Mapped), m_Mapped ? static_cast<std::size_t>(m_Size / sizeof(T)) : 0};
+        }
+
+        // Copies into the mapped memory (and flushes it when the memory isn't host coherent). The buffer must be host visible.
+        void write(const void* data, vk::DeviceSize size, vk::DeviceSize offset = 0) const;
+
+      private:
+        std::shared_ptr<Device> m_Device;
+        vk::Buffer              m_Buffer;
+        vk::DeviceMemory        m_Memory;
+        vk::DeviceSize          m_Size;
+        void*                   m_Mapped   = nullptr;
+        bool                    m_Coherent = false;
+    };
+
+} // namespace vke
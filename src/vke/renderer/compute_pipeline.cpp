@@ -0,0 +1,22 @@
+//
+// Created by andy on 3/25/2025.
+//
+
+#include "compute_pipeline.hpp"
+
+#include "vke/global.hpp"
+
+namespace vke {
+    ComputePipeline::ComputePipeline(const Settings& settings)
+        : m_Device(global::g_Device), m_Layout(settings.layout), m_ShaderModule(settings.shader_module) {
+        vk::ComputePipelineCreateInfo create_info{};
+        create_info.stage  = vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eCompute, m_ShaderModule->handle(), settings.entry_point.c_str());
+        create_info.layout = m_Layout->handle();
+
+        m_Pipeline = m_Device->handle().createComputePipeline(/* TODO: pipeline cache */ nullptr, create_info).value;
+    }
+
+    ComputePipeline::~ComputePipeline() {
+        m_Device->defer_destroy(m_Pipeline);
+    }
+} // namespace vke
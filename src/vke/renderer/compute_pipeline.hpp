@@ -0,0 +1,38 @@
+//
+// Created by andy on 3/25/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/dependency.hpp"
+#include "vke/renderer/pipeline_layout.hpp"
+#include "vke/renderer/shader_module.hpp"
+#include "vke/vke.hpp"
+
+namespace vke {
+
+    class VKE_API ComputePipeline : public Ownable {
+      public:
+        struct Settings {
+            std::shared_ptr<ShaderModule> shader_module;
+            std::string                   entry_point = "main";
+
+            std::shared_ptr<PipelineLayout> layout;
+        };
+
+        explicit ComputePipeline(const Settings& settings);
+        ~ComputePipeline() override;
+
+        [[nodiscard]] inline vk::Pipeline                           handle() const noexcept { return m_Pipeline; }
+        [[nodiscard]] inline const std::shared_ptr<PipelineLayout>& layout() const noexcept { return m_Layout; }
+
+      private:
+        std::shared_ptr<Device>         m_Device;
+        vk::Pipeline                    m_Pipeline;
+        std::shared_ptr<PipelineLayout> m_Layout;
+        std::shared_ptr<ShaderModule>   m_ShaderModule;
+    };
+
+} // namespace vke
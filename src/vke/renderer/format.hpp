@@ -0,0 +1,421 @@
+//
+// Created by andy on 3/27/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace vke {
+
+    enum class FormatComponentType : uint8_t { None, Unorm, Snorm, Uscaled, Sscaled, Uint, Sint, Ufloat, Sfloat, Srgb, Sfixed5 };
+
+    /**
+     * Static description of a vk::Format. Sizes are per texel block: 1x1 for ordinary formats, 4x4 (or larger, for ASTC) for block compressed
+     * ones, and 2x1 for the subsampled 422 formats. Multi-planar formats only describe their planes, not their sizes.
+     */
+    struct FormatInfo {
+        uint8_t              block_size      = 0; // bytes, 0 for undefined or multi-planar formats
+        uint8_t              block_width     = 0;
+        uint8_t              block_height    = 0;
+        uint8_t              component_count = 0;
+        FormatComponentType  component_type  = FormatComponentType::None;
+        vk::ImageAspectFlags aspect          = {};
+        uint8_t              plane_count     = 0;
+        bool                 compressed      = false;
+        bool                 packed          = false; // every component is in one 8, 16 or 32-bit word
+
+        [[nodiscard]] constexpr bool valid() const noexcept { return block_size != 0 || plane_count != 0; }
+        [[nodiscard]] constexpr bool multi_planar() const noexcept { return plane_count > 1; }
+        [[nodiscard]] constexpr bool has_texel_size() const noexcept { return block_size != 0 && block_width == 1 && block_height == 1; }
+        [[nodiscard]] constexpr bool has_depth() const noexcept { return static_cast<bool>(aspect & vk::ImageAspectFlagBits::eDepth); }
+        [[nodiscard]] constexpr bool has_stencil() const noexcept { return static_cast<bool>(aspect & vk::ImageAspectFlagBits::eStencil); }
+    };
+
+    namespace internal {
+        constexpr FormatInfo color(const uint8_t size, const uint8_t components, const FormatComponentType type, const bool packed = false) {
+            return {size, 1, 1, components, type, vk::ImageAspectFlagBits::eColor, 1, false, packed};
+        }
+
+        constexpr FormatInfo depth_stencil(const uint8_t size, const uint8_t components, const FormatComponentType type, const vk::ImageAspectFlags aspect) {
+            return {size, 1, 1, components, type, aspect, 1, false, false};
+        }
+
+        constexpr FormatInfo block(const uint8_t size, const uint8_t width, const uint8_t height, const uint8_t components, const FormatComponentType type) {
+            return {size, width, height, components, type, vk::ImageAspectFlagBits::eColor, 1, true, false};
+        }
+
+        constexpr FormatInfo subsampled(const uint8_t size, const FormatComponentType type) {
+            return {size, 2, 1, 4, type, vk::ImageAspectFlagBits::eColor, 1, false, false};
+        }
+
+        constexpr FormatInfo planar(const uint8_t planes, const FormatComponentType type) {
+            return {0, 1, 1, 3, type, vk::ImageAspectFlagBits::eColor, planes, false, false};
+        }
+
+        // The core formats are contiguous from eUndefined, the ones added by extensions live in ranges of their own.
+        struct FormatRange {
+            vk::Format first;
+            uint32_t   count;
+        };
+
+        inline constexpr std::array FORMAT_RANGES{
+          FormatRange{vk::Format::eUndefined, 185},
+          FormatRange{vk::Format::eG8B8G8R8422Unorm, 34},
+          FormatRange{vk::Format::eG8B8R82Plane444Unorm, 4},
+          FormatRange{vk::Format::eA4R4G4B4UnormPack16, 2},
+          FormatRange{vk::Format::eAstc4x4SfloatBlock, 14},
+          FormatRange{vk::Format::eA1B5G5R5UnormPack16, 2},
+          FormatRange{vk::Format::ePvrtc12BppUnormBlockIMG, 8},
+          FormatRange{vk::Format::eR16G16Sfixed5NV, 1},
+        };
+
+        constexpr uint32_t FORMAT_TABLE_SIZE = [] {
+            uint32_t size = 0;
+            for (const auto& range : FORMAT_RANGES) { size += range.count; }
+            return size;
+        }();
+
+        // Slot of a format in the table, or FORMAT_TABLE_SIZE if the table doesn't know it.
+        constexpr uint32_t format_index(const vk::Format format) {
+            const auto value = static_cast<int64_t>(format);
+            uint32_t   base  = 0;
+            for (const auto& [first, count] : FORMAT_RANGES) {
+                const int64_t offset = value - static_cast<int64_t>(first);
+                if (offset >= 0 && offset < count) { return base + static_cast<uint32_t>(offset); }
+                base += count;
+            }
+            return FORMAT_TABLE_SIZE;
+        }
+
+        struct FormatEntry {
+            vk::Format format;
+            FormatInfo info;
+        };
+
+        inline constexpr FormatEntry FORMAT_ENTRIES[] = {
+          {vk::Format::eR4G4UnormPack8,                       color(1, 2, FormatComponentType::Unorm, true)},
+          {vk::Format::eR4G4B4A4UnormPack16,                  color(2, 4, FormatComponentType::Unorm, true)},
+          {vk::Format::eB4G4R4A4UnormPack16,                  color(2, 4, FormatComponentType::Unorm, true)},
+          {vk::Format::eR5G6B5UnormPack16,                    color(2, 3, FormatComponentType::Unorm, true)},
+          {vk::Format::eB5G6R5UnormPack16,                    color(2, 3, FormatComponentType::Unorm, true)},
+          {vk::Format::eR5G5B5A1UnormPack16,                  color(2, 4, FormatComponentType::Unorm, true)},
+          {vk::Format::eB5G5R5A1UnormPack16,                  color(2, 4, FormatComponentType::Unorm, true)},
+          {vk::Format::eA1R5G5B5UnormPack16,                  color(2, 4, FormatComponentType::Unorm, true)},
+          {vk::Format::eR8Unorm,                              color(1, 1, FormatComponentType::Unorm)},
+          {vk::Format::eR8Snorm,                              color(1, 1, FormatComponentType::Snorm)},
+          {vk::Format::eR8Uscaled,                            color(1, 1, FormatComponentType::Uscaled)},
+          {vk::Format::eR8Sscaled,                            color(1, 1, FormatComponentType::Sscaled)},
+          {vk::Format::eR8Uint,                               color(1, 1, FormatComponentType::Uint)},
+          {vk::Format::eR8Sint,                               color(1, 1, FormatComponentType::Sint)},
+          {vk::Format::eR8Srgb,                               color(1, 1, FormatComponentType::Srgb)},
+          {vk::Format::eR8G8Unorm,                            color(2, 2, FormatComponentType::Unorm)},
+          {vk::Format::eR8G8Snorm,                            color(2, 2, FormatComponentType::Snorm)},
+          {vk::Format::eR8G8Uscaled,                          color(2, 2, FormatComponentType::Uscaled)},
+          {vk::Format::eR8G8Sscaled,                          color(2, 2, FormatComponentType::Sscaled)},
+          {vk::Format::eR8G8Uint,                             color(2, 2, FormatComponentType::Uint)},
+          {vk::Format::eR8G8Sint,                             color(2, 2, FormatComponentType::Sint)},
+          {vk::Format::eR8G8Srgb,                             color(2, 2, FormatComponentType::Srgb)},
+          {vk::Format::eR8G8B8Unorm,                          color(3, 3, FormatComponentType::Unorm)},
+          {vk::Format::eR8G8B8Snorm,                          color(3, 3, FormatComponentType::Snorm)},
+          {vk::Format::eR8G8B8Uscaled,                        color(3, 3, FormatComponentType::Uscaled)},
+          {vk::Format::eR8G8B8Sscaled,                        color(3, 3, FormatComponentType::Sscaled)},
+          {vk::Format::eR8G8B8Uint,                           color(3, 3, FormatComponentType::Uint)},
+          {vk::Format::eR8G8B8Sint,                           color(3, 3, FormatComponentType::Sint)},
+          {vk::Format::eR8G8B8Srgb,                           color(3, 3, FormatComponentType::Srgb)},
+          {vk::Format::eB8G8R8Unorm,                          color(3, 3, FormatComponentType::Unorm)},
+          {vk::Format::eB8G8R8Snorm,                          color(3, 3, FormatComponentType::Snorm)},
+          {vk::Format::eB8G8R8Uscaled,                        color(3, 3, FormatComponentType::Uscaled)},
+          {vk::Format::eB8G8R8Sscaled,                        color(3, 3, FormatComponentType::Sscaled)},
+          {vk::Format::eB8G8R8Uint,                           color(3, 3, FormatComponentType::Uint)},
+          {vk::Format::eB8G8R8Sint,                           color(3, 3, FormatComponentType::Sint)},
+          {vk::Format::eB8G8R8Srgb,                           color(3, 3, FormatComponentType::Srgb)},
+          {vk::Format::eR8G8B8A8Unorm,                        color(4, 4, FormatComponentType::Unorm)},
+          {vk::Format::eR8G8B8A8Snorm,                        color(4, 4, FormatComponentType::Snorm)},
+          {vk::Format::eR8G8B8A8Uscaled,                      color(4, 4, FormatComponentType::Uscaled)},
+          {vk::Format::eR8G8B8A8Sscaled,                      color(4, 4, FormatComponentType::Sscaled)},
+          {vk::Format::eR8G8B8A8Uint,                         color(4, 4, FormatComponentType::Uint)},
+          {vk::Format::eR8G8B8A8Sint,                         color(4, 4, FormatComponentType::Sint)},
+          {vk::Format::eR8G8B8A8Srgb,                         color(4, 4, FormatComponentType::Srgb)},
+          {vk::Format::eB8G8R8A8Unorm,                        color(4, 4, FormatComponentType::Unorm)},
+          {vk::Format::eB8G8R8A8Snorm,                        color(4, 4, FormatComponentType::Snorm)},
+          {vk::Format::eB8G8R8A8Uscaled,                      color(4, 4, FormatComponentType::Uscaled)},
+          {vk::Format::eB8G8R8A8Sscaled,                      color(4, 4, FormatComponentType::Sscaled)},
+          {vk::Format::eB8G8R8A8Uint,                         color(4, 4, FormatComponentType::Uint)},
+          {vk::Format::eB8G8R8A8Sint,                         color(4, 4, FormatComponentType::Sint)},
+          {vk::Format::eB8G8R8A8Srgb,                         color(4, 4, FormatComponentType::Srgb)},
+          {vk::Format::eA8B8G8R8UnormPack32,                  color(4, 4, FormatComponentType::Unorm, true)},
+          {vk::Format::eA8B8G8R8SnormPack32,                  color(4, 4, FormatComponentType::Snorm, true)},
+          {vk::Format::eA8B8G8R8UscaledPack32,                color(4, 4, FormatComponentType::Uscaled, true)},
+          {vk::Format::eA8B8G8R8SscaledPack32,                color(4, 4, FormatComponentType::Sscaled, true)},
+          {vk::Format::eA8B8G8R8UintPack32,                   color(4, 4, FormatComponentType::Uint, true)},
+          {vk::Format::eA8B8G8R8SintPack32,                   color(4, 4, FormatComponentType::Sint, true)},
+          {vk::Format::eA8B8G8R8SrgbPack32,                   color(4, 4, FormatComponentType::Srgb, true)},
+          {vk::Format::eA2R10G10B10UnormPack32,               color(4, 4, FormatComponentType::Unorm, true)},
+          {vk::Format::eA2R10G10B10SnormPack32,               color(4, 4, FormatComponentType::Snorm, true)},
+          {vk::Format::eA2R10G10B10UscaledPack32,             color(4, 4, FormatComponentType::Uscaled, true)},
+          {vk::Format::eA2R10G10B10SscaledPack32,             color(4, 4, FormatComponentType::Sscaled, true)},
+          {vk::Format::eA2R10G10B10UintPack32,                color(4, 4, FormatComponentType::Uint, true)},
+          {vk::Format::eA2R10G10B10SintPack32,                color(4, 4, FormatComponentType::Sint, true)},
+          {vk::Format::eA2B10G10R10UnormPack32,               color(4, 4, FormatComponentType::Unorm, true)},
+          {vk::Format::eA2B10G10R10SnormPack32,               color(4, 4, FormatComponentType::Snorm, true)},
+          {vk::Format::eA2B10G10R10UscaledPack32,             color(4, 4, FormatComponentType::Uscaled, true)},
+          {vk::Format::eA2B10G10R10SscaledPack32,             color(4, 4, FormatComponentType::Sscaled, true)},
+          {vk::Format::eA2B10G10R10UintPack32,                color(4, 4, FormatComponentType::Uint, true)},
+          {vk::Format::eA2B10G10R10SintPack32,                color(4, 4, FormatComponentType::Sint, true)},
+          {vk::Format::eR16Unorm,                             color(2, 1, FormatComponentType::Unorm)},
+          {vk::Format::eR16Snorm,                             color(2, 1, FormatComponentType::Snorm)},
+          {vk::Format::eR16Uscaled,                           color(2, 1, FormatComponentType::Uscaled)},
+          {vk::Format::eR16Sscaled,                           color(2, 1, FormatComponentType::Sscaled)},
+          {vk::Format::eR16Uint,                              color(2, 1, FormatComponentType::Uint)},
+          {vk::Format::eR16Sint,                              color(2, 1, FormatComponentType::Sint)},
+          {vk::Format::eR16Sfloat,                            color(2, 1, FormatComponentType::Sfloat)},
+          {vk::Format::eR16G16Unorm,                          color(4, 2, FormatComponentType::Unorm)},
+          {vk::Format::eR16G16Snorm,                          color(4, 2, FormatComponentType::Snorm)},
+          {vk::Format::eR16G16Uscaled,                        color(4, 2, FormatComponentType::Uscaled)},
+          {vk::Format::eR16G16Sscaled,                        color(4, 2, FormatComponentType::Sscaled)},
+          {vk::Format::eR16G16Uint,                           color(4, 2, FormatComponentType::Uint)},
+          {vk::Format::eR16G16Sint,                           color(4, 2, FormatComponentType::Sint)},
+          {vk::Format::eR16G16Sfloat,                         color(4, 2, FormatComponentType::Sfloat)},
+          {vk::Format::eR16G16B16Unorm,                       color(6, 3, FormatComponentType::Unorm)},
+          {vk::Format::eR16G16B16Snorm,                       color(6, 3, FormatComponentType::Snorm)},
+          {vk::Format::eR16G16B16Uscaled,                     color(6, 3, FormatComponentType::Uscaled)},
+          {vk::Format::eR16G16B16Sscaled,                     color(6, 3, FormatComponentType::Sscaled)},
+          {vk::Format::eR16G16B16Uint,                        color(6, 3, FormatComponentType::Uint)},
+          {vk::Format::eR16G16B16Sint,                        color(6, 3, FormatComponentType::Sint)},
+          {vk::Format::eR16G16B16Sfloat,                      color(6, 3, FormatComponentType::Sfloat)},
+          {vk::Format::eR16G16B16A16Unorm,                    color(8, 4, FormatComponentType::Unorm)},
+          {vk::Format::eR16G16B16A16Snorm,                    color(8, 4, FormatComponentType::Snorm)},
+          {vk::Format::eR16G16B16A16Uscaled,                  color(8, 4, FormatComponentType::Uscaled)},
+          {vk::Format::eR16G16B16A16Sscaled,                  color(8, 4, FormatComponentType::Sscaled)},
+          {vk::Format::eR16G16B16A16Uint,                     color(8, 4, FormatComponentType::Uint)},
+          {vk::Format::eR16G16B16A16Sint,                     color(8, 4, FormatComponentType::Sint)},
+          {vk::Format::eR16G16B16A16Sfloat,                   color(8, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eR32Uint,                              color(4, 1, FormatComponentType::Uint)},
+          {vk::Format::eR32Sint,                              color(4, 1, FormatComponentType::Sint)},
+          {vk::Format::eR32Sfloat,                            color(4, 1, FormatComponentType::Sfloat)},
+          {vk::Format::eR32G32Uint,                           color(8, 2, FormatComponentType::Uint)},
+          {vk::Format::eR32G32Sint,                           color(8, 2, FormatComponentType::Sint)},
+          {vk::Format::eR32G32Sfloat,                         color(8, 2, FormatComponentType::Sfloat)},
+          {vk::Format::eR32G32B32Uint,                        color(12, 3, FormatComponentType::Uint)},
+          {vk::Format::eR32G32B32Sint,                        color(12, 3, FormatComponentType::Sint)},
+          {vk::Format::eR32G32B32Sfloat,                      color(12, 3, FormatComponentType::Sfloat)},
+          {vk::Format::eR32G32B32A32Uint,                     color(16, 4, FormatComponentType::Uint)},
+          {vk::Format::eR32G32B32A32Sint,                     color(16, 4, FormatComponentType::Sint)},
+          {vk::Format::eR32G32B32A32Sfloat,                   color(16, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eR64Uint,                              color(8, 1, FormatComponentType::Uint)},
+          {vk::Format::eR64Sint,                              color(8, 1, FormatComponentType::Sint)},
+          {vk::Format::eR64Sfloat,                            color(8, 1, FormatComponentType::Sfloat)},
+          {vk::Format::eR64G64Uint,                           color(16, 2, FormatComponentType::Uint)},
+          {vk::Format::eR64G64Sint,                           color(16, 2, FormatComponentType::Sint)},
+          {vk::Format::eR64G64Sfloat,                         color(16, 2, FormatComponentType::Sfloat)},
+          {vk::Format::eR64G64B64Uint,                        color(24, 3, FormatComponentType::Uint)},
+          {vk::Format::eR64G64B64Sint,                        color(24, 3, FormatComponentType::Sint)},
+          {vk::Format::eR64G64B64Sfloat,                      color(24, 3, FormatComponentType::Sfloat)},
+          {vk::Format::eR64G64B64A64Uint,                     color(32, 4, FormatComponentType::Uint)},
+          {vk::Format::eR64G64B64A64Sint,                     color(32, 4, FormatComponentType::Sint)},
+          {vk::Format::eR64G64B64A64Sfloat,                   color(32, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eB10G11R11UfloatPack32,                color(4, 3, FormatComponentType::Ufloat, true)},
+          {vk::Format::eE5B9G9R9UfloatPack32,                 color(4, 3, FormatComponentType::Ufloat, true)},
+          {vk::Format::eD16Unorm,                             depth_stencil(2, 1, FormatComponentType::Unorm, vk::ImageAspectFlagBits::eDepth)},
+          {vk::Format::eX8D24UnormPack32,                     depth_stencil(4, 1, FormatComponentType::Unorm, vk::ImageAspectFlagBits::eDepth)},
+          {vk::Format::eD32Sfloat,                            depth_stencil(4, 1, FormatComponentType::Sfloat, vk::ImageAspectFlagBits::eDepth)},
+          {vk::Format::eS8Uint,                               depth_stencil(1, 1, FormatComponentType::Uint, vk::ImageAspectFlagBits::eStencil)},
+          {vk::Format::eD16UnormS8Uint,                       depth_stencil(3, 2, FormatComponentType::Unorm, vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil)},
+          {vk::Format::eD24UnormS8Uint,                       depth_stencil(4, 2, FormatComponentType::Unorm, vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil)},
+          {vk::Format::eD32SfloatS8Uint,                      depth_stencil(8, 2, FormatComponentType::Sfloat, vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil)},
+          {vk::Format::eBc1RgbUnormBlock,                     block(8, 4, 4, 3, FormatComponentType::Unorm)},
+          {vk::Format::eBc1RgbSrgbBlock,                      block(8, 4, 4, 3, FormatComponentType::Srgb)},
+          {vk::Format::eBc1RgbaUnormBlock,                    block(8, 4, 4, 4, FormatComponentType::Unorm)},
+          {vk::Format::eBc1RgbaSrgbBlock,                     block(8, 4, 4, 4, FormatComponentType::Srgb)},
+          {vk::Format::eBc2UnormBlock,                        block(16, 4, 4, 4, FormatComponentType::Unorm)},
+          {vk::Format::eBc2SrgbBlock,                         block(16, 4, 4, 4, FormatComponentType::Srgb)},
+          {vk::Format::eBc3UnormBlock,                        block(16, 4, 4, 4, FormatComponentType::Unorm)},
+          {vk::Format::eBc3SrgbBlock,                         block(16, 4, 4, 4, FormatComponentType::Srgb)},
+          {vk::Format::eBc4UnormBlock,                        block(8, 4, 4, 1, FormatComponentType::Unorm)},
+          {vk::Format::eBc4SnormBlock,                        block(8, 4, 4, 1, FormatComponentType::Snorm)},
+          {vk::Format::eBc5UnormBlock,                        block(16, 4, 4, 2, FormatComponentType::Unorm)},
+          {vk::Format::eBc5SnormBlock,                        block(16, 4, 4, 2, FormatComponentType::Snorm)},
+          {vk::Format::eBc6HUfloatBlock,                      block(16, 4, 4, 3, FormatComponentType::Ufloat)},
+          {vk::Format::eBc6HSfloatBlock,                      block(16, 4, 4, 3, FormatComponentType::Sfloat)},
+          {vk::Format::eBc7UnormBlock,                        block(16, 4, 4, 4, FormatComponentType::Unorm)},
+          {vk::Format::eBc7SrgbBlock,                         block(16, 4, 4, 4, FormatComponentType::Srgb)},
+          {vk::Format::eEtc2R8G8B8UnormBlock,                 block(8, 4, 4, 3, FormatComponentType::Unorm)},
+          {vk::Format::eEtc2R8G8B8SrgbBlock,                  block(8, 4, 4, 3, FormatComponentType::Srgb)},
+          {vk::Format::eEtc2R8G8B8A1UnormBlock,               block(8, 4, 4, 4, FormatComponentType::Unorm)},
+          {vk::Format::eEtc2R8G8B8A1SrgbBlock,                block(8, 4, 4, 4, FormatComponentType::Srgb)},
+          {vk::Format::eEtc2R8G8B8A8UnormBlock,               block(16, 4, 4, 4, FormatComponentType::Unorm)},
+          {vk::Format::eEtc2R8G8B8A8SrgbBlock,                block(16, 4, 4, 4, FormatComponentType::Srgb)},
+          {vk::Format::eEacR11UnormBlock,                     block(8, 4, 4, 1, FormatComponentType::Unorm)},
+          {vk::Format::eEacR11SnormBlock,                     block(8, 4, 4, 1, FormatComponentType::Snorm)},
+          {vk::Format::eEacR11G11UnormBlock,                  block(16, 4, 4, 2, FormatComponentType::Unorm)},
+          {vk::Format::eEacR11G11SnormBlock,                  block(16, 4, 4, 2, FormatComponentType::Snorm)},
+          {vk::Format::eAstc4x4UnormBlock,                    block(16, 4, 4, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc4x4SrgbBlock,                     block(16, 4, 4, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc5x4UnormBlock,                    block(16, 5, 4, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc5x4SrgbBlock,                     block(16, 5, 4, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc5x5UnormBlock,                    block(16, 5, 5, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc5x5SrgbBlock,                     block(16, 5, 5, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc6x5UnormBlock,                    block(16, 6, 5, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc6x5SrgbBlock,                     block(16, 6, 5, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc6x6UnormBlock,                    block(16, 6, 6, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc6x6SrgbBlock,                     block(16, 6, 6, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc8x5UnormBlock,                    block(16, 8, 5, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc8x5SrgbBlock,                     block(16, 8, 5, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc8x6UnormBlock,                    block(16, 8, 6, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc8x6SrgbBlock,                     block(16, 8, 6, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc8x8UnormBlock,                    block(16, 8, 8, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc8x8SrgbBlock,                     block(16, 8, 8, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc10x5UnormBlock,                   block(16, 10, 5, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc10x5SrgbBlock,                    block(16, 10, 5, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc10x6UnormBlock,                   block(16, 10, 6, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc10x6SrgbBlock,                    block(16, 10, 6, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc10x8UnormBlock,                   block(16, 10, 8, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc10x8SrgbBlock,                    block(16, 10, 8, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc10x10UnormBlock,                  block(16, 10, 10, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc10x10SrgbBlock,                   block(16, 10, 10, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc12x10UnormBlock,                  block(16, 12, 10, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc12x10SrgbBlock,                   block(16, 12, 10, 4, FormatComponentType::Srgb)},
+          {vk::Format::eAstc12x12UnormBlock,                  block(16, 12, 12, 4, FormatComponentType::Unorm)},
+          {vk::Format::eAstc12x12SrgbBlock,                   block(16, 12, 12, 4, FormatComponentType::Srgb)},
+          {vk::Format::eG8B8G8R8422Unorm,                     subsampled(4, FormatComponentType::Unorm)},
+          {vk::Format::eB8G8R8G8422Unorm,                     subsampled(4, FormatComponentType::Unorm)},
+          {vk::Format::eG8B8R83Plane420Unorm,                 planar(3, FormatComponentType::Unorm)},
+          {vk::Format::eG8B8R82Plane420Unorm,                 planar(2, FormatComponentType::Unorm)},
+          {vk::Format::eG8B8R83Plane422Unorm,                 planar(3, FormatComponentType::Unorm)},
+          {vk::Format::eG8B8R82Plane422Unorm,                 planar(2, FormatComponentType::Unorm)},
+          {vk::Format::eG8B8R83Plane444Unorm,                 planar(3, FormatComponentType::Unorm)},
+          {vk::Format::eR10X6UnormPack16,                     color(2, 1, FormatComponentType::Unorm, true)},
+          {vk::Format::eR10X6G10X6Unorm2Pack16,               color(4, 2, FormatComponentType::Unorm)},
+          {vk::Format::eR10X6G10X6B10X6A10X6Unorm4Pack16,     color(8, 4, FormatComponentType::Unorm)},
+          {vk::Format::eG10X6B10X6G10X6R10X6422Unorm4Pack16,  subsampled(8, FormatComponentType::Unorm)},
+          {vk::Format::eB10X6G10X6R10X6G10X6422Unorm4Pack16,  subsampled(8, FormatComponentType::Unorm)},
+          {vk::Format::eG10X6B10X6R10X63Plane420Unorm3Pack16, planar(3, FormatComponentType::Unorm)},
+          {vk::Format::eG10X6B10X6R10X62Plane420Unorm3Pack16, planar(2, FormatComponentType::Unorm)},
+          {vk::Format::eG10X6B10X6R10X63Plane422Unorm3Pack16, planar(3, FormatComponentType::Unorm)},
+          {vk::Format::eG10X6B10X6R10X62Plane422Unorm3Pack16, planar(2, FormatComponentType::Unorm)},
+          {vk::Format::eG10X6B10X6R10X63Plane444Unorm3Pack16, planar(3, FormatComponentType::Unorm)},
+          {vk::Format::eR12X4UnormPack16,                     color(2, 1, FormatComponentType::Unorm, true)},
+          {vk::Format::eR12X4G12X4Unorm2Pack16,               color(4, 2, FormatComponentType::Unorm)},
+          {vk::Format::eR12X4G12X4B12X4A12X4Unorm4Pack16,     color(8, 4, FormatComponentType::Unorm)},
+          {vk::Format::eG12X4B12X4G12X4R12X4422Unorm4Pack16,  subsampled(8, FormatComponentType::Unorm)},
+          {vk::Format::eB12X4G12X4R12X4G12X4422Unorm4Pack16,  subsampled(8, FormatComponentType::Unorm)},
+          {vk::Format::eG12X4B12X4R12X43Plane420Unorm3Pack16, planar(3, FormatComponentType::Unorm)},
+          {vk::Format::eG12X4B12X4R12X42Plane420Unorm3Pack16, planar(2, FormatComponentType::Unorm)},
+          {vk::Format::eG12X4B12X4R12X43Plane422Unorm3Pack16, planar(3, FormatComponentType::Unorm)},
+          {vk::Format::eG12X4B12X4R12X42Plane422Unorm3Pack16, planar(2, FormatComponentType::Unorm)},
+          {vk::Format::eG12X4B12X4R12X43Plane444Unorm3Pack16, planar(3, FormatComponentType::Unorm)},
+          {vk::Format::eG16B16G16R16422Unorm,                 subsampled(8, FormatComponentType::Unorm)},
+          {vk::Format::eB16G16R16G16422Unorm,                 subsampled(8, FormatComponentType::Unorm)},
+          {vk::Format::eG16B16R163Plane420Unorm,              planar(3, FormatComponentType::Unorm)},
+          {vk::Format::eG16B16R162Plane420Unorm,              planar(2, FormatComponentType::Unorm)},
+          {vk::Format::eG16B16R163Plane422Unorm,              planar(3, FormatComponentType::Unorm)},
+          {vk::Format::eG16B16R162Plane422Unorm,              planar(2, FormatComponentType::Unorm)},
+          {vk::Format::eG16B16R163Plane444Unorm,              planar(3, FormatComponentType::Unorm)},
+          {vk::Format::eG8B8R82Plane444Unorm,                 planar(2, FormatComponentType::Unorm)},
+          {vk::Format::eG10X6B10X6R10X62Plane444Unorm3Pack16, planar(2, FormatComponentType::Unorm)},
+          {vk::Format::eG12X4B12X4R12X42Plane444Unorm3Pack16, planar(2, FormatComponentType::Unorm)},
+          {vk::Format::eG16B16R162Plane444Unorm,              planar(2, FormatComponentType::Unorm)},
+          {vk::Format::eA4R4G4B4UnormPack16,                  color(2, 4, FormatComponentType::Unorm, true)},
+          {vk::Format::eA4B4G4R4UnormPack16,                  color(2, 4, FormatComponentType::Unorm, true)},
+          {vk::Format::eAstc4x4SfloatBlock,                   block(16, 4, 4, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc5x4SfloatBlock,                   block(16, 5, 4, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc5x5SfloatBlock,                   block(16, 5, 5, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc6x5SfloatBlock,                   block(16, 6, 5, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc6x6SfloatBlock,                   block(16, 6, 6, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc8x5SfloatBlock,                   block(16, 8, 5, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc8x6SfloatBlock,                   block(16, 8, 6, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc8x8SfloatBlock,                   block(16, 8, 8, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc10x5SfloatBlock,                  block(16, 10, 5, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc10x6SfloatBlock,                  block(16, 10, 6, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc10x8SfloatBlock,                  block(16, 10, 8, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc10x10SfloatBlock,                 block(16, 10, 10, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc12x10SfloatBlock,                 block(16, 12, 10, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eAstc12x12SfloatBlock,                 block(16, 12, 12, 4, FormatComponentType::Sfloat)},
+          {vk::Format::eA1B5G5R5UnormPack16,                  color(2, 4, FormatComponentType::Unorm, true)},
+          {vk::Format::eA8Unorm,                              color(1, 1, FormatComponentType::Unorm)},
+          {vk::Format::ePvrtc12BppUnormBlockIMG,              block(8, 8, 4, 4, FormatComponentType::Unorm)},
+          {vk::Format::ePvrtc14BppUnormBlockIMG,              block(8, 4, 4, 4, FormatComponentType::Unorm)},
+          {vk::Format::ePvrtc22BppUnormBlockIMG,              block(8, 8, 4, 4, FormatComponentType::Unorm)},
+          {vk::Format::ePvrtc24BppUnormBlockIMG,              block(8, 4, 4, 4, FormatComponentType::Unorm)},
+          {vk::Format::ePvrtc12BppSrgbBlockIMG,               block(8, 8, 4, 4, FormatComponentType::Srgb)},
+          {vk::Format::ePvrtc14BppSrgbBlockIMG,               block(8, 4, 4, 4, FormatComponentType::Srgb)},
+          {vk::Format::ePvrtc22BppSrgbBlockIMG,               block(8, 8, 4, 4, FormatComponentType::Srgb)},
+          {vk::Format::ePvrtc24BppSrgbBlockIMG,               block(8, 4, 4, 4, FormatComponentType::Srgb)},
+          {vk::Format::eR16G16Sfixed5NV,                      color(4, 2, FormatComponentType::Sfixed5)},
+        };
+
+        constexpr std::array<FormatInfo, FORMAT_TABLE_SIZE + 1> build_format_table() {
+            std::array<FormatInfo, FORMAT_TABLE_SIZE + 1> table{};
+            for (const auto& [format, info] : FORMAT_ENTRIES) {
+                const uint32_t index = format_index(format);
+                // Not a constant expression (so a compile error) if a format is outside of the ranges or listed twice.
+                if (index == FORMAT_TABLE_SIZE || table[index].valid()) { throw std::logic_error("Bad format table entry"); }
+                table[index] = info;
+            }
+            return table;
+        }
+
+        // The last slot stays empty for formats which aren't in the table.
+        inline constexpr auto FORMAT_TABLE = build_format_table();
+
+        // Every slot except eUndefined's is filled.
+        static_assert(std::size(FORMAT_ENTRIES) == FORMAT_TABLE_SIZE - 1);
+    } // namespace internal
+
+    /**
+     * Never throws. Formats the table doesn't know about get an invalid (all zero) FormatInfo.
+     */
+    [[nodiscard]] constexpr const FormatInfo& format_info(const vk::Format format) noexcept {
+        return internal::FORMAT_TABLE[internal::format_index(format)];
+    }
+
+    /**
+     * Size of a single texel in bytes. Throws std::invalid_argument for formats without per-texel sizes (undefined, block compressed, subsampled
+     * and multi-planar formats). In a constant expression that's a compile error instead.
+     */
+    [[nodiscard]] constexpr uint32_t format_size(const vk::Format format) {
+        const FormatInfo& info = format_info(format);
+        if (!info.valid()) { throw std::invalid_argument("Invalid format"); }
+        if (info.multi_planar()) { throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes."); }
+        if (!info.has_texel_size()) { throw std::invalid_argument("Compressed formats don't have per-pixel sizes."); }
+        return info.block_size;
+    }
+
+    [[nodiscard]] constexpr vk::Extent3D mip_extent(const vk::Extent3D& extent, const uint32_t level) noexcept {
+        return {std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u), std::max(extent.depth >> level, 1u)};
+    }
+
+    /**
+     * Bytes in one tightly packed row of texel blocks (what a buffer <-> image copy with bufferRowLength = 0 expects).
+     */
+    [[nodiscard]] constexpr vk::DeviceSize format_row_size(const vk::Format format, const uint32_t width) {
+        const FormatInfo& info = format_info(format);
+        if (!info.valid() || info.multi_planar()) { throw std::invalid_argument("Format has no single-plane row size"); }
+        return static_cast<vk::DeviceSize>((width + info.block_width - 1) / info.block_width) * info.block_size;
+    }
+
+    /**
+     * Bytes needed to stage one mip level / layer of an image, rounding partial blocks up.
+     */
+    [[nodiscard]] constexpr vk::DeviceSize format_image_size(const vk::Format format, const vk::Extent3D& extent) {
+        const vk::DeviceSize row_size = format_row_size(format, extent.width);
+        const FormatInfo&    info     = format_info(format);
+        return row_size * ((extent.height + info.block_height - 1) / info.block_height) * extent.depth;
+    }
+
+    /**
+     * Bytes needed to stage `mip_levels` levels of `array_layers` layers, with every level tightly packed one after the other.
+     */
+    [[nodiscard]] constexpr vk::DeviceSize
+      format_image_size(const vk::Format format, const vk::Extent3D& extent, const uint32_t mip_levels, const uint32_t array_layers = 1) {
+        vk::DeviceSize size = 0;
+        for (uint32_t level = 0; level < mip_levels; level++) { size += format_image_size(format, mip_extent(extent, level)); }
+        return size * array_layers;
+    }
+
+} // namespace vke
@@ -0,0 +1,601 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#include "frame_graph.hpp"
+
+#include "vke/global.hpp"
+#include "vke/renderer/format.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace vke {
+    using Stage  = vk::PipelineStageFlagBits2;
+    using Access = vk::AccessFlagBits2;
+
+    namespace {
+        struct UsageInfo {
+            vk::PipelineStageFlags2 stage;
+            vk::AccessFlags2        read_access;
+            vk::AccessFlags2        write_access;
+            vk::ImageLayout         layout      = vk::ImageLayout::eUndefined;
+            vk::ImageUsageFlags     image_usage = {};
+        };
+
+        // Which resources a pass touches, and how, as the graph tracks it between passes.
+        struct TrackedState {
+            vk::ImageLayout         layout;
+            vk::PipelineStageFlags2 write_stages;  // of the last write (or layout transition)
+            vk::AccessFlags2        write_access;  // which still has to be made available
+            vk::PipelineStageFlags2 read_stages;   // every read since, which a write has to wait for
+            vk::PipelineStageFlags2 synced_stages; // already wait for the last write
+            vk::AccessFlags2        synced_access;
+            bool                    contents;      // whether there is anything worth loading
+        };
+    } // namespace
+
+    static vk::PipelineStageFlags2 shader_stages(const PassType type) {
+        switch (type) {
+            case PassType::Raster: return Stage::eVertexShader | Stage::eFragmentShader;
+            case PassType::Compute: return Stage::eComputeShader;
+            default: return Stage::eAllCommands;
+        }
+    }
+
+    static UsageInfo usage_info(const ImageUsage usage, const PassType type) {
+        using Layout = vk::ImageLayout;
+        using Usage  = vk::ImageUsageFlagBits;
+
+        constexpr vk::PipelineStageFlags2 fragment_tests = Stage::eEarlyFragmentTests | Stage::eLateFragmentTests;
+        switch (usage) {
+            case ImageUsage::ColorAttachment:
+                return {Stage::eColorAttachmentOutput, Access::eColorAttachmentRead, Access::eColorAttachmentWrite, Layout::eColorAttachmentOptimal,
+                        Usage::eColorAttachment};
+            case ImageUsage::DepthAttachment:
+                return {fragment_tests, Access::eDepthStencilAttachmentRead, Access::eDepthStencilAttachmentWrite,
+                        Layout::eDepthStencilAttachmentOptimal, Usage::eDepthStencilAttachment};
+            case ImageUsage::DepthReadOnly:
+                return {fragment_tests | shader_stages(type), Access::eDepthStencilAttachmentRead | Access::eShaderSampledRead, Access::eNone,
+                        Layout::eDepthStencilReadOnlyOptimal, Usage::eDepthStencilAttachment | Usage::eSampled};
+            case ImageUsage::Sampled:
+                return {shader_stages(type), Access::eShaderSampledRead, Access::eNone, Layout::eShaderReadOnlyOptimal, Usage::eSampled};
+            case ImageUsage::Storage:
+                return {shader_stages(type), Access::eShaderStorageRead, Access::eShaderStorageWrite, Layout::eGeneral, Usage::eStorage};
+            case ImageUsage::TransferSrc:
+                return {Stage::eAllTransfer, Access::eTransferRead, Access::eNone, Layout::eTransferSrcOptimal, Usage::eTransferSrc};
+            case ImageUsage::TransferDst:
+                return {Stage::eAllTransfer, Access::eNone, Access::eTransferWrite, Layout::eTransferDstOptimal, Usage::eTransferDst};
+        }
+        throw std::invalid_argument("Unknown image usage");
+    }
+
+    static UsageInfo usage_info(const BufferUsage usage, const PassType type) {
+        switch (usage) {
+            case BufferUsage::Vertex: return {Stage::eVertexAttributeInput, Access::eVertexAttributeRead, Access::eNone};
+            case BufferUsage::Index: return {Stage::eIndexInput, Access::eIndexRead, Access::eNone};
+            case BufferUsage::Indirect: return {Stage::eDrawIndirect, Access::eIndirectCommandRead, Access::eNone};
+            case BufferUsage::Uniform: return {shader_stages(type), Access::eUniformRead, Access::eNone};
+            case BufferUsage::Storage: return {shader_stages(type), Access::eShaderStorageRead, Access::eShaderStorageWrite};
+            case BufferUsage::TransferSrc: return {Stage::eAllTransfer, Access::eTransferRead, Access::eNone};
+            case BufferUsage::TransferDst: return {Stage::eAllTransfer, Access::eNone, Access::eTransferWrite};
+        }
+        throw std::invalid_argument("Unknown buffer usage");
+    }
+
+    static bool is_attachment(const ImageUsage usage) {
+        return usage == ImageUsage::ColorAttachment || usage == ImageUsage::DepthAttachment || usage == ImageUsage::DepthReadOnly;
+    }
+
+    static vk::AccessFlags2 destination_access(const UsageInfo& info, const bool write) {
+        return info.read_access | (write ? info.write_access : vk::AccessFlags2{});
+    }
+
+    FrameGraph::PassBuilder& FrameGraph::PassBuilder::color(const ImageId image, const std::optional<vk::ClearColorValue> clear) {
+        std::optional<vk::ClearValue> clear_value;
+        if (clear) { clear_value = vk::ClearValue{*clear}; }
+        m_Graph.add_access(m_Pass, ImageAccess{image.index, ImageUsage::ColorAttachment, true, clear_value});
+        return *this;
+    }
+
+    FrameGraph::PassBuilder& FrameGraph::PassBuilder::depth(const ImageId image, const std::optional<vk::ClearDepthStencilValue> clear) {
+        std::optional<vk::ClearValue> clear_value;
+        if (clear) { clear_value = vk::ClearValue{*clear}; }
+        m_Graph.add_access(m_Pass, ImageAccess{image.index, ImageUsage::DepthAttachment, true, clear_value});
+        return *this;
+    }
+
+    FrameGraph::PassBuilder& FrameGraph::PassBuilder::read(const ImageId image, const ImageUsage usage) {
+        if (usage == ImageUsage::ColorAttachment || usage == ImageUsage::DepthAttachment || usage == ImageUsage::TransferDst) {
+            throw std::invalid_argument("Image usage can't be read, declare it with color(), depth() or write()");
+        }
+        m_Graph.add_access(m_Pass, ImageAccess{image.index, usage, false, std::nullopt});
+        return *this;
+    }
+
+    FrameGraph::PassBuilder& FrameGraph::PassBuilder::write(const ImageId image, const ImageUsage usage) {
+        if (usage == ImageUsage::DepthReadOnly || usage == ImageUsage::Sampled || usage == ImageUsage::TransferSrc) {
+            throw std::invalid_argument("Image usage can't be written");
+        }
+        m_Graph.add_access(m_Pass, ImageAccess{image.index, usage, true, std::nullopt});
+        return *this;
+    }
+
+    FrameGraph::PassBuilder& FrameGraph::PassBuilder::read(const BufferId buffer, const BufferUsage usage) {
+        if (usage == BufferUsage::TransferDst) { throw std::invalid_argument("Buffer usage can't be read"); }
+        m_Graph.add_access(m_Pass, BufferAccess{buffer.index, usage, false});
+        return *this;
+    }
+
+    FrameGraph::PassBuilder& FrameGraph::PassBuilder::write(const BufferId buffer, const BufferUsage usage) {
+        if (usage != BufferUsage::Storage && usage != BufferUsage::TransferDst) { throw std::invalid_argument("Buffer usage can't be written"); }
+        m_Graph.add_access(m_Pass, BufferAccess{buffer.index, usage, true});
+        return *this;
+    }
+
+    FrameGraph::PassBuilder& FrameGraph::PassBuilder::side_effect() {
+        m_Graph.pass(m_Pass).side_effect = true;
+        m_Graph.m_Compiled               = false;
+        return *this;
+    }
+
+    FrameGraph::FrameGraph(const Settings& settings) : m_Device(global::g_Device), m_Settings(settings), m_Pool(settings.pool) {
+        if (!m_Pool) { m_Pool = std::make_shared<TransientAttachmentPool>(TransientAttachmentPool::Settings{settings.frames_in_flight}); }
+    }
+
+    FrameGraph::~FrameGraph() {
+        if (m_Allocation.id) { m_Pool->release(m_Allocation.id); }
+    }
+
+    void FrameGraph::reset() {
+        m_Images.clear();
+        m_Buffers.clear();
+        m_Passes.clear();
+        m_Compiled = false;
+    }
+
+    FrameGraph::ImageId FrameGraph::import_image(
+      const std::string_view name, const vk::Image image, const vk::ImageView view, const vk::Format format, const vk::Extent2D extent,
+      const ImageState& initial, const ImageState& final
+    ) {
+        m_Images.push_back({std::string(name), true, image, view, format, extent, vk::SampleCountFlagBits::e1, initial, final});
+        m_Compiled = false;
+        return {static_cast<uint32_t>(m_Images.size() - 1)};
+    }
+
+    FrameGraph::BufferId FrameGraph::import_buffer(const std::string_view name, const vk::Buffer buffer, const BufferState& initial) {
+        m_Buffers.push_back({std::string(name), buffer, initial});
+        m_Compiled = false;
+        return {static_cast<uint32_t>(m_Buffers.size() - 1)};
+    }
+
+    FrameGraph::ImageId FrameGraph::create_image(const std::string_view name, const TransientImageInfo& info) {
+        if (!format_info(info.format).valid() || info.extent.width == 0 || info.extent.height == 0) {
+            throw std::invalid_argument("Transient image " + std::string(name) + " needs a format and an extent");
+        }
+
+        m_Images.push_back({std::string(name), false, nullptr, nullptr, info.format, info.extent, info.samples, {}, {}});
+        m_Compiled = false;
+        return {static_cast<uint32_t>(m_Images.size() - 1)};
+    }
+
+    FrameGraph::PassBuilder FrameGraph::add_pass(const std::string_view name, const PassType type, RecordFunction record) {
+        m_Passes.push_back({std::string(name), type, std::move(record), {}, {}, false});
+        m_Compiled = false;
+        return PassBuilder(*this, static_cast<uint32_t>(m_Passes.size() - 1));
+    }
+
+    FrameGraph::Pass& FrameGraph::pass(const uint32_t index) {
+        return m_Passes[index];
+    }
+
+    FrameGraph::ImageResource& FrameGraph::image_resource(const ImageId id) {
+        if (id.index >= m_Images.size()) { throw std::invalid_argument("Image isn't part of this frame's graph"); }
+        return m_Images[id.index];
+    }
+
+    void FrameGraph::add_access(const uint32_t pass_index, ImageAccess access) {
+        auto&       pass     = m_Passes[pass_index];
+        const auto& resource = image_resource({access.image});
+
+        if (is_attachment(access.usage) && pass.type != PassType::Raster) {
+            throw std::invalid_argument("Pass " + pass.name + " isn't a raster pass, it can't render to " + resource.name);
+        }
+        if (std::ranges::any_of(pass.images, [&access](const ImageAccess& other) { return other.image == access.image; })) {
+            throw std::invalid_argument("Pass " + pass.name + " declares " + resource.name + " more than once");
+        }
+
+        pass.images.push_back(access);
+        m_Compiled = false;
+    }
+
+    void FrameGraph::add_access(const uint32_t pass_index, BufferAccess access) {
+        auto& pass = m_Passes[pass_index];
+        if (access.buffer >= m_Buffers.size()) { throw std::invalid_argument("Buffer isn't part of this frame's graph"); }
+        if (std::ranges::any_of(pass.buffers, [&access](const BufferAccess& other) { return other.buffer == access.buffer; })) {
+            throw std::invalid_argument("Pass " + pass.name + " declares " + m_Buffers[access.buffer].name + " more than once");
+        }
+
+        pass.buffers.push_back(access);
+        m_Compiled = false;
+    }
+
+    template<typename T>
+    static uint64_t flag_bits(const vk::Flags<T> flags) {
+        return static_cast<uint64_t>(static_cast<typename vk::Flags<T>::MaskType>(flags));
+    }
+
+    uint64_t FrameGraph::structure_hash() const {
+        // 64-bit FNV-1a over everything a compile looks at. Handles, names and clear values are left out: they change without changing the plan.
+        uint64_t   hash = 0xcbf29ce484222325;
+        const auto add  = [&hash](uint64_t value) {
+            for (int i = 0; i < 8; i++, value >>= 8) { hash = (hash ^ (value & 0xff)) * 0x100000001b3; }
+        };
+        const auto add_image_state = [&add](const ImageState& state) {
+            add(static_cast<uint64_t>(state.layout));
+            add(flag_bits(state.stage));
+            add(flag_bits(state.access));
+        };
+
+        add(m_Images.size());
+        for (const auto& image : m_Images) {
+            add(image.imported);
+            add(static_cast<uint64_t>(image.format));
+            add(static_cast<uint64_t>(image.extent.width) << 32 | image.extent.height);
+            add(static_cast<uint64_t>(image.samples));
+            add_image_state(image.initial);
+            add_image_state(image.final);
+        }
+
+        add(m_Buffers.size());
+        for (const auto& buffer : m_Buffers) {
+            add(flag_bits(buffer.initial.stage));
+            add(flag_bits(buffer.initial.access));
+        }
+
+        add(m_Passes.size());
+        for (const auto& pass : m_Passes) {
+            add(static_cast<uint64_t>(pass.type));
+            add(pass.side_effect);
+            add(pass.images.size());
+            for (const auto& access : pass.images) {
+                add(access.image);
+                add(static_cast<uint64_t>(access.usage) << 2 | access.write << 1 | access.clear.has_value());
+            }
+            add(pass.buffers.size());
+            for (const auto& access : pass.buffers) {
+                add(access.buffer);
+                add(static_cast<uint64_t>(access.usage) << 1 | access.write);
+            }
+        }
+        return hash;
+    }
+
+    void FrameGraph::compile() {
+        const auto hash = structure_hash();
+        if (hash != m_Hash) {
+            const auto alive = cull();
+            allocate_transients(alive);
+            plan_barriers(alive);
+
+            m_Hash = hash;
+            m_Stats.pass_count   = static_cast<uint32_t>(m_Passes.size());
+            m_Stats.culled_count = static_cast<uint32_t>(std::ranges::count(alive, false));
+            m_Stats.compile_count++;
+        }
+
+        for (std::size_t i = 0; i < m_Images.size(); i++) {
+            if (m_Images[i].imported) { continue; }
+            m_Images[i].image = m_Transients[i].image;
+            m_Images[i].view  = m_Transients[i].view;
+        }
+        m_Compiled = true;
+    }
+
+    std::vector<bool> FrameGraph::cull() const {
+        // Walking backwards, a pass is needed if it writes something a needed pass (or the caller) will look at. Buffers can only be imported,
+        // so everything writing one is needed. Clearing an image means nothing before it has to have written it.
+        std::vector<bool> alive(m_Passes.size(), false);
+        std::vector<bool> needed(m_Images.size(), false);
+        for (std::size_t i = 0; i < m_Images.size(); i++) { needed[i] = m_Images[i].imported; }
+
+        for (auto p = m_Passes.size(); p-- > 0;) {
+            const auto& pass    = m_Passes[p];
+            const auto  output  = [&needed](const ImageAccess& access) { return access.write && needed[access.image]; };
+            const bool  outputs = std::ranges::any_of(pass.images, output);
+            if (!pass.side_effect && !outputs && std::ranges::none_of(pass.buffers, &BufferAccess::write)) { continue; }
+
+            alive[p] = true;
+            for (const auto& access : pass.images) { needed[access.image] = !(access.write && access.clear); }
+        }
+        return alive;
+    }
+
+    void FrameGraph::allocate_transients(const std::vector<bool>& alive) {
+        struct Lifetime {
+            uint32_t            first           = UINT32_MAX;
+            uint32_t            last            = 0;
+            bool                attachment_only = true;
+            vk::ImageUsageFlags usage;
+        };
+        std::vector<Lifetime> lifetimes(m_Images.size());
+        for (uint32_t p = 0; p < m_Passes.size(); p++) {
+            if (!alive[p]) { continue; }
+            for (const auto& access : m_Passes[p].images) {
+                const bool attachment = access.usage == ImageUsage::ColorAttachment || access.usage == ImageUsage::DepthAttachment;
+
+                auto& lifetime           = lifetimes[access.image];
+                lifetime.first           = std::min(lifetime.first, p);
+                lifetime.last            = p;
+                lifetime.usage          |= usage_info(access.usage, m_Passes[p].type).image_usage;
+                lifetime.attachment_only = lifetime.attachment_only && attachment;
+            }
+        }
+
+        // An attachment which only lives inside one pass is never loaded or stored, so its contents never have to exist in memory.
+        std::vector<uint32_t>                         images;
+        std::vector<TransientAttachmentPool::Request> requests;
+        for (uint32_t i = 0; i < m_Images.size(); i++) {
+            const auto& resource = m_Images[i];
+            const auto& lifetime = lifetimes[i];
+            if (resource.imported || lifetime.first == UINT32_MAX) { continue; }
+
+            const TransientImageKey key{resource.format, resource.extent, resource.samples, lifetime.usage};
+            images.push_back(i);
+            requests.push_back({key, lifetime.first, lifetime.last, lifetime.first == lifetime.last && lifetime.attachment_only});
+        }
+
+        // The previous allocation's blocks go back to the pool, which keeps them from everyone until the frames using them are done.
+        if (m_Allocation.id) { m_Pool->release(m_Allocation.id); }
+        m_Allocation = {}; // if allocating throws
+        m_Allocation = m_Pool->allocate(requests);
+
+        m_Transients.assign(m_Images.size(), {});
+        for (std::size_t r = 0; r < images.size(); r++) {
+            const auto& target      = m_Allocation.targets[r];
+            m_Transients[images[r]] = {target.image, target.view, target.block};
+        }
+
+        m_Stats.transient_count = static_cast<uint32_t>(requests.size());
+        m_Stats.transient_bytes = m_Allocation.bytes;
+        m_Stats.requested_bytes = m_Allocation.requested_bytes;
+    }
+
+    void FrameGraph::plan_barriers(const std::vector<bool>& alive) {
+        m_Steps.clear();
+        m_FinalBarriers.clear();
+        m_Stats.barrier_count = 0;
+
+        // Store ops, found walking backwards: an attachment is stored if the caller gets it, or a later pass looks at what it holds.
+        std::vector<std::vector<bool>> stores(m_Passes.size());
+        std::vector<bool>              used_later(m_Images.size(), false);
+        for (auto p = m_Passes.size(); p-- > 0;) {
+            if (!alive[p]) { continue; }
+            for (const auto& access : m_Passes[p].images) {
+                stores[p].push_back(m_Images[access.image].imported || used_later[access.image]);
+                used_later[access.image] = !(access.write && access.clear);
+            }
+        }
+
+        // A transient image may share its memory with others, and with itself in the previous frame. Its first barrier waits for all of them.
+        std::vector<vk::PipelineStageFlags2> memory_stages(m_Allocation.block_count);
+        std::vector<vk::AccessFlags2>        memory_access(m_Allocation.block_count);
+        for (uint32_t p = 0; p < m_Passes.size(); p++) {
+            if (!alive[p]) { continue; }
+            for (const auto& access : m_Passes[p].images) {
+                const auto memory = m_Transients[access.image].memory;
+                if (m_Images[access.image].imported || memory == UINT32_MAX) { continue; }
+
+                const auto info        = usage_info(access.usage, m_Passes[p].type);
+                memory_stages[memory] |= info.stage;
+                if (access.write) { memory_access[memory] |= info.write_access; }
+            }
+        }
+
+        std::vector<TrackedState> images(m_Images.size());
+        for (std::size_t i = 0; i < m_Images.size(); i++) {
+            const auto& resource = m_Images[i];
+            if (resource.imported) {
+                const auto& initial = resource.initial;
+                images[i] = {initial.layout, initial.stage, initial.access, {}, {}, {}, initial.layout != vk::ImageLayout::eUndefined};
+            } else if (const auto memory = m_Transients[i].memory; memory != UINT32_MAX) {
+                images[i] = {vk::ImageLayout::eUndefined, memory_stages[memory], memory_access[memory], {}, {}, {}, false};
+            }
+        }
+
+        std::vector<TrackedState> buffers(m_Buffers.size());
+        for (std::size_t i = 0; i < m_Buffers.size(); i++) {
+            buffers[i] = {vk::ImageLayout::eUndefined, m_Buffers[i].initial.stage, m_Buffers[i].initial.access, {}, {}, {}, true};
+        }
+
+        for (uint32_t p = 0; p < m_Passes.size(); p++) {
+            if (!alive[p]) { continue; }
+            const auto& pass = m_Passes[p];
+            Step        step{p};
+
+            for (uint32_t a = 0; a < pass.images.size(); a++) {
+                const auto& access = pass.images[a];
+                const auto  info   = usage_info(access.usage, pass.type);
+                const auto  dst    = destination_access(info, access.write);
+                auto&       state  = images[access.image];
+
+                if (state.layout != info.layout || access.write) {
+                    // Transitions and writes wait for the last write, and every read since.
+                    const auto src_stages = state.write_stages | state.read_stages;
+                    if (state.layout != info.layout || src_stages) {
+                        step.image_barriers.push_back({access.image, src_stages, state.write_access, info.stage, dst, state.layout, info.layout});
+                    }
+
+                    state.layout        = info.layout;
+                    state.write_stages  = info.stage;
+                    state.write_access  = access.write ? info.write_access : vk::AccessFlags2{};
+                    state.read_stages   = access.write ? vk::PipelineStageFlags2{} : info.stage;
+                    state.synced_stages = info.stage;
+                    state.synced_access = dst;
+                } else {
+                    // Reads in the same layout only wait if the write hasn't been made visible to them by an earlier barrier.
+                    const bool synced = !(info.stage & ~state.synced_stages) && !(info.read_access & ~state.synced_access);
+                    if (state.write_stages && !synced) {
+                        step.image_barriers.push_back(
+                          {access.image, state.write_stages, state.write_access, info.stage, info.read_access, state.layout, state.layout}
+                        );
+                        state.synced_stages |= info.stage;
+                        state.synced_access |= info.read_access;
+                    }
+                    state.read_stages |= info.stage;
+                }
+
+                if (is_attachment(access.usage)) {
+                    const auto& resource = m_Images[access.image];
+                    Attachment  attachment{a, info.layout, vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eDontCare};
+                    if (access.clear) {
+                        attachment.load = vk::AttachmentLoadOp::eClear;
+                    } else if (state.contents) {
+                        attachment.load = vk::AttachmentLoadOp::eLoad;
+                    }
+                    if (access.usage == ImageUsage::DepthReadOnly) {
+                        attachment.store = vk::AttachmentStoreOp::eNone;
+                    } else if (stores[p][a]) {
+                        attachment.store = vk::AttachmentStoreOp::eStore;
+                    }
+
+                    if (step.colors.empty() && !step.depth) {
+                        step.extent = resource.extent;
+                    } else {
+                        const auto& first = m_Images[pass.images[step.colors.empty() ? step.depth->access : step.colors[0].access].image];
+                        if (resource.extent != first.extent || resource.samples != first.samples) {
+                            throw std::invalid_argument("Attachments of pass " + pass.name + " differ in extent or sample count");
+                        }
+                    }
+
+                    if (access.usage == ImageUsage::ColorAttachment) {
+                        step.colors.push_back(attachment);
+                    } else if (step.depth) {
+                        throw std::invalid_argument("Pass " + pass.name + " has more than one depth attachment");
+                    } else {
+                        step.depth = attachment;
+                    }
+                }
+                if (access.write) { state.contents = true; }
+            }
+
+            for (const auto& access : pass.buffers) {
+                const auto info  = usage_info(access.usage, pass.type);
+                const auto dst   = destination_access(info, access.write);
+                auto&      state = buffers[access.buffer];
+
+                if (access.write) {
+                    const auto src_stages = state.write_stages | state.read_stages;
+                    if (src_stages) { step.buffer_barriers.push_back({access.buffer, src_stages, state.write_access, info.stage, dst}); }
+
+                    state.write_stages  = info.stage;
+                    state.write_access  = info.write_access;
+                    state.read_stages   = {};
+                    state.synced_stages = info.stage;
+                    state.synced_access = dst;
+                } else {
+                    const bool synced = !(info.stage & ~state.synced_stages) && !(info.read_access & ~state.synced_access);
+                    if (state.write_stages && !synced) {
+                        step.buffer_barriers.push_back({access.buffer, state.write_stages, state.write_access, info.stage, info.read_access});
+                        state.synced_stages |= info.stage;
+                        state.synced_access |= info.read_access;
+                    }
+                    state.read_stages |= info.stage;
+                }
+            }
+
+            if (pass.type == PassType::Raster && step.colors.empty() && !step.depth) {
+                throw std::invalid_argument("Raster pass " + pass.name + " has no attachments");
+            }
+
+            m_Stats.barrier_count += static_cast<uint32_t>(step.image_barriers.size() + step.buffer_barriers.size());
+            m_Steps.push_back(std::move(step));
+        }
+
+        // Imported images are handed back in the layout the caller asked for.
+        for (uint32_t i = 0; i < m_Images.size(); i++) {
+            if (!m_Images[i].imported) { continue; }
+
+            const auto& state      = images[i];
+            const auto& final      = m_Images[i].final;
+            const auto  src_stages = state.write_stages | state.read_stages;
+            if (state.layout != final.layout || (final.stage && src_stages)) {
+                m_FinalBarriers.push_back({i, src_stages, state.write_access, final.stage, final.access, state.layout, final.layout});
+            }
+        }
+        m_Stats.barrier_count += static_cast<uint32_t>(m_FinalBarriers.size());
+    }
+
+    void FrameGraph::execute(const vk::CommandBuffer command_buffer) {
+        if (!m_Compiled) { throw std::runtime_error("Frame graph has changed since it was last compiled"); }
+
+        // Barriers the passes add for themselves (e.g. between dispatches) land in the same batch, and go out with the graph's own.
+        const auto record_barriers = [&](const std::vector<ImageBarrier>& images, const std::vector<BufferBarrier>& buffers) {
+            for (const auto& barrier : images) {
+                const auto& resource = m_Images[barrier.image];
+                m_Barriers.image_barrier(
+                  resource.image, {format_info(resource.format).aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}, barrier.src_stage,
+                  {barrier.old_layout, barrier.src_access}, barrier.dst_stage, {barrier.new_layout, barrier.dst_access}
+                );
+            }
+            for (const auto& barrier : buffers) {
+                m_Barriers.buffer_barrier(
+                  m_Buffers[barrier.buffer].buffer, 0, vk::WholeSize, barrier.src_stage, barrier.src_access, barrier.dst_stage, barrier.dst_access
+                );
+            }
+            m_Barriers.flush(command_buffer);
+        };
+
+        std::vector<vk::RenderingAttachmentInfo> colors;
+        for (const auto& step : m_Steps) {
+            const auto& pass = m_Passes[step.pass];
+            record_barriers(step.image_barriers, step.buffer_barriers);
+
+            const PassContext context{command_buffer, step.extent, this, &m_Barriers};
+            if (pass.type != PassType::Raster) {
+                if (pass.record) { pass.record(context); }
+                continue;
+            }
+
+            const auto attachment_info = [&pass, this](const Attachment& attachment) {
+                const auto&                 access = pass.images[attachment.access];
+                vk::RenderingAttachmentInfo info{};
+                info.imageView   = m_Images[access.image].view;
+                info.imageLayout = attachment.layout;
+                info.resolveMode = vk::ResolveModeFlagBits::eNone;
+                info.loadOp      = attachment.load;
+                info.storeOp     = attachment.store;
+                if (access.clear) { info.clearValue = *access.clear; }
+                return info;
+            };
+
+            colors.clear();
+            for (const auto& color : step.colors) { colors.push_back(attachment_info(color)); }
+            const auto depth = step.depth ? attachment_info(*step.depth) : vk::RenderingAttachmentInfo{};
+
+            vk::RenderingInfo rendering_info{};
+            rendering_info.setColorAttachments(colors);
+            rendering_info.pDepthAttachment = step.depth ? &depth : nullptr;
+            rendering_info.renderArea       = vk::Rect2D({0, 0}, step.extent);
+            rendering_info.layerCount       = 1;
+
+            command_buffer.beginRendering(rendering_info);
+            if (pass.record) { pass.record(context); }
+            command_buffer.endRendering();
+        }
+
+        record_barriers(m_FinalBarriers, {});
+    }
+
+    vk::Image FrameGraph::image(const ImageId id) const {
+        return id.index < m_Images.size() ? m_Images[id.index].image : nullptr;
+    }
+
+    vk::ImageView FrameGraph::view(const ImageId id) const {
+        return id.index < m_Images.size() ? m_Images[id.index].view : nullptr;
+    }
+
+    vk::Buffer FrameGraph::buffer(const BufferId id) const {
+        return id.index < m_Buffers.size() ? m_Buffers[id.index].buffer : nullptr;
+    }
+} // namespace vke
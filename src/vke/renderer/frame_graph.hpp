@@ -0,0 +1,292 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/renderer/transient_pool.hpp"
+#include "vke/utils/barrier_batch.hpp"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vke {
+    // Where an image is, and what last touched it, at the edges of the graph.
+    struct ImageState {
+        vk::ImageLayout         layout = vk::ImageLayout::eUndefined;
+        vk::PipelineStageFlags2 stage  = vk::PipelineStageFlagBits2::eNone;
+        vk::AccessFlags2        access = vk::AccessFlagBits2::eNone;
+    };
+
+    struct BufferState {
+        vk::PipelineStageFlags2 stage  = vk::PipelineStageFlagBits2::eNone;
+        vk::AccessFlags2        access = vk::AccessFlagBits2::eNone;
+    };
+
+    enum class PassType : uint8_t {
+        Raster,   // recorded inside a dynamic rendering scope over the pass's attachments
+        Compute,
+        Transfer,
+    };
+
+    enum class ImageUsage : uint8_t {
+        ColorAttachment,
+        DepthAttachment,
+        DepthReadOnly, // bound as a read-only depth attachment, and sampleable in the same pass
+        Sampled,
+        Storage,
+        TransferSrc,
+        TransferDst,
+    };
+
+    enum class BufferUsage : uint8_t {
+        Vertex,
+        Index,
+        Indirect,
+        Uniform,
+        Storage,
+        TransferSrc,
+        TransferDst,
+    };
+
+    struct FrameGraphStats {
+        uint32_t       pass_count      = 0; // declared in the last compile
+        uint32_t       culled_count    = 0;
+        uint32_t       barrier_count   = 0; // image and buffer barriers per execute
+        uint32_t       transient_count = 0;
+        vk::DeviceSize transient_bytes = 0; // memory the transient images share
+        vk::DeviceSize requested_bytes = 0; // what they would take without aliasing
+        uint64_t       compile_count   = 0;
+    };
+
+    /**
+     * Declarative per-frame rendering: passes say which images and buffers they read and write, and the graph works out everything in between.
+     *
+     * Each frame the graph is reset and declared again, then compiled and executed:
+     *
+     *      graph.reset();
+     *      const auto target = graph.import_image("backbuffer", image, view, format, extent, initial, final);
+     *      const auto depth  = graph.create_image("depth", {vk::Format::eD32Sfloat, extent});
+     *      graph.add_pass("scene", PassType::Raster, [](const FrameGraph::PassContext& context) { ... })
+     *        .color(target, clear_color)
+     *        .depth(depth, clear_depth);
+     *      graph.compile();
+     *      graph.execute(command_buffer);
+     *
+     * Compiling culls the passes whose results nothing uses, places transient images whose lifetimes don't overlap in the same memory, and
+     * works out one batch of barriers (layout transitions included) in front of each pass, plus the load and store op of every attachment.
+     * None of that depends on the resources' handles or clear values, only on the shape of the graph, so a compile which sees the same
+     * structure as the last one returns straight away: a graph that looks the same every frame is only really compiled once.
+     *
+     * Imported resources belong to the caller and are treated as outputs, so passes which write them are never culled. Their contents are
+     * kept if their initial layout isn't eUndefined. Transient images belong to the graph and never outlive the frame: their contents are
+     * only stored for later passes which use them. Their memory comes from a TransientAttachmentPool, and goes back to it when the graph
+     * compiles a different structure.
+     *
+     * Main thread only.
+     */
+    class VKE_API FrameGraph {
+      public:
+        struct Settings {
+            // How many executes a replaced transient image has to wait before its memory is used again.
+            uint32_t frames_in_flight = 2;
+            // Where transient images come from. Graphs of several windows can share one; the graph makes its own if this is empty.
+            std::shared_ptr<TransientAttachmentPool> pool;
+        };
+
+        struct ImageId {
+            uint32_t index = UINT32_MAX;
+        };
+
+        struct BufferId {
+            uint32_t index = UINT32_MAX;
+        };
+
+        struct TransientImageInfo {
+            vk::Format              format;
+            vk::Extent2D            extent;
+            vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1;
+        };
+
+        struct PassContext {
+            vk::CommandBuffer command_buffer;
+            vk::Extent2D      extent; // the render area of raster passes
+            const FrameGraph* graph;
+            BarrierBatch*     barriers; // for barriers between a compute or transfer pass's own commands, flushed before the one needing them
+        };
+
+        using RecordFunction = std::function<void(const PassContext&)>;
+
+        class VKE_API PassBuilder {
+          public:
+            // Rendered to. Without a clear value the previous contents are loaded, if there are any.
+            PassBuilder& color(ImageId image, std::optional<vk::ClearColorValue> clear = std::nullopt);
+            PassBuilder& depth(ImageId image, std::optional<vk::ClearDepthStencilValue> clear = std::nullopt);
+
+            PassBuilder& read(ImageId image, ImageUsage usage);
+            PassBuilder& write(ImageId image, ImageUsage usage);
+            PassBuilder& read(BufferId buffer, BufferUsage usage);
+            PassBuilder& write(BufferId buffer, BufferUsage usage);
+
+            // Never culled, for passes whose effects the graph can't see.
+            PassBuilder& side_effect();
+
+          private:
+            PassBuilder(FrameGraph& graph, uint32_t pass) : m_Graph(graph), m_Pass(pass) {}
+
+            FrameGraph& m_Graph;
+            uint32_t    m_Pass;
+
+            friend class FrameGraph;
+        };
+
+        explicit FrameGraph(const Settings& settings);
+        ~FrameGraph();
+
+        FrameGraph(const FrameGraph&)            = delete;
+        FrameGraph& operator=(const FrameGraph&) = delete;
+
+        // Forgets the previous frame's declarations (but not what was compiled from them).
+        void reset();
+
+        ImageId import_image(
+          std::string_view name, vk::Image image, vk::ImageView view, vk::Format format, vk::Extent2D extent, const ImageState& initial,
+          const ImageState& final
+        );
+        BufferId import_buffer(std::string_view name, vk::Buffer buffer, const BufferState& initial = {});
+        ImageId  create_image(std::string_view name, const TransientImageInfo& info);
+
+        PassBuilder add_pass(std::string_view name, PassType type, RecordFunction record);
+
+        // Throws std::invalid_argument if a raster pass has no attachments, or its attachments differ in extent or sample count.
+        void compile();
+
+        // Records every pass that survived culling. compile() has to have been called since the last change to the declarations.
+        void execute(vk::CommandBuffer command_buffer);
+
+        [[nodiscard]] vk::Image     image(ImageId id) const;
+        [[nodiscard]] vk::ImageView view(ImageId id) const;
+        [[nodiscard]] vk::Buffer    buffer(BufferId id) const;
+
+        [[nodiscard]] inline const FrameGraphStats& stats() const noexcept { return m_Stats; }
+
+      private:
+        struct ImageResource {
+            std::string             name;
+            bool                    imported;
+            vk::Image               image;
+            vk::ImageView           view;
+            vk::Format              format;
+            vk::Extent2D            extent;
+            vk::SampleCountFlagBits samples;
+            ImageState              initial;
+            ImageState              final;
+        };
+
+        struct BufferResource {
+            std::string name;
+            vk::Buffer  buffer;
+            BufferState initial;
+        };
+
+        struct ImageAccess {
+            uint32_t                      image;
+            ImageUsage                    usage;
+            bool                          write;
+            std::optional<vk::ClearValue> clear;
+        };
+
+        struct BufferAccess {
+            uint32_t    buffer;
+            BufferUsage usage;
+            bool        write;
+        };
+
+        struct Pass {
+            std::string               name;
+            PassType                  type;
+            RecordFunction            record;
+            std::vector<ImageAccess>  images;
+            std::vector<BufferAccess> buffers;
+            bool                      side_effect = false;
+        };
+
+        // Barriers refer to resources by index, the handles are filled in when they are recorded.
+        struct ImageBarrier {
+            uint32_t                image;
+            vk::PipelineStageFlags2 src_stage;
+            vk::AccessFlags2        src_access;
+            vk::PipelineStageFlags2 dst_stage;
+            vk::AccessFlags2        dst_access;
+            vk::ImageLayout         old_layout;
+            vk::ImageLayout         new_layout;
+        };
+
+        struct BufferBarrier {
+            uint32_t                buffer;
+            vk::PipelineStageFlags2 src_stage;
+            vk::AccessFlags2        src_access;
+            vk::PipelineStageFlags2 dst_stage;
+            vk::AccessFlags2        dst_access;
+        };
+
+        struct Attachment {
+            uint32_t              access; // into the pass's image accesses, for the view and clear value
+            vk::ImageLayout       layout;
+            vk::AttachmentLoadOp  load;
+            vk::AttachmentStoreOp store;
+        };
+
+        struct Step {
+            uint32_t                   pass;
+            std::vector<ImageBarrier>  image_barriers;
+            std::vector<BufferBarrier> buffer_barriers;
+            std::vector<Attachment>    colors;
+            std::optional<Attachment>  depth;
+            vk::Extent2D               extent;
+        };
+
+        struct Transient {
+            vk::Image     image;
+            vk::ImageView view;
+            uint32_t      memory = UINT32_MAX; // block of m_Allocation, shared by images whose lifetimes don't overlap
+        };
+
+        [[nodiscard]] uint64_t structure_hash() const;
+
+        Pass&          pass(uint32_t index);
+        ImageResource& image_resource(ImageId id);
+
+        void add_access(uint32_t pass, ImageAccess access);
+        void add_access(uint32_t pass, BufferAccess access);
+
+        [[nodiscard]] std::vector<bool> cull() const;
+        void                            allocate_transients(const std::vector<bool>& alive);
+        void                            plan_barriers(const std::vector<bool>& alive);
+
+        std::shared_ptr<Device> m_Device;
+        Settings                m_Settings;
+
+        std::vector<ImageResource>  m_Images;
+        std::vector<BufferResource> m_Buffers;
+        std::vector<Pass>           m_Passes;
+
+        // What the last compile produced. Transients are indexed like m_Images (imported images get an empty entry).
+        bool                                     m_Compiled = false; // since the declarations last changed
+        std::optional<uint64_t>                  m_Hash;
+        std::vector<Step>                        m_Steps;
+        std::vector<ImageBarrier>                m_FinalBarriers;
+        std::vector<Transient>                   m_Transients;
+        std::shared_ptr<TransientAttachmentPool> m_Pool;
+        TransientAttachmentPool::Allocation      m_Allocation;
+        BarrierBatch                             m_Barriers;
+
+        FrameGraphStats m_Stats;
+    };
+
+} // namespace vke
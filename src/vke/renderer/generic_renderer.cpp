@@ -5,13 +5,17 @@
 #include "vke/renderer/generic_renderer.hpp"
 
 #include "vke/global.hpp"
-#include "vke/utils/utils.hpp"
 
 #include "vke/vke.hpp"
 
 namespace vke {
-    GenericDynamicRenderer::GenericDynamicRenderer(const Setup& setup) : Renderer(setup) {
+    GenericDynamicRenderer::GenericDynamicRenderer(const Setup& setup)
+        : GenericDynamicRenderer(setup, std::make_shared<TransientAttachmentPool>(TransientAttachmentPool::Settings{setup.frames_in_flight})) {}
+
+    GenericDynamicRenderer::GenericDynamicRenderer(const Setup& setup, const std::shared_ptr<TransientAttachmentPool>& transient_pool)
+        : Renderer(setup), m_Graph(FrameGraph::Settings{setup.frames_in_flight, transient_pool}) {
         const auto image_supplier = setup.image_supplier.get();
+        transient_pool->watch(setup.image_supplier);
 
         m_ImageViews.resize(image_supplier->get_images().size());
         for (std::size_t i = 0; i < image_supplier->get_images().size(); i++) {
@@ -27,8 +31,9 @@ namespace vke {
         register_listener(
           image_supplier->on_images_changed, image_supplier->on_images_changed.append([this, image_supplier](const std::vector<vk::Image>& images) {
               const auto image_props = image_supplier->get_image_properties();
+              // The old views may still be in use by frames in flight.
               for (const auto& iv : m_ImageViews) {
-                  global::g_Device->destroy(iv);
+                  global::g_Device->defer_destroy(iv);
               }
 
               m_ImageViews.resize(images.size());
@@ -47,40 +52,33 @@ namespace vke {
 
     GenericDynamicRenderer::~GenericDynamicRenderer() {
         for (const auto& iv : m_ImageViews) {
-            global::g_Device->destroy(iv);
+            global::g_Device->defer_destroy(iv);
         }
     }
 
     void GenericDynamicRenderer::render_frame(const FrameInfo& frame_info) {
-        static constexpr vk::ImageSubresourceRange isr{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
-        utils::insert_layout_transition(
-          frame_info.command_buffer, frame_info.image, isr, vk::PipelineStageFlagBits2::eTopOfPipe,
-          {vk::ImageLayout::eUndefined, vk::AccessFlagBits2::eNone}, vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-          {vk::ImageLayout::eColorAttachmentOptimal, vk::AccessFlagBits2::eColorAttachmentWrite}
-        );
+        pre_draw(frame_info);
 
-        const vk::ClearColorValue   clear_value{m_ClearColor.r, m_ClearColor.g, m_ClearColor.b, m_ClearColor.a};
-        vk::RenderingInfo           rendering_info{};
-        vk::RenderingAttachmentInfo color_attachment_info{};
-        color_attachment_info.clearValue  = clear_value;
-        color_attachment_info.imageView   = m_ImageViews[frame_info.image_index];
-        color_attachment_info.imageLayout = vk::ImageLayout::eColorAttachmentOptimal;
-        color_attachment_info.loadOp      = vk::AttachmentLoadOp::eClear;
-        color_attachment_info.storeOp     = vk::AttachmentStoreOp::eStore;
-        color_attachment_info.resolveMode = vk::ResolveModeFlagBits::eNone;
-        rendering_info.setColorAttachments(color_attachment_info);
-        rendering_info.renderArea = vk::Rect2D({0, 0}, {frame_info.image_properties.extent.width, frame_info.image_properties.extent.height});
-        rendering_info.layerCount = 1;
-
-        frame_info.command_buffer.beginRendering(rendering_info);
-        draw(frame_info);
-        frame_info.command_buffer.endRendering();
-
-        utils::insert_layout_transition(
-          frame_info.command_buffer, frame_info.image, isr, vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-          {vk::ImageLayout::eColorAttachmentOptimal, vk::AccessFlagBits2::eColorAttachmentWrite}, vk::PipelineStageFlagBits2::eBottomOfPipe,
-          {vk::ImageLayout::ePresentSrcKHR, vk::AccessFlagBits2::eNone}
+        // The swapchain image's previous contents are never looked at, and it goes back to the surface to be presented.
+        m_Graph.reset();
+        const auto backbuffer = m_Graph.import_image(
+          "backbuffer", frame_info.image, m_ImageViews[frame_info.image_index], frame_info.image_properties.format,
+          {frame_info.image_properties.extent.width, frame_info.image_properties.extent.height},
+          {vk::ImageLayout::eUndefined, vk::PipelineStageFlagBits2::eTopOfPipe, vk::AccessFlagBits2::eNone},
+          {vk::ImageLayout::ePresentSrcKHR, vk::PipelineStageFlagBits2::eBottomOfPipe, vk::AccessFlagBits2::eNone}
         );
+        build_graph(m_Graph, frame_info, backbuffer);
+
+        m_Graph.compile();
+        m_Graph.execute(frame_info.command_buffer);
+    }
+
+    void GenericDynamicRenderer::pre_draw(const FrameInfo& frame_info) {}
+
+    void GenericDynamicRenderer::build_graph(FrameGraph& graph, const FrameInfo& frame_info, const FrameGraph::ImageId backbuffer) {
+        const vk::ClearColorValue clear_value{m_ClearColor.r, m_ClearColor.g, m_ClearColor.b, m_ClearColor.a};
+        graph.add_pass("draw", PassType::Raster, [this, &frame_info](const FrameGraph::PassContext&) { draw(frame_info); })
+          .color(backbuffer, clear_value);
     }
 
     void GenericDynamicRenderer::set_viewport(const FrameInfo& frame_info) {
@@ -6,6 +6,7 @@
 
 #include "vke/pre.hpp"
 
+#include "vke/renderer/frame_graph.hpp"
 #include "vke/renderer/renderer.hpp"
 #include "vke/vke.hpp"
 
@@ -16,13 +17,21 @@ namespace vke {
     class VKE_API GenericDynamicRenderer : public Renderer {
       public:
         explicit GenericDynamicRenderer(const Setup& setup);
+        // Renderers of several windows can share one pool of transient attachments. It is trimmed whenever this renderer's images change.
+        GenericDynamicRenderer(const Setup& setup, const std::shared_ptr<TransientAttachmentPool>& transient_pool);
 
         ~GenericDynamicRenderer() override;
 
         void render_frame(const FrameInfo& frame_info) override;
 
+        // Recorded before the rendering scope begins, for work which can't happen inside of it (compute dispatches, copies, culling, etc).
+        virtual void pre_draw(const FrameInfo& frame_info);
         virtual void draw(const FrameInfo& frame_info) = 0;
 
+        // Declares the frame's passes. The default is a single pass which clears the backbuffer to the clear color and calls draw(). Overrides
+        // can add passes before and after it, or replace it; the backbuffer is handed to the surface in ePresentSrcKHR either way.
+        virtual void build_graph(FrameGraph& graph, const FrameInfo& frame_info, FrameGraph::ImageId backbuffer);
+
         static void set_viewport(const FrameInfo& frame_info);
         static void set_scissor(const FrameInfo& frame_info);
 
@@ -31,5 +40,6 @@ namespace vke {
 
       private:
         std::vector<vk::ImageView> m_ImageViews;
+        FrameGraph                 m_Graph;
     };
 } // namespace vke
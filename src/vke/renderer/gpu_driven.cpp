@@ -0,0 +1,244 @@
+//
+// Created by andy on 3/25/2025.
+//
+
+#include "gpu_driven.hpp"
+
+#include "vke/global.hpp"
+
+#include <stdexcept>
+
+namespace vke {
+    std::array<glm::vec4, 6> extract_frustum_planes(const glm::mat4& view_projection) {
+        const auto row = [&](const int i) { return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]); };
+
+        std::array<glm::vec4, 6> planes{
+          row(3) + row(0), // left
+          row(3) - row(0), // right
+          row(3) + row(1), // bottom
+          row(3) - row(1), // top
+          row(2),          // near (0..1 depth)
+          row(3) - row(2), // far
+        };
+
+        for (auto& plane : planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return planes;
+    }
+
+    static vk::DescriptorSetLayout create_cull_set_layout(const Device& device, const bool with_hiz) {
+        std::vector<vk::DescriptorSetLayoutBinding> bindings{
+          {0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eCompute}, // uniforms
+          {1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute}, // bounds
+          {2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute}, // draw records
+          {3, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute}, // batch offsets
+          {4, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute}, // commands
+          {5, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute}, // counts
+        };
+        if (with_hiz) { bindings.emplace_back(6, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute); }
+
+        vk::DescriptorSetLayoutCreateInfo create_info{};
+        create_info.flags = vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptor;
+        create_info.setBindings(bindings);
+        return device.handle().createDescriptorSetLayout(create_info);
+    }
+
+    GpuDrivenScene::GpuDrivenScene(const Settings& settings) : m_Device(global::g_Device), m_Settings(settings) {
+        constexpr auto host_memory = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+
+        m_Frames.resize(m_Settings.frames_in_flight);
+        for (auto& frame : m_Frames) {
+            frame.uniforms = Buffer::create({sizeof(GpuCullUniforms), vk::BufferUsageFlagBits::eUniformBuffer, host_memory});
+            frame.bounds   = Buffer::create({sizeof(glm::vec4) * m_Settings.max_objects, vk::BufferUsageFlagBits::eStorageBuffer, host_memory});
+            frame.draws    = Buffer::create({sizeof(GpuDrawRecord) * m_Settings.max_objects, vk::BufferUsageFlagBits::eStorageBuffer, host_memory});
+        }
+
+        // Batch offsets are only ever appended, so a slot the GPU is reading never changes.
+        m_BatchOffsets = Buffer::create({sizeof(uint32_t) * m_Settings.max_batches, vk::BufferUsageFlagBits::eStorageBuffer, host_memory});
+        m_Commands = Buffer::create({
+          sizeof(vk::DrawIndexedIndirectCommand) * m_Settings.max_objects,
+          vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer,
+        });
+        m_Counts = Buffer::create({
+          sizeof(uint32_t) * m_Settings.max_batches,
+          vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst,
+        });
+
+        m_SetLayout    = create_cull_set_layout(*m_Device, false);
+        m_CullPipeline = std::make_unique<ComputePipeline>(ComputePipeline::Settings{
+          .shader_module = m_Settings.cull_shader,
+          .layout        = PipelineLayout::create({.set_layouts = {m_SetLayout}}),
+        });
+
+        if (m_Settings.hiz_cull_shader) {
+            m_HizSetLayout    = create_cull_set_layout(*m_Device, true);
+            m_HizCullPipeline = std::make_unique<ComputePipeline>(ComputePipeline::Settings{
+              .shader_module = m_Settings.hiz_cull_shader,
+              .layout        = PipelineLayout::create({.set_layouts = {m_HizSetLayout}}),
+            });
+        }
+    }
+
+    GpuDrivenScene::~GpuDrivenScene() {
+        m_CullPipeline.reset();
+        m_HizCullPipeline.reset();
+
+        m_Device->destroy(m_SetLayout);
+        if (m_HizSetLayout) { m_Device->destroy(m_HizSetLayout); }
+    }
+
+    uint32_t GpuDrivenScene::add_batch(const GraphicsPipeline* pipeline, const uint32_t capacity) {
+        if (m_Batches.size() >= m_Settings.max_batches) { throw std::length_error("Too many batches in GPU driven scene"); }
+        if (m_CommandCapacity + capacity > m_Settings.max_objects) { throw std::length_error("Batch capacities exceed the scene's max_objects"); }
+
+        const auto batch = static_cast<uint32_t>(m_Batches.size());
+        m_Batches.push_back({pipeline, m_CommandCapacity, capacity, 0});
+        m_BatchOffsets->write(&m_CommandCapacity, sizeof(uint32_t), batch * sizeof(uint32_t));
+        m_CommandCapacity += capacity;
+        return batch;
+    }
+
+    uint32_t GpuDrivenScene::add_object(const glm::vec4& bounding_sphere, const GpuDrawRecord& draw_record) {
+        if (m_Bounds.size() >= m_Settings.max_objects) { throw std::length_error("GPU driven scene is full"); }
+
+        auto& batch = m_Batches.at(draw_record.batch);
+        if (batch.object_count >= batch.capacity) { throw std::length_error("GPU driven scene batch is full"); }
+        batch.object_count++;
+
+        const auto object = static_cast<uint32_t>(m_Bounds.size());
+        m_Bounds.push_back(bounding_sphere);
+        m_Draws.push_back(draw_record);
+        mark_dirty(object);
+        return object;
+    }
+
+    void GpuDrivenScene::update_object(const uint32_t object, const glm::vec4& bounding_sphere) {
+        m_Bounds[object] = bounding_sphere;
+        mark_dirty(object);
+    }
+
+    void GpuDrivenScene::update_object(const uint32_t object, const glm::vec4& bounding_sphere, const GpuDrawRecord& draw_record) {
+        if (draw_record.batch != m_Draws[object].batch) {
+            auto& batch = m_Batches.at(draw_record.batch);
+            if (batch.object_count >= batch.capacity) { throw std::length_error("GPU driven scene batch is full"); }
+            batch.object_count++;
+            m_Batches[m_Draws[object].batch].object_count--;
+        }
+
+        m_Bounds[object] = bounding_sphere;
+        m_Draws[object]  = draw_record;
+        mark_dirty(object);
+    }
+
+    void GpuDrivenScene::mark_dirty(const uint32_t object) {
+        for (auto& frame : m_Frames) {
+            frame.dirty_begin = std::min(frame.dirty_begin, object);
+            frame.dirty_end   = std::max(frame.dirty_end, object + 1);
+        }
+    }
+
+    void GpuDrivenScene::upload(FrameResources& frame) {
+        if (frame.dirty_begin >= frame.dirty_end) { return; }
+
+        const uint32_t count = frame.dirty_end - frame.dirty_begin;
+        frame.bounds->write(m_Bounds.data() + frame.dirty_begin, sizeof(glm::vec4) * count, sizeof(glm::vec4) * frame.dirty_begin);
+        frame.draws->write(m_Draws.data() + frame.dirty_begin, sizeof(GpuDrawRecord) * count, sizeof(GpuDrawRecord) * frame.dirty_begin);
+
+        frame.dirty_begin = UINT32_MAX;
+        frame.dirty_end   = 0;
+    }
+
+    static void memory_barrier(
+      const vk::CommandBuffer       command_buffer,
+      const vk::PipelineStageFlags2 source_stage,
+      const vk::AccessFlags2        source_access,
+      const vk::PipelineStageFlags2 destination_stage,
+      const vk::AccessFlags2        destination_access
+    ) {
+        const vk::MemoryBarrier2 barrier{source_stage, source_access, destination_stage, destination_access};
+
+        vk::DependencyInfo di{};
+        di.setMemoryBarriers(barrier);
+        command_buffer.pipelineBarrier2(di);
+    }
+
+    void GpuDrivenScene::cull(const Renderer::FrameInfo& frame_info, const GpuCullParameters& parameters) {
+        auto& frame = m_Frames[frame_info.frame_index];
+        upload(frame);
+
+        const GpuCullUniforms uniforms{
+          .view_projection = parameters.view_projection,
+          .frustum_planes  = extract_frustum_planes(parameters.view_projection),
+          .hiz_size        = parameters.hiz_size,
+          .object_count    = object_count(),
+          .padding         = 0,
+        };
+        frame.uniforms->write(&uniforms, sizeof(uniforms));
+
+        const vk::CommandBuffer command_buffer = frame_info.command_buffer;
+
+        // The previous frame's indirect draws have to be done with the commands and counts before they get overwritten.
+        memory_barrier(
+          command_buffer, vk::PipelineStageFlagBits2::eDrawIndirect, vk::AccessFlagBits2::eIndirectCommandRead,
+          vk::PipelineStageFlagBits2::eClear | vk::PipelineStageFlagBits2::eComputeShader,
+          vk::AccessFlagBits2::eTransferWrite | vk::AccessFlagBits2::eShaderStorageWrite
+        );
+
+        command_buffer.fillBuffer(m_Counts->handle(), 0, vk::WholeSize, 0);
+
+        memory_barrier(
+          command_buffer, vk::PipelineStageFlagBits2::eClear, vk::AccessFlagBits2::eTransferWrite, vk::PipelineStageFlagBits2::eComputeShader,
+          vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite
+        );
+
+        if (object_count() > 0) {
+            const bool             use_hiz  = parameters.hiz_view && m_HizCullPipeline;
+            const ComputePipeline& pipeline = use_hiz ? *m_HizCullPipeline : *m_CullPipeline;
+
+            const std::array<vk::DescriptorBufferInfo, 6> buffer_infos{
+              vk::DescriptorBufferInfo{frame.uniforms->handle(), 0, vk::WholeSize},
+              vk::DescriptorBufferInfo{frame.bounds->handle(),   0, vk::WholeSize},
+              vk::DescriptorBufferInfo{frame.draws->handle(),    0, vk::WholeSize},
+              vk::DescriptorBufferInfo{m_BatchOffsets->handle(), 0, vk::WholeSize},
+              vk::DescriptorBufferInfo{m_Commands->handle(),     0, vk::WholeSize},
+              vk::DescriptorBufferInfo{m_Counts->handle(),       0, vk::WholeSize},
+            };
+            const vk::DescriptorImageInfo hiz_info{parameters.hiz_sampler, parameters.hiz_view, vk::ImageLayout::eShaderReadOnlyOptimal};
+
+            std::vector<vk::WriteDescriptorSet> writes;
+            writes.reserve(buffer_infos.size() + 1);
+            for (uint32_t binding = 0; binding < buffer_infos.size(); binding++) {
+                writes.emplace_back(
+                  nullptr, binding, 0, 1, binding == 0 ? vk::DescriptorType::eUniformBuffer : vk::DescriptorType::eStorageBuffer, nullptr,
+                  &buffer_infos[binding]
+                );
+            }
+            if (use_hiz) { writes.emplace_back(nullptr, 6, 0, 1, vk::DescriptorType::eCombinedImageSampler, &hiz_info); }
+
+            command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline.handle());
+            command_buffer.pushDescriptorSet(vk::PipelineBindPoint::eCompute, pipeline.layout()->handle(), 0, writes);
+            command_buffer.dispatch((object_count() + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+        }
+
+        memory_barrier(
+          command_buffer, vk::PipelineStageFlagBits2::eComputeShader | vk::PipelineStageFlagBits2::eClear,
+          vk::AccessFlagBits2::eShaderStorageWrite | vk::AccessFlagBits2::eTransferWrite, vk::PipelineStageFlagBits2::eDrawIndirect,
+          vk::AccessFlagBits2::eIndirectCommandRead
+        );
+    }
+
+    void GpuDrivenScene::draw(const Renderer::FrameInfo& frame_info) const {
+        constexpr vk::DeviceSize command_stride = sizeof(vk::DrawIndexedIndirectCommand);
+
+        for (uint32_t i = 0; i < m_Batches.size(); i++) {
+            const auto& batch = m_Batches[i];
+            if (batch.object_count == 0) { continue; }
+
+            frame_info.command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, batch.pipeline->handle());
+            frame_info.command_buffer.drawIndexedIndirectCount(
+              m_Commands->handle(), batch.first_command * command_stride, m_Counts->handle(), i * sizeof(uint32_t), batch.capacity, command_stride
+            );
+        }
+    }
+} // namespace vke
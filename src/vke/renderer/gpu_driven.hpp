@@ -0,0 +1,129 @@
+//
+// Created by andy on 3/25/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/renderer/buffer.hpp"
+#include "vke/renderer/compute_pipeline.hpp"
+#include "vke/renderer/graphics_pipeline.hpp"
+#include "vke/renderer/renderer.hpp"
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+namespace vke {
+
+    // Layouts match res/shaders/cull.comp (std430).
+    struct GpuDrawRecord {
+        uint32_t index_count;
+        uint32_t first_index;
+        int32_t  vertex_offset;
+        uint32_t batch;
+    };
+
+    struct GpuCullUniforms {
+        glm::mat4                view_projection;
+        std::array<glm::vec4, 6> frustum_planes;
+        glm::vec2                hiz_size;
+        uint32_t                 object_count;
+        uint32_t                 padding;
+    };
+
+    struct GpuCullParameters {
+        glm::mat4 view_projection;
+
+        // Optional Hi-Z occlusion culling. The view must be a max-reduced depth pyramid of the previous frame (standard 0..1 depth) in
+        // eShaderReadOnlyOptimal, and the scene must have been created with a hiz_cull_shader.
+        vk::ImageView hiz_view    = nullptr;
+        vk::Sampler   hiz_sampler = nullptr;
+        glm::vec2     hiz_size    = glm::vec2(0.0f);
+    };
+
+    // Planes are (normal, distance) with normals pointing inwards, for Vulkan's 0..1 clip space depth.
+    VKE_API std::array<glm::vec4, 6> extract_frustum_planes(const glm::mat4& view_projection);
+
+    /**
+     * GPU-driven drawing: object bounds and draw records live in storage buffers, a compute pass frustum (and optionally Hi-Z) culls them and writes
+     * compacted VkDrawIndexedIndirectCommands and a count per batch, and each batch is then drawn with a single drawIndexedIndirectCount.
+     *
+     * A batch is one graphics pipeline. Every command's firstInstance is the object index, so vertex shaders can fetch per-object data from their
+     * own storage buffers with gl_InstanceIndex. The vertex and index buffers (generally a mesh pool) have to be bound by the caller before `draw`.
+     *
+     * `cull` has to be recorded outside of the rendering scope (see GenericDynamicRenderer::pre_draw) and `draw` inside of it.
+     */
+    class VKE_API GpuDrivenScene {
+      public:
+        struct Settings {
+            uint32_t                      max_objects;
+            uint32_t                      frames_in_flight;
+            uint32_t                      max_batches = 64;
+            std::shared_ptr<ShaderModule> cull_shader;     // res/shaders/cull.comp
+            std::shared_ptr<ShaderModule> hiz_cull_shader; // optional, res/shaders/cull.comp with VKE_CULL_HIZ defined
+        };
+
+        static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+        explicit GpuDrivenScene(const Settings& settings);
+        ~GpuDrivenScene();
+
+        // Reserves room for `capacity` draws with this pipeline (the capacities of all batches share max_objects). Returns the batch index to use in
+        // draw records.
+        uint32_t add_batch(const GraphicsPipeline* pipeline, uint32_t capacity);
+
+        // Returns the object index (which is also the firstInstance the object is drawn with).
+        uint32_t add_object(const glm::vec4& bounding_sphere, const GpuDrawRecord& draw_record);
+        void     update_object(uint32_t object, const glm::vec4& bounding_sphere);
+        void     update_object(uint32_t object, const glm::vec4& bounding_sphere, const GpuDrawRecord& draw_record);
+
+        [[nodiscard]] inline uint32_t object_count() const noexcept { return static_cast<uint32_t>(m_Bounds.size()); }
+
+        void cull(const Renderer::FrameInfo& frame_info, const GpuCullParameters& parameters);
+        void draw(const Renderer::FrameInfo& frame_info) const;
+
+        [[nodiscard]] inline const std::shared_ptr<Buffer>& command_buffer() const noexcept { return m_Commands; }
+        [[nodiscard]] inline const std::shared_ptr<Buffer>& count_buffer() const noexcept { return m_Counts; }
+
+      private:
+        struct Batch {
+            const GraphicsPipeline* pipeline;
+            uint32_t                first_command;
+            uint32_t                capacity;
+            uint32_t                object_count;
+        };
+
+        // Object data is double buffered per frame in flight, and only the range touched since a frame slot was last used is copied.
+        struct FrameResources {
+            std::shared_ptr<Buffer> uniforms;
+            std::shared_ptr<Buffer> bounds;
+            std::shared_ptr<Buffer> draws;
+            uint32_t                dirty_begin = UINT32_MAX;
+            uint32_t                dirty_end   = 0;
+        };
+
+        void mark_dirty(uint32_t object);
+        void upload(FrameResources& frame);
+
+        std::shared_ptr<Device> m_Device;
+        Settings                m_Settings;
+
+        std::vector<glm::vec4>     m_Bounds;
+        std::vector<GpuDrawRecord> m_Draws;
+        std::vector<Batch>         m_Batches;
+        uint32_t                   m_CommandCapacity = 0;
+
+        std::vector<FrameResources> m_Frames;
+        std::shared_ptr<Buffer>     m_BatchOffsets;
+        std::shared_ptr<Buffer>     m_Commands;
+        std::shared_ptr<Buffer>     m_Counts;
+
+        vk::DescriptorSetLayout          m_SetLayout;
+        vk::DescriptorSetLayout          m_HizSetLayout;
+        std::unique_ptr<ComputePipeline> m_CullPipeline;
+        std::unique_ptr<ComputePipeline> m_HizCullPipeline;
+    };
+
+} // namespace vke
@@ -6,265 +6,11 @@
 
 #include "vke/global.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <stdexcept>
 
 namespace vke {
-    static uint32_t sizeof_format(const vk::Format format) {
-        switch (format) {
-        case vk::Format::eUndefined:                            throw std::invalid_argument("Cannot get size of undefined format.");
-        case vk::Format::eR4G4UnormPack8:                       return 1;
-        case vk::Format::eR4G4B4A4UnormPack16:                  return 2;
-        case vk::Format::eB4G4R4A4UnormPack16:                  return 2;
-        case vk::Format::eR5G6B5UnormPack16:                    return 2;
-        case vk::Format::eB5G6R5UnormPack16:                    return 2;
-        case vk::Format::eR5G5B5A1UnormPack16:                  return 2;
-        case vk::Format::eB5G5R5A1UnormPack16:                  return 2;
-        case vk::Format::eA1R5G5B5UnormPack16:                  return 2;
-        case vk::Format::eR8Unorm:                              return 1;
-        case vk::Format::eR8Snorm:                              return 1;
-        case vk::Format::eR8Uscaled:                            return 1;
-        case vk::Format::eR8Sscaled:                            return 1;
-        case vk::Format::eR8Uint:                               return 1;
-        case vk::Format::eR8Sint:                               return 1;
-        case vk::Format::eR8Srgb:                               return 1;
-        case vk::Format::eR8G8Unorm:                            return 2;
-        case vk::Format::eR8G8Snorm:                            return 2;
-        case vk::Format::eR8G8Uscaled:                          return 2;
-        case vk::Format::eR8G8Sscaled:                          return 2;
-        case vk::Format::eR8G8Uint:                             return 2;
-        case vk::Format::eR8G8Sint:                             return 2;
-        case vk::Format::eR8G8Srgb:                             return 2;
-        case vk::Format::eR8G8B8Unorm:                          return 3;
-        case vk::Format::eR8G8B8Snorm:                          return 3;
-        case vk::Format::eR8G8B8Uscaled:                        return 3;
-        case vk::Format::eR8G8B8Sscaled:                        return 3;
-        case vk::Format::eR8G8B8Uint:                           return 3;
-        case vk::Format::eR8G8B8Sint:                           return 3;
-        case vk::Format::eR8G8B8Srgb:                           return 3;
-        case vk::Format::eB8G8R8Unorm:                          return 3;
-        case vk::Format::eB8G8R8Snorm:                          return 3;
-        case vk::Format::eB8G8R8Uscaled:                        return 3;
-        case vk::Format::eB8G8R8Sscaled:                        return 3;
-        case vk::Format::eB8G8R8Uint:                           return 3;
-        case vk::Format::eB8G8R8Sint:                           return 3;
-        case vk::Format::eB8G8R8Srgb:                           return 3;
-        case vk::Format::eR8G8B8A8Unorm:                        return 4;
-        case vk::Format::eR8G8B8A8Snorm:                        return 4;
-        case vk::Format::eR8G8B8A8Uscaled:                      return 4;
-        case vk::Format::eR8G8B8A8Sscaled:                      return 4;
-        case vk::Format::eR8G8B8A8Uint:                         return 4;
-        case vk::Format::eR8G8B8A8Sint:                         return 4;
-        case vk::Format::eR8G8B8A8Srgb:                         return 4;
-        case vk::Format::eB8G8R8A8Unorm:                        return 4;
-        case vk::Format::eB8G8R8A8Snorm:                        return 4;
-        case vk::Format::eB8G8R8A8Uscaled:                      return 4;
-        case vk::Format::eB8G8R8A8Sscaled:                      return 4;
-        case vk::Format::eB8G8R8A8Uint:                         return 4;
-        case vk::Format::eB8G8R8A8Sint:                         return 4;
-        case vk::Format::eB8G8R8A8Srgb:                         return 4;
-        case vk::Format::eA8B8G8R8UnormPack32:                  return 4;
-        case vk::Format::eA8B8G8R8SnormPack32:                  return 4;
-        case vk::Format::eA8B8G8R8UscaledPack32:                return 4;
-        case vk::Format::eA8B8G8R8SscaledPack32:                return 4;
-        case vk::Format::eA8B8G8R8UintPack32:                   return 4;
-        case vk::Format::eA8B8G8R8SintPack32:                   return 4;
-        case vk::Format::eA8B8G8R8SrgbPack32:                   return 4;
-        case vk::Format::eA2R10G10B10UnormPack32:               return 4;
-        case vk::Format::eA2R10G10B10SnormPack32:               return 4;
-        case vk::Format::eA2R10G10B10UscaledPack32:             return 4;
-        case vk::Format::eA2R10G10B10SscaledPack32:             return 4;
-        case vk::Format::eA2R10G10B10UintPack32:                return 4;
-        case vk::Format::eA2R10G10B10SintPack32:                return 4;
-        case vk::Format::eA2B10G10R10UnormPack32:               return 4;
-        case vk::Format::eA2B10G10R10SnormPack32:               return 4;
-        case vk::Format::eA2B10G10R10UscaledPack32:             return 4;
-        case vk::Format::eA2B10G10R10SscaledPack32:             return 4;
-        case vk::Format::eA2B10G10R10UintPack32:                return 4;
-        case vk::Format::eA2B10G10R10SintPack32:                return 4;
-        case vk::Format::eR16Unorm:                             return 2;
-        case vk::Format::eR16Snorm:                             return 2;
-        case vk::Format::eR16Uscaled:                           return 2;
-        case vk::Format::eR16Sscaled:                           return 2;
-        case vk::Format::eR16Uint:                              return 2;
-        case vk::Format::eR16Sint:                              return 2;
-        case vk::Format::eR16Sfloat:                            return 2;
-        case vk::Format::eR16G16Unorm:                          return 4;
-        case vk::Format::eR16G16Snorm:                          return 4;
-        case vk::Format::eR16G16Uscaled:                        return 4;
-        case vk::Format::eR16G16Sscaled:                        return 4;
-        case vk::Format::eR16G16Uint:                           return 4;
-        case vk::Format::eR16G16Sint:                           return 4;
-        case vk::Format::eR16G16Sfloat:                         return 4;
-        case vk::Format::eR16G16B16Unorm:                       return 6;
-        case vk::Format::eR16G16B16Snorm:                       return 6;
-        case vk::Format::eR16G16B16Uscaled:                     return 6;
-        case vk::Format::eR16G16B16Sscaled:                     return 6;
-        case vk::Format::eR16G16B16Uint:                        return 6;
-        case vk::Format::eR16G16B16Sint:                        return 6;
-        case vk::Format::eR16G16B16Sfloat:                      return 6;
-        case vk::Format::eR16G16B16A16Unorm:                    return 8;
-        case vk::Format::eR16G16B16A16Snorm:                    return 8;
-        case vk::Format::eR16G16B16A16Uscaled:                  return 8;
-        case vk::Format::eR16G16B16A16Sscaled:                  return 8;
-        case vk::Format::eR16G16B16A16Uint:                     return 8;
-        case vk::Format::eR16G16B16A16Sint:                     return 8;
-        case vk::Format::eR16G16B16A16Sfloat:                   return 8;
-        case vk::Format::eR32Uint:                              return 4;
-        case vk::Format::eR32Sint:                              return 4;
-        case vk::Format::eR32Sfloat:                            return 4;
-        case vk::Format::eR32G32Uint:                           return 8;
-        case vk::Format::eR32G32Sint:                           return 8;
-        case vk::Format::eR32G32Sfloat:                         return 8;
-        case vk::Format::eR32G32B32Uint:                        return 12;
-        case vk::Format::eR32G32B32Sint:                        return 12;
-        case vk::Format::eR32G32B32Sfloat:                      return 12;
-        case vk::Format::eR32G32B32A32Uint:                     return 16;
-        case vk::Format::eR32G32B32A32Sint:                     return 16;
-        case vk::Format::eR32G32B32A32Sfloat:                   return 16;
-        case vk::Format::eR64Uint:                              return 8;
-        case vk::Format::eR64Sint:                              return 8;
-        case vk::Format::eR64Sfloat:                            return 8;
-        case vk::Format::eR64G64Uint:                           return 16;
-        case vk::Format::eR64G64Sint:                           return 16;
-        case vk::Format::eR64G64Sfloat:                         return 16;
-        case vk::Format::eR64G64B64Uint:                        return 24;
-        case vk::Format::eR64G64B64Sint:                        return 24;
-        case vk::Format::eR64G64B64Sfloat:                      return 24;
-        case vk::Format::eR64G64B64A64Uint:                     return 32;
-        case vk::Format::eR64G64B64A64Sint:                     return 32;
-        case vk::Format::eR64G64B64A64Sfloat:                   return 32;
-        case vk::Format::eB10G11R11UfloatPack32:                return 4;
-        case vk::Format::eE5B9G9R9UfloatPack32:                 return 4;
-        case vk::Format::eD16Unorm:                             return 2;
-        case vk::Format::eX8D24UnormPack32:                     return 4;
-        case vk::Format::eD32Sfloat:                            return 4;
-        case vk::Format::eS8Uint:                               return 1;
-        case vk::Format::eD16UnormS8Uint:                       return 3;
-        case vk::Format::eD24UnormS8Uint:                       return 4;
-        case vk::Format::eD32SfloatS8Uint:                      return 8;
-        case vk::Format::eBc1RgbUnormBlock:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc1RgbSrgbBlock:                      throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc1RgbaUnormBlock:                    throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc1RgbaSrgbBlock:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc2UnormBlock:                        throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc2SrgbBlock:                         throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc3UnormBlock:                        throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc3SrgbBlock:                         throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc4UnormBlock:                        throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc4SnormBlock:                        throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc5UnormBlock:                        throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc5SnormBlock:                        throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc6HUfloatBlock:                      throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc6HSfloatBlock:                      throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc7UnormBlock:                        throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eBc7SrgbBlock:                         throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eEtc2R8G8B8UnormBlock:                 throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eEtc2R8G8B8SrgbBlock:                  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eEtc2R8G8B8A1UnormBlock:               throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eEtc2R8G8B8A1SrgbBlock:                throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eEtc2R8G8B8A8UnormBlock:               throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eEtc2R8G8B8A8SrgbBlock:                throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eEacR11UnormBlock:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eEacR11SnormBlock:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eEacR11G11UnormBlock:                  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eEacR11G11SnormBlock:                  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc4x4UnormBlock:                    throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc4x4SrgbBlock:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc5x4UnormBlock:                    throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc5x4SrgbBlock:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc5x5UnormBlock:                    throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc5x5SrgbBlock:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc6x5UnormBlock:                    throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc6x5SrgbBlock:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc6x6UnormBlock:                    throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc6x6SrgbBlock:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc8x5UnormBlock:                    throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc8x5SrgbBlock:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc8x6UnormBlock:                    throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc8x6SrgbBlock:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc8x8UnormBlock:                    throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc8x8SrgbBlock:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc10x5UnormBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc10x5SrgbBlock:                    throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc10x6UnormBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc10x6SrgbBlock:                    throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc10x8UnormBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc10x8SrgbBlock:                    throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc10x10UnormBlock:                  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc10x10SrgbBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc12x10UnormBlock:                  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc12x10SrgbBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc12x12UnormBlock:                  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc12x12SrgbBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eG8B8G8R8422Unorm:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eB8G8R8G8422Unorm:                     throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eG8B8R83Plane420Unorm:                 throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG8B8R82Plane420Unorm:                 throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG8B8R83Plane422Unorm:                 throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG8B8R82Plane422Unorm:                 throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG8B8R83Plane444Unorm:                 throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eR10X6UnormPack16:                     return 2;
-        case vk::Format::eR10X6G10X6Unorm2Pack16:               return 4;
-        case vk::Format::eR10X6G10X6B10X6A10X6Unorm4Pack16:     return 8;
-        case vk::Format::eG10X6B10X6G10X6R10X6422Unorm4Pack16:  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eB10X6G10X6R10X6G10X6422Unorm4Pack16:  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eG10X6B10X6R10X63Plane420Unorm3Pack16: throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG10X6B10X6R10X62Plane420Unorm3Pack16: throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG10X6B10X6R10X63Plane422Unorm3Pack16: throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG10X6B10X6R10X62Plane422Unorm3Pack16: throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG10X6B10X6R10X63Plane444Unorm3Pack16: throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eR12X4UnormPack16:                     return 2;
-        case vk::Format::eR12X4G12X4Unorm2Pack16:               return 4;
-        case vk::Format::eR12X4G12X4B12X4A12X4Unorm4Pack16:     return 8;
-        case vk::Format::eG12X4B12X4G12X4R12X4422Unorm4Pack16:  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eB12X4G12X4R12X4G12X4422Unorm4Pack16:  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eG12X4B12X4R12X43Plane420Unorm3Pack16: throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG12X4B12X4R12X42Plane420Unorm3Pack16: throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG12X4B12X4R12X43Plane422Unorm3Pack16: throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG12X4B12X4R12X42Plane422Unorm3Pack16: throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG12X4B12X4R12X43Plane444Unorm3Pack16: throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG16B16G16R16422Unorm:                 throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eB16G16R16G16422Unorm:                 throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eG16B16R163Plane420Unorm:              throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG16B16R162Plane420Unorm:              throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG16B16R163Plane422Unorm:              throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG16B16R162Plane422Unorm:              throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG16B16R163Plane444Unorm:              throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG8B8R82Plane444Unorm:                 throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG10X6B10X6R10X62Plane444Unorm3Pack16: throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG12X4B12X4R12X42Plane444Unorm3Pack16: throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eG16B16R162Plane444Unorm:              throw std::invalid_argument("Multi-planar formats don't have per-pixel sizes.");
-        case vk::Format::eA4R4G4B4UnormPack16:                  return 2;
-        case vk::Format::eA4B4G4R4UnormPack16:                  return 2;
-        case vk::Format::eAstc4x4SfloatBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc5x4SfloatBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc5x5SfloatBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc6x5SfloatBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc6x6SfloatBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc8x5SfloatBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc8x6SfloatBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc8x8SfloatBlock:                   throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc10x5SfloatBlock:                  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc10x6SfloatBlock:                  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc10x8SfloatBlock:                  throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc10x10SfloatBlock:                 throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc12x10SfloatBlock:                 throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eAstc12x12SfloatBlock:                 throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eA1B5G5R5UnormPack16:                  return 2;
-        case vk::Format::eA8Unorm:                              return 1;
-        case vk::Format::ePvrtc12BppUnormBlockIMG:              throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::ePvrtc14BppUnormBlockIMG:              throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::ePvrtc22BppUnormBlockIMG:              throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::ePvrtc24BppUnormBlockIMG:              throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::ePvrtc12BppSrgbBlockIMG:               throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::ePvrtc14BppSrgbBlockIMG:               throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::ePvrtc22BppSrgbBlockIMG:               throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::ePvrtc24BppSrgbBlockIMG:               throw std::invalid_argument("Compressed formats don't have per-pixel sizes.");
-        case vk::Format::eR16G16Sfixed5NV:                      return 4;
-        default:                                                throw std::invalid_argument("Invalid format");
-        }
-    }
-
     static std::size_t sample_mask_req(vk::SampleCountFlagBits count) {
         switch (count) {
         case vk::SampleCountFlagBits::e1:  return 1;
@@ -282,33 +28,95 @@ namespace vke {
         return VertexBindingBuilder(binding, input_rate);
     }
 
+    static constexpr uint32_t align_up(const uint32_t value, const uint32_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
     VertexBindingBuilder::VertexBindingBuilder(const uint32_t binding, const vk::VertexInputRate input_rate)
-        : binding(binding), stride(0), input_rate(input_rate) {}
+        : binding(binding), stride(0), alignment(1), input_rate(input_rate) {}
 
     VertexBindingBuilder& VertexBindingBuilder::attribute(uint32_t location, const vk::Format format) & {
-        const uint32_t sz  = sizeof_format(format);
-        const uint32_t off = stride;
-        stride += sz;
+        const uint32_t sz  = format_size(format);
+        const uint32_t al  = vertex_attribute_alignment(format);
+        const uint32_t off = align_up(stride, al);
+        stride             = off + sz;
+        alignment          = std::max(alignment, al);
         attributes.emplace_back(location, format, off);
         return *this;
     }
 
     VertexBindingBuilder VertexBindingBuilder::attribute(uint32_t location, const vk::Format format) && {
-        const uint32_t sz  = sizeof_format(format);
-        const uint32_t off = stride;
-        stride += sz;
-        attributes.emplace_back(location, format, off);
+        return std::move(attribute(location, format));
+    }
+
+    VertexBindingBuilder& VertexBindingBuilder::align(const uint32_t alignment) & {
+        stride = align_up(stride, alignment);
+        return *this;
+    }
+
+    VertexBindingBuilder VertexBindingBuilder::align(const uint32_t alignment) && {
+        return std::move(align(alignment));
+    }
+
+    VertexBindingBuilder& VertexBindingBuilder::stride_alignment(const uint32_t alignment) & {
+        this->alignment = std::max(this->alignment, alignment);
         return *this;
     }
 
+    VertexBindingBuilder VertexBindingBuilder::stride_alignment(const uint32_t alignment) && {
+        return std::move(stride_alignment(alignment));
+    }
+
     VertexBinding VertexBindingBuilder::build() const {
-        return VertexBinding{.binding = binding, .stride = stride, .input_rate = input_rate, .attributes = attributes};
+        return VertexBinding{.binding = binding, .stride = align_up(stride, alignment), .input_rate = input_rate, .attributes = attributes};
     }
 
     VertexLayoutBuilder VertexLayout::builder() {
         return VertexLayoutBuilder();
     }
 
+    VertexLayout VertexLayout::from_attributes(
+      const std::span<const VertexAttributeDescription> attributes, const VertexStreams streams, const uint32_t stride_alignment
+    ) {
+        VertexLayout layout{};
+        if (attributes.empty()) { return layout; }
+
+        switch (streams) {
+        case VertexStreams::Interleaved: {
+            auto builder = VertexBinding::builder(0).stride_alignment(stride_alignment);
+            for (const auto& [location, format] : attributes) {
+                builder.attribute(location, format);
+            }
+            layout.bindings.push_back(builder.build());
+            break;
+        }
+        case VertexStreams::SplitPosition: {
+            layout.bindings.push_back(VertexBinding::builder(0).attribute(attributes[0].location, attributes[0].format).build());
+            if (attributes.size() > 1) {
+                auto builder = VertexBinding::builder(1).stride_alignment(stride_alignment);
+                for (const auto& [location, format] : attributes.subspan(1)) {
+                    builder.attribute(location, format);
+                }
+                layout.bindings.push_back(builder.build());
+            }
+            break;
+        }
+        case VertexStreams::SplitAll: {
+            for (uint32_t i = 0; i < attributes.size(); i++) {
+                layout.bindings.push_back(VertexBinding::builder(i).attribute(attributes[i].location, attributes[i].format).build());
+            }
+            break;
+        }
+        }
+
+        return layout;
+    }
+
+    VertexLayout VertexLayout::position_only() const {
+        if (bindings.empty()) { return {}; }
+        return VertexLayout{.bindings = {bindings[0]}};
+    }
+
     VertexLayoutBuilder::VertexLayoutBuilder() {}
 
     VertexLayoutBuilder& VertexLayoutBuilder::binding(const VertexBinding& binding) & {
@@ -321,13 +129,38 @@ namespace vke {
         return *this;
     }
 
-    GraphicsPipeline::GraphicsPipeline(const Settings& settings) : m_Device(global::g_Device) {
+    VertexLayout VertexLayoutBuilder::build() const {
+        return VertexLayout{.bindings = bindings};
+    }
+
+    static std::atomic<uint32_t> s_NextPipelineSortId = 0;
+
+    GraphicsPipeline::GraphicsPipeline(const Settings& settings)
+        : m_Device(global::g_Device), m_Settings(settings), m_Pipeline(create_pipeline(settings)),
+          m_SortId(s_NextPipelineSortId.fetch_add(1, std::memory_order_relaxed)) {
+        // A module used by several stages only needs to know about the pipeline once.
+        std::vector<ShaderModule*> modules;
+        for (const auto& stage : m_Settings.shader_stages) {
+            if (std::ranges::find(modules, stage.shader_module.get()) != modules.end()) { continue; }
+
+            modules.push_back(stage.shader_module.get());
+            stage.shader_module->add_user(this);
+        }
+    }
+
+    GraphicsPipeline::~GraphicsPipeline() {
+        for (const auto& stage : m_Settings.shader_stages) { stage.shader_module->remove_user(this); }
+        m_Device->defer_destroy(m_Pipeline);
+    }
+
+    vk::Pipeline GraphicsPipeline::create_pipeline(const Settings& settings, const std::span<const ShaderOverride> overrides) {
         vk::GraphicsPipelineCreateInfo create_info{};
 
         std::vector<vk::PipelineShaderStageCreateInfo> shader_stages;
         for (const auto& [shader_module, stage, entry_point] : settings.shader_stages) {
-            shader_stages.emplace_back(vk::PipelineShaderStageCreateFlags(), stage, shader_module->handle(), entry_point.c_str());
-            m_ShaderModules.emplace_back(shader_module);
+            const auto replaced = std::ranges::find(overrides, shader_module.get(), &ShaderOverride::shader_module);
+            const auto handle   = replaced != overrides.end() ? replaced->handle : shader_module->handle();
+            shader_stages.emplace_back(vk::PipelineShaderStageCreateFlags(), stage, handle, entry_point.c_str());
         }
 
         vk::PipelineVertexInputStateCreateInfo           vertex_input_state{};
@@ -451,6 +284,6 @@ namespace vke {
         // create_info.setRenderPass(settings.render_pass->handle());
         // create_info.setSubpass(settings->subpass);
 
-        m_Pipeline = m_Device->handle().createGraphicsPipeline(/* TODO: pipeline cache */ nullptr, create_info).value;
+        return global::g_Device->handle().createGraphicsPipeline(/* TODO: pipeline cache */ nullptr, create_info).value;
     }
 } // namespace vke
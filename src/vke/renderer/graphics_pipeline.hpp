@@ -7,10 +7,14 @@
 #include "vke/pre.hpp"
 
 #include "vke/dependency.hpp"
+#include "vke/renderer/format.hpp"
 #include "vke/renderer/pipeline_layout.hpp"
 #include "vke/renderer/shader_module.hpp"
 #include "vke/vke.hpp"
 
+#include <array>
+#include <span>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
@@ -61,6 +65,10 @@ namespace vke {
         static VKE_API VertexBindingBuilder builder(uint32_t binding, vk::VertexInputRate input_rate = vk::VertexInputRate::eVertex);
     };
 
+    /**
+     * Attributes are placed at the next offset aligned to their natural alignment (the largest power of two dividing the attribute's size, up to 4
+     * bytes), and the stride is padded to the largest alignment used, so packed formats like R16G16B16 or A2B10G10R10 don't end up misaligned.
+     */
     class VKE_API VertexBindingBuilder {
       public:
         explicit VertexBindingBuilder(uint32_t binding, vk::VertexInputRate input_rate = vk::VertexInputRate::eVertex);
@@ -68,21 +76,96 @@ namespace vke {
         VertexBindingBuilder& attribute(uint32_t location, vk::Format format) &;
         VertexBindingBuilder  attribute(uint32_t location, vk::Format format) &&;
 
+        // Pads the offset of the next attribute to a multiple of `alignment`.
+        VertexBindingBuilder& align(uint32_t alignment) &;
+        VertexBindingBuilder  align(uint32_t alignment) &&;
+
+        // Pads the final stride to a multiple of `alignment` (for example 16 or 32, so that vertices don't straddle cache lines).
+        VertexBindingBuilder& stride_alignment(uint32_t alignment) &;
+        VertexBindingBuilder  stride_alignment(uint32_t alignment) &&;
+
         VertexBinding build() const;
 
       private:
         uint32_t                     binding;
         uint32_t                     stride;
+        uint32_t                     alignment;
         vk::VertexInputRate          input_rate;
         std::vector<VertexAttribute> attributes;
     };
 
     class VKE_API VertexLayoutBuilder;
 
+    struct VertexAttributeDescription {
+        uint32_t   location;
+        vk::Format format;
+    };
+
+    // Largest power of two dividing the attribute size, capped at 4 bytes (what vertex fetch hardware generally wants).
+    [[nodiscard]] constexpr uint32_t vertex_attribute_alignment(const vk::Format format) {
+        const uint32_t size = format_size(format);
+        return std::min(size & (~size + 1), 4u);
+    }
+
+    /**
+     * A VertexBinding with a fixed number of attributes, so it can be laid out entirely at compile time:
+     *
+     *     constexpr auto MESH_BINDING = make_vertex_binding(0, std::array{
+     *       VertexAttributeDescription{0, vk::Format::eR32G32B32Sfloat},
+     *       VertexAttributeDescription{1, vk::Format::eA2B10G10R10SnormPack32},
+     *     });
+     */
+    template <std::size_t N>
+    struct StaticVertexBinding {
+        uint32_t                       binding;
+        uint32_t                       stride;
+        vk::VertexInputRate            input_rate;
+        std::array<VertexAttribute, N> attributes;
+
+        operator VertexBinding() const { return VertexBinding{binding, stride, input_rate, {attributes.begin(), attributes.end()}}; }
+    };
+
+    // Uses the same placement rules as VertexBindingBuilder.
+    template <std::size_t N>
+    [[nodiscard]] constexpr StaticVertexBinding<N> make_vertex_binding(
+      const uint32_t                                   binding,
+      const std::array<VertexAttributeDescription, N>& attributes,
+      const vk::VertexInputRate                        input_rate       = vk::VertexInputRate::eVertex,
+      const uint32_t                                   stride_alignment = 1
+    ) {
+        StaticVertexBinding<N> result{binding, 0, input_rate, {}};
+
+        uint32_t alignment = stride_alignment;
+        for (std::size_t i = 0; i < N; i++) {
+            const uint32_t attribute_alignment = vertex_attribute_alignment(attributes[i].format);
+            const uint32_t offset              = (result.stride + attribute_alignment - 1) / attribute_alignment * attribute_alignment;
+
+            result.attributes[i] = VertexAttribute{attributes[i].location, attributes[i].format, offset};
+            result.stride        = offset + format_size(attributes[i].format);
+            alignment            = std::max(alignment, attribute_alignment);
+        }
+        result.stride = (result.stride + alignment - 1) / alignment * alignment;
+
+        return result;
+    }
+
+    enum class VertexStreams {
+        Interleaved,   // every attribute in binding 0
+        SplitPosition, // the first attribute (position) alone in binding 0, the rest interleaved in binding 1
+        SplitAll,      // one binding per attribute
+    };
+
     struct VertexLayout {
         std::vector<VertexBinding> bindings;
 
         static VKE_API VertexLayoutBuilder builder();
+
+        // Builds per-vertex bindings (numbered from 0) for a list of attributes.
+        static VKE_API VertexLayout
+          from_attributes(std::span<const VertexAttributeDescription> attributes, VertexStreams streams = VertexStreams::Interleaved, uint32_t stride_alignment = 1);
+
+        // Only the first binding. For a SplitPosition layout this is the layout depth-only passes should use, so they only fetch positions.
+        [[nodiscard]] VKE_API VertexLayout position_only() const;
     };
 
     class VKE_API VertexLayoutBuilder {
@@ -92,6 +175,8 @@ namespace vke {
         VertexLayoutBuilder& binding(const VertexBinding& binding) &;
         VertexLayoutBuilder  binding(const VertexBinding& binding) &&;
 
+        VertexLayout build() const;
+
       private:
         std::vector<VertexBinding> bindings;
     };
@@ -168,13 +253,34 @@ namespace vke {
         };
 
         explicit GraphicsPipeline(const Settings& settings);
+        ~GraphicsPipeline() override;
+
+        GraphicsPipeline(const GraphicsPipeline&)            = delete;
+        GraphicsPipeline& operator=(const GraphicsPipeline&) = delete;
 
-        [[nodiscard]] inline vk::Pipeline handle() const noexcept { return m_Pipeline; }
+        // The handle can change at a frame boundary when a shader is hot reloaded (see res::HotReloader), so don't hold on to it across frames.
+        [[nodiscard]] inline vk::Pipeline                           handle() const noexcept { return m_Pipeline; }
+        [[nodiscard]] inline const std::shared_ptr<PipelineLayout>& layout() const noexcept { return m_Settings.layout; }
+        [[nodiscard]] inline const Settings&                        settings() const noexcept { return m_Settings; }
+
+        // Small process-unique id, used by things like the render queue to order draws by pipeline without hashing.
+        [[nodiscard]] inline uint32_t sort_id() const noexcept { return m_SortId; }
 
       private:
-        std::shared_ptr<Device>                    m_Device;
-        vk::Pipeline                               m_Pipeline;
-        std::vector<std::shared_ptr<ShaderModule>> m_ShaderModules;
+        // Builds with `handle` in place of `shader_module`'s current handle, for rebuilding with a reloaded shader before it is swapped in.
+        struct ShaderOverride {
+            const ShaderModule* shader_module;
+            vk::ShaderModule    handle;
+        };
+
+        static vk::Pipeline create_pipeline(const Settings& settings, std::span<const ShaderOverride> overrides = {});
+
+        friend class res::HotReloader;
+
+        std::shared_ptr<Device> m_Device;
+        Settings                m_Settings;
+        vk::Pipeline            m_Pipeline;
+        uint32_t                m_SortId;
     };
 
 } // namespace vke
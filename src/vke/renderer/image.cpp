@@ -0,0 +1,49 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#include "image.hpp"
+
+#include "vke/global.hpp"
+#include "vke/renderer/format.hpp"
+
+namespace vke {
+    Image::Image(const Settings& settings) : m_Device(global::g_Device), m_Settings(settings) {
+        vk::ImageCreateInfo create_info{};
+        create_info.imageType     = vk::ImageType::e2D;
+        create_info.format        = settings.format;
+        create_info.extent        = vk::Extent3D{settings.extent, 1};
+        create_info.mipLevels     = settings.mip_levels;
+        create_info.arrayLayers   = 1;
+        create_info.samples       = vk::SampleCountFlagBits::e1;
+        create_info.tiling        = vk::ImageTiling::eOptimal;
+        create_info.usage         = settings.usage;
+        create_info.sharingMode   = vk::SharingMode::eExclusive;
+        create_info.initialLayout = vk::ImageLayout::eUndefined;
+        m_Image                   = m_Device->handle().createImage(create_info);
+
+        const auto requirements = m_Device->handle().getImageMemoryRequirements(m_Image);
+        m_Memory                = m_Device->allocate_memory(requirements, settings.memory_properties);
+        m_MemorySize            = requirements.size;
+        m_Device->handle().bindImageMemory(m_Image, m_Memory, 0);
+
+        vk::ImageViewCreateInfo view_info{};
+        view_info.image            = m_Image;
+        view_info.viewType         = vk::ImageViewType::e2D;
+        view_info.format           = settings.format;
+        view_info.subresourceRange = vk::ImageSubresourceRange{format_info(settings.format).aspect, 0, settings.mip_levels, 0, 1};
+        m_View                     = m_Device->handle().createImageView(view_info);
+    }
+
+    std::shared_ptr<Image> Image::create(const Settings& settings) {
+        return std::shared_ptr<Image>(new Image(settings));
+    }
+
+    Image::~Image() {
+        m_Device->defer([device = m_Device->handle(), view = m_View, image = m_Image, memory = m_Memory] {
+            device.destroy(view);
+            device.destroy(image);
+            device.freeMemory(memory);
+        });
+    }
+} // namespace vke
@@ -0,0 +1,53 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/vke.hpp"
+
+namespace vke {
+
+    /**
+     * A 2D image with its own memory and a view of every mip level.
+     */
+    class VKE_API Image {
+      public:
+        struct Settings {
+            vk::Format              format;
+            vk::Extent2D            extent;
+            uint32_t                mip_levels = 1;
+            vk::ImageUsageFlags     usage;
+            vk::MemoryPropertyFlags memory_properties = vk::MemoryPropertyFlagBits::eDeviceLocal;
+        };
+
+      private:
+        explicit Image(const Settings& settings);
+
+      public:
+        static std::shared_ptr<Image> create(const Settings& settings);
+
+        ~Image();
+
+        Image(const Image&)            = delete;
+        Image& operator=(const Image&) = delete;
+
+        [[nodiscard]] inline vk::Image       handle() const noexcept { return m_Image; }
+        [[nodiscard]] inline vk::ImageView   view() const noexcept { return m_View; }
+        [[nodiscard]] inline const Settings& settings() const noexcept { return m_Settings; }
+
+        // What the image's memory actually takes up, which can be more than its texels.
+        [[nodiscard]] inline vk::DeviceSize memory_size() const noexcept { return m_MemorySize; }
+
+      private:
+        std::shared_ptr<Device> m_Device;
+        Settings                m_Settings;
+        vk::Image               m_Image;
+        vk::DeviceMemory        m_Memory;
+        vk::DeviceSize          m_MemorySize;
+        vk::ImageView           m_View;
+    };
+
+} // namespace vke
@@ -0,0 +1,196 @@
+//
+// Created by andy on 3/26/2025.
+//
+
+#include "mesh_pool.hpp"
+
+#include "vke/global.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace vke {
+    static uint32_t sizeof_index(const vk::IndexType index_type) {
+        switch (index_type) {
+        case vk::IndexType::eUint8:  return 1;
+        case vk::IndexType::eUint16: return 2;
+        case vk::IndexType::eUint32: return 4;
+        default:                     throw std::invalid_argument("Unsupported index type");
+        }
+    }
+
+    MeshPool::MeshPool(const Settings& settings)
+        : m_Device(global::g_Device), m_Settings(settings), m_IndexSize(sizeof_index(settings.index_type)), m_VertexAllocator(settings.max_vertices),
+          m_IndexAllocator(settings.max_indices) {
+        constexpr auto usage = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer;
+
+        m_VertexBuffers.reserve(m_Settings.vertex_layout.bindings.size());
+        for (const auto& binding : m_Settings.vertex_layout.bindings) {
+            VKE_ASSERT(binding.input_rate == vk::VertexInputRate::eVertex, "Mesh pools only hold per-vertex streams");
+            m_VertexBuffers.push_back(Buffer::create({
+              static_cast<vk::DeviceSize>(binding.stride) * m_Settings.max_vertices,
+              vk::BufferUsageFlagBits::eVertexBuffer | usage,
+            }));
+        }
+
+        if (m_Settings.max_indices > 0) {
+            m_IndexBuffer = Buffer::create({
+              static_cast<vk::DeviceSize>(m_IndexSize) * m_Settings.max_indices,
+              vk::BufferUsageFlagBits::eIndexBuffer | usage,
+            });
+        }
+
+        m_CommandPool   = m_Device->handle().createCommandPool({vk::CommandPoolCreateFlagBits::eResetCommandBuffer, m_Device->queues().main.family});
+        m_CommandBuffer = m_Device->handle().allocateCommandBuffers({m_CommandPool, vk::CommandBufferLevel::ePrimary, 1})[0];
+        m_UploadFence   = m_Device->create_fence();
+    }
+
+    MeshPool::~MeshPool() {
+        m_Device->destroy(m_UploadFence);
+        m_Device->destroy(m_CommandPool);
+    }
+
+    Mesh MeshPool::upload(const std::span<const std::span<const std::byte>> vertex_streams, const uint32_t vertex_count, const std::span<const std::byte> indices) {
+        VKE_ASSERT(vertex_streams.size() == m_VertexBuffers.size(), "Mesh needs one vertex stream per binding of the pool's layout");
+        VKE_ASSERT(indices.size() % m_IndexSize == 0, "Index data isn't a whole number of indices");
+
+        if (vertex_count == 0) { throw std::invalid_argument("Mesh has no vertices"); }
+        const auto index_count = static_cast<uint32_t>(indices.size() / m_IndexSize);
+
+        const auto first_vertex = m_VertexAllocator.allocate(vertex_count);
+        if (!first_vertex) { throw std::length_error("Mesh pool is out of vertex space"); }
+
+        // A mesh without indices is drawn non-indexed, it takes no index space.
+        const auto first_index = index_count > 0 ? m_IndexAllocator.allocate(index_count) : std::optional<uint64_t>(0);
+        if (!first_index) {
+            m_VertexAllocator.free(*first_vertex, vertex_count);
+            throw std::length_error("Mesh pool is out of index space");
+        }
+
+        for (std::size_t stream = 0; stream < vertex_streams.size(); stream++) {
+            const uint32_t stride = m_Settings.vertex_layout.bindings[stream].stride;
+            VKE_ASSERT(vertex_streams[stream].size() == static_cast<std::size_t>(stride) * vertex_count, "Vertex stream has the wrong size");
+            stage(vertex_streams[stream], m_VertexBuffers[stream]->handle(), *first_vertex * stride);
+        }
+        if (index_count > 0) { stage(indices, m_IndexBuffer->handle(), *first_index * m_IndexSize); }
+
+        return Mesh{
+          .first_vertex = static_cast<uint32_t>(*first_vertex),
+          .vertex_count = vertex_count,
+          .first_index  = static_cast<uint32_t>(*first_index),
+          .index_count  = index_count,
+        };
+    }
+
+    void MeshPool::free(const Mesh& mesh) {
+        m_VertexAllocator.free(mesh.first_vertex, mesh.vertex_count);
+        m_IndexAllocator.free(mesh.first_index, mesh.index_count);
+    }
+
+    void MeshPool::stage(const std::span<const std::byte> data, const vk::Buffer destination, const vk::DeviceSize destination_offset) {
+        if (data.empty()) { return; }
+
+        const vk::DeviceSize source_offset = m_StagingData.size();
+        m_StagingData.insert(m_StagingData.end(), data.begin(), data.end());
+        m_PendingCopies.push_back({destination, vk::BufferCopy{source_offset, destination_offset, data.size()}});
+    }
+
+    void MeshPool::flush_uploads() {
+        if (m_PendingCopies.empty()) { return; }
+
+        if (!m_StagingBuffer || m_StagingBuffer->size() < m_StagingData.size()) {
+            m_StagingBuffer = Buffer::create({
+              m_StagingData.size(),
+              vk::BufferUsageFlagBits::eTransferSrc,
+              vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+            });
+        }
+        m_StagingBuffer->write(m_StagingData.data(), m_StagingData.size());
+
+        // Group the regions by destination so each buffer gets one copy command.
+        std::ranges::stable_sort(m_PendingCopies, {}, [](const PendingCopy& copy) { return static_cast<VkBuffer>(copy.destination); });
+
+        m_CommandBuffer.reset();
+        m_CommandBuffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+        std::vector<vk::BufferCopy> regions;
+        for (std::size_t i = 0; i < m_PendingCopies.size();) {
+            const vk::Buffer destination = m_PendingCopies[i].destination;
+
+            regions.clear();
+            for (; i < m_PendingCopies.size() && m_PendingCopies[i].destination == destination; i++) {
+                regions.push_back(m_PendingCopies[i].region);
+            }
+            m_CommandBuffer.copyBuffer(m_StagingBuffer->handle(), destination, regions);
+        }
+
+        // Make the copies visible to every way the pool can be read.
+        const vk::MemoryBarrier2 barrier{
+          vk::PipelineStageFlagBits2::eCopy,
+          vk::AccessFlagBits2::eTransferWrite,
+          vk::PipelineStageFlagBits2::eVertexAttributeInput | vk::PipelineStageFlagBits2::eIndexInput | vk::PipelineStageFlagBits2::eAllShaders,
+          vk::AccessFlagBits2::eVertexAttributeRead | vk::AccessFlagBits2::eIndexRead | vk::AccessFlagBits2::eShaderStorageRead,
+        };
+        vk::DependencyInfo di{};
+        di.setMemoryBarriers(barrier);
+        m_CommandBuffer.pipelineBarrier2(di);
+
+        m_CommandBuffer.end();
+
+        vk::CommandBufferSubmitInfo command_buffer_submit_info{};
+        command_buffer_submit_info.setCommandBuffer(m_CommandBuffer);
+
+        vk::SubmitInfo2 submit_info{};
+        submit_info.setCommandBufferInfos(command_buffer_submit_info);
+        m_Device->queues().main.queue.submit2(submit_info, m_UploadFence);
+
+        m_Device->wait_for_fence(m_UploadFence);
+        m_Device->reset_fence(m_UploadFence);
+
+        m_StagingData.clear();
+        m_PendingCopies.clear();
+    }
+
+    void MeshPool::bind(const vk::CommandBuffer command_buffer) const {
+        VKE_ASSERT(m_PendingCopies.empty(), "Mesh pool has uploads which haven't been flushed");
+
+        for (std::size_t stream = 0; stream < m_VertexBuffers.size(); stream++) {
+            command_buffer.bindVertexBuffers(m_Settings.vertex_layout.bindings[stream].binding, m_VertexBuffers[stream]->handle(), vk::DeviceSize{0});
+        }
+        if (m_IndexBuffer) { command_buffer.bindIndexBuffer(m_IndexBuffer->handle(), 0, m_Settings.index_type); }
+    }
+
+    MeshBinding MeshPool::binding(const Mesh& mesh) const {
+        if (mesh.index_count == 0) {
+            return MeshBinding{
+              .vertex_buffer = nullptr,
+              .index_buffer  = nullptr,
+              .count         = mesh.vertex_count,
+              .vertex_offset = static_cast<int32_t>(mesh.first_vertex),
+            };
+        }
+
+        return MeshBinding{
+          .vertex_buffer        = nullptr,
+          .vertex_buffer_offset = 0,
+          .index_buffer         = m_IndexBuffer->handle(),
+          .index_buffer_offset  = 0,
+          .index_type           = m_Settings.index_type,
+          .count                = mesh.index_count,
+          .first_index          = mesh.first_index,
+          .vertex_offset        = static_cast<int32_t>(mesh.first_vertex),
+        };
+    }
+
+    GpuDrawRecord MeshPool::draw_record(const Mesh& mesh, const uint32_t batch) const {
+        if (mesh.index_count == 0) { throw std::invalid_argument("GPU-driven scenes can't draw non-indexed meshes"); }
+
+        return GpuDrawRecord{
+          .index_count   = mesh.index_count,
+          .first_index   = mesh.first_index,
+          .vertex_offset = static_cast<int32_t>(mesh.first_vertex),
+          .batch         = batch,
+        };
+    }
+} // namespace vke
@@ -0,0 +1,100 @@
+//
+// Created by andy on 3/26/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/renderer/buffer.hpp"
+#include "vke/renderer/gpu_driven.hpp"
+#include "vke/renderer/graphics_pipeline.hpp"
+#include "vke/renderer/render_queue.hpp"
+#include "vke/utils/range_allocator.hpp"
+
+#include <span>
+
+namespace vke {
+
+    /**
+     * A mesh living inside of a MeshPool. The vertex range is the same in every vertex stream of the pool.
+     */
+    struct Mesh {
+        uint32_t first_vertex;
+        uint32_t vertex_count;
+        uint32_t first_index;
+        uint32_t index_count;
+    };
+
+    /**
+     * Sub-allocates static geometry from a few large device-local buffers: one per binding of the vertex layout (so split position streams stay
+     * split), and one index buffer. Meshes are addressed with vertex/index offsets instead of separate buffers, so a frame only needs a single `bind`
+     * and every mesh in the pool can be drawn with (multi-)indirect draws.
+     *
+     * Uploads are staged and submitted together by `flush_uploads`.
+     */
+    class VKE_API MeshPool {
+      public:
+        struct Settings {
+            VertexLayout  vertex_layout;
+            uint32_t      max_vertices;
+            uint32_t      max_indices; // may be 0 for a pool of non-indexed meshes, which then has no index buffer
+            vk::IndexType index_type = vk::IndexType::eUint32;
+        };
+
+        explicit MeshPool(const Settings& settings);
+        ~MeshPool();
+
+        // `vertex_streams` holds one span per binding of the vertex layout, each vertex_count * stride bytes. Empty `indices` make a non-indexed
+        // mesh. Throws std::invalid_argument if there are no vertices, and std::length_error if the pool doesn't have room for the mesh.
+        Mesh upload(std::span<const std::span<const std::byte>> vertex_streams, uint32_t vertex_count, std::span<const std::byte> indices);
+
+        // The GPU must be done with the mesh (it isn't deferred).
+        void free(const Mesh& mesh);
+
+        // Submits all of the staged uploads in one command buffer and waits for them.
+        void flush_uploads();
+
+        // Binds every vertex stream (at its binding number in the layout) and the index buffer, if the pool has one.
+        void bind(vk::CommandBuffer command_buffer) const;
+
+        // For the render queue. The vertex buffer is left empty, since `bind` has already bound the streams. Non-indexed meshes get no index buffer,
+        // so the queue draws them with `draw`.
+        [[nodiscard]] MeshBinding binding(const Mesh& mesh) const;
+
+        // GPU-driven scenes only issue indexed draws, so this throws std::invalid_argument for a non-indexed mesh.
+        [[nodiscard]] GpuDrawRecord draw_record(const Mesh& mesh, uint32_t batch) const;
+
+        [[nodiscard]] inline const VertexLayout&            vertex_layout() const noexcept { return m_Settings.vertex_layout; }
+        [[nodiscard]] inline const std::shared_ptr<Buffer>& index_buffer() const noexcept { return m_IndexBuffer; }
+        [[nodiscard]] inline const std::shared_ptr<Buffer>& vertex_buffer(const std::size_t stream) const { return m_VertexBuffers.at(stream); }
+
+        [[nodiscard]] inline uint64_t free_vertices() const noexcept { return m_VertexAllocator.free_space(); }
+        [[nodiscard]] inline uint64_t free_indices() const noexcept { return m_IndexAllocator.free_space(); }
+
+      private:
+        struct PendingCopy {
+            vk::Buffer     destination;
+            vk::BufferCopy region;
+        };
+
+        void stage(std::span<const std::byte> data, vk::Buffer destination, vk::DeviceSize destination_offset);
+
+        std::shared_ptr<Device> m_Device;
+        Settings                m_Settings;
+        uint32_t                m_IndexSize;
+
+        std::vector<std::shared_ptr<Buffer>> m_VertexBuffers;
+        std::shared_ptr<Buffer>              m_IndexBuffer;
+        RangeAllocator                       m_VertexAllocator;
+        RangeAllocator                       m_IndexAllocator;
+
+        std::vector<std::byte>   m_StagingData;
+        std::vector<PendingCopy> m_PendingCopies;
+        std::shared_ptr<Buffer>  m_StagingBuffer;
+        vk::CommandPool          m_CommandPool;
+        vk::CommandBuffer        m_CommandBuffer;
+        vk::Fence                m_UploadFence;
+    };
+
+} // namespace vke
@@ -10,6 +10,8 @@
 namespace vke {
     PipelineLayout::PipelineLayout(const Settings& settings) : m_Device(global::g_Device) {
         vk::PipelineLayoutCreateInfo create_info{};
+        create_info.setSetLayouts(settings.set_layouts);
+        create_info.setPushConstantRanges(settings.push_constant_ranges);
         m_PipelineLayout = m_Device->handle().createPipelineLayout(create_info);
     }
 
@@ -18,6 +20,6 @@ namespace vke {
     }
 
     PipelineLayout::~PipelineLayout() {
-        m_Device->destroy(m_PipelineLayout);
+        m_Device->defer_destroy(m_PipelineLayout);
     }
 } // namespace vke
@@ -10,7 +10,10 @@ namespace vke {
 
     class VKE_API PipelineLayout {
       public:
-        struct Settings {};
+        struct Settings {
+            std::vector<vk::DescriptorSetLayout> set_layouts;
+            std::vector<vk::PushConstantRange>   push_constant_ranges;
+        };
 
       private:
         explicit PipelineLayout(const Settings&);
@@ -0,0 +1,229 @@
+//
+// Created by andy on 3/24/2025.
+//
+
+#include "render_queue.hpp"
+
+#include "vke/global.hpp"
+#include "vke/utils/job_system.hpp"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace vke {
+    static constexpr std::size_t PARALLEL_SORT_THRESHOLD = 16384;
+    static constexpr std::size_t MIN_SORT_CHUNK_SIZE     = 4096;
+
+    RenderQueue::RenderQueue(const Settings& settings) : m_Settings(settings) {
+        m_InstanceFrames.resize(m_Settings.frames_in_flight);
+    }
+
+    RenderQueue::~RenderQueue() = default;
+
+    void RenderQueue::submit(const DrawPacket& packet) {
+        if (packet.pipeline == nullptr) { throw std::invalid_argument("Draw packets need a pipeline"); }
+        // Sort ids are never reused, so a pipeline past the key's range would alias one made earlier and be batched with it.
+        if (packet.pipeline->sort_id() > MAX_PIPELINE_ID) {
+            throw std::length_error("Too many pipelines have been created for the render queue sort key");
+        }
+        if (packet.material_id > MAX_MATERIAL_ID) { throw std::invalid_argument("Material id is out of range"); }
+        if (packet.mesh_id > MAX_MESH_ID) { throw std::invalid_argument("Mesh id is out of range"); }
+        if (packet.instance_data.size() > m_Settings.instance_stride) {
+            throw std::invalid_argument("Instance data is larger than the instance stride");
+        }
+
+        const auto instance_data_offset = static_cast<uint32_t>(m_InstanceData.size());
+        m_InstanceData.resize(m_InstanceData.size() + m_Settings.instance_stride);
+        if (!packet.instance_data.empty()) {
+            std::memcpy(m_InstanceData.data() + instance_data_offset, packet.instance_data.data(), packet.instance_data.size());
+        }
+
+        m_SortItems.push_back({make_sort_key(packet.pipeline->sort_id(), packet.material_id, packet.mesh_id), static_cast<uint32_t>(m_Packets.size())});
+        m_Packets.push_back({packet.pipeline, packet.material_descriptor_set, packet.mesh, instance_data_offset});
+    }
+
+    void RenderQueue::clear() {
+        m_Packets.clear();
+        m_SortItems.clear();
+        m_InstanceData.clear();
+    }
+
+    void RenderQueue::sort(std::vector<SortItem>& items, std::vector<SortItem>& scratch) {
+        const std::size_t count = items.size();
+        if (count < 2) { return; }
+
+        scratch.resize(count);
+
+        // Bits which are the same in every key never need a pass.
+        uint64_t all_and = UINT64_MAX, all_or = 0;
+        for (const auto& item : items) {
+            all_and &= item.key;
+            all_or |= item.key;
+        }
+        const uint64_t varying_bits = all_and ^ all_or;
+
+        JobSystem*        jobs        = global::g_JobSystem.get();
+        const bool        parallel    = jobs != nullptr && jobs->worker_count() > 0 && count >= PARALLEL_SORT_THRESHOLD;
+        const std::size_t chunk_count = parallel ? std::min<std::size_t>(jobs->worker_count() + 1, count / MIN_SORT_CHUNK_SIZE) : 1;
+        const std::size_t chunk_size  = (count + chunk_count - 1) / chunk_count;
+
+        std::vector<std::array<uint32_t, 256>> histograms(chunk_count);
+
+        const auto for_each_chunk = [&](const auto& fn) {
+            if (chunk_count == 1) {
+                fn(0);
+                return;
+            }
+
+            jobs->parallel_for(chunk_count, 1, [&](const std::size_t begin, const std::size_t end) {
+                for (std::size_t chunk = begin; chunk < end; chunk++) {
+                    fn(chunk);
+                }
+            });
+        };
+
+        SortItem* source      = items.data();
+        SortItem* destination = scratch.data();
+
+        for (uint32_t shift = 0; shift < 64; shift += 8) {
+            if (((varying_bits >> shift) & 0xFF) == 0) { continue; }
+
+            for_each_chunk([&](const std::size_t chunk) {
+                auto& histogram = histograms[chunk];
+                histogram.fill(0);
+
+                const std::size_t end = std::min(count, (chunk + 1) * chunk_size);
+                for (std::size_t i = chunk * chunk_size; i < end; i++) {
+                    histogram[(source[i].key >> shift) & 0xFF]++;
+                }
+            });
+
+            // Bucket-major, chunk-minor offsets keep the sort stable across chunks.
+            uint32_t offset = 0;
+            for (std::size_t bucket = 0; bucket < 256; bucket++) {
+                for (auto& histogram : histograms) {
+                    const uint32_t bucket_count = histogram[bucket];
+                    histogram[bucket]           = offset;
+                    offset += bucket_count;
+                }
+            }
+
+            for_each_chunk([&](const std::size_t chunk) {
+                auto& offsets = histograms[chunk];
+
+                const std::size_t end = std::min(count, (chunk + 1) * chunk_size);
+                for (std::size_t i = chunk * chunk_size; i < end; i++) {
+                    destination[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+                }
+            });
+
+            std::swap(source, destination);
+        }
+
+        if (source != items.data()) { items.swap(scratch); }
+    }
+
+    vk::DeviceSize RenderQueue::allocate_instances(const Renderer::FrameInfo& frame_info, const vk::DeviceSize size) {
+        auto& frame = m_InstanceFrames[frame_info.frame_index];
+
+        // The renderer has waited on the frame's fence, so nothing from the last time this frame index was used is still being read.
+        if (frame.frame_number != frame_info.frame_number) {
+            frame.frame_number = frame_info.frame_number;
+            frame.used         = 0;
+        }
+
+        if (!frame.buffer || frame.used + size > frame.buffer->size()) {
+            // Draws from earlier flushes of this frame keep the old buffer bound, and it is only destroyed once the GPU is done with it.
+            const vk::DeviceSize new_size = std::max(size, frame.buffer ? frame.buffer->size() * 2 : size);
+            frame.buffer = Buffer::create({
+              .size              = new_size,
+              .usage             = vk::BufferUsageFlagBits::eVertexBuffer,
+              .memory_properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+            });
+            frame.used = 0;
+        }
+
+        const vk::DeviceSize offset = frame.used;
+        frame.used += size;
+        return offset;
+    }
+
+    void RenderQueue::flush(const Renderer::FrameInfo& frame_info) {
+        if (m_Packets.empty()) { return; }
+
+        sort(m_SortItems, m_SortScratch);
+
+        const vk::CommandBuffer command_buffer = frame_info.command_buffer;
+        const std::size_t       count          = m_SortItems.size();
+        const uint32_t          stride         = m_Settings.instance_stride;
+
+        // Lay the instance data out in sorted order, so every batch reads one contiguous range of instances starting at its firstInstance.
+        if (stride > 0) {
+            const vk::DeviceSize offset = allocate_instances(frame_info, static_cast<vk::DeviceSize>(stride) * count);
+
+            const auto& instance_buffer = m_InstanceFrames[frame_info.frame_index].buffer;
+            const auto  instances       = static_cast<std::byte*>(instance_buffer->mapped()) + offset;
+            for (std::size_t i = 0; i < count; i++) {
+                std::memcpy(instances + i * stride, m_InstanceData.data() + m_Packets[m_SortItems[i].index].instance_data_offset, stride);
+            }
+
+            command_buffer.bindVertexBuffers(m_Settings.instance_binding, instance_buffer->handle(), offset);
+        }
+
+        constexpr uint64_t NONE           = UINT64_MAX;
+        uint64_t           bound_pipeline = NONE;
+        uint64_t           bound_material = NONE;
+        uint64_t           bound_mesh     = NONE;
+
+        for (std::size_t batch_begin = 0; batch_begin < count;) {
+            const uint64_t key       = m_SortItems[batch_begin].key;
+            std::size_t    batch_end = batch_begin + 1;
+            while (batch_end < count && m_SortItems[batch_end].key == key) {
+                batch_end++;
+            }
+
+            const auto&    packet   = m_Packets[m_SortItems[batch_begin].index];
+            const uint64_t pipeline = key >> 48;
+            const uint64_t material = (key >> 24) & MAX_MATERIAL_ID;
+            const uint64_t mesh     = key & MAX_MESH_ID;
+
+            if (pipeline != bound_pipeline) {
+                command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, packet.pipeline->handle());
+                bound_pipeline = pipeline;
+                bound_material = NONE; // a new layout may have disturbed the material set
+            }
+
+            if (material != bound_material) {
+                if (packet.material_descriptor_set) {
+                    command_buffer.bindDescriptorSets(
+                      vk::PipelineBindPoint::eGraphics, packet.pipeline->layout()->handle(), m_Settings.material_set, packet.material_descriptor_set, {}
+                    );
+                }
+                bound_material = material;
+            }
+
+            if (mesh != bound_mesh) {
+                if (packet.mesh.vertex_buffer) {
+                    command_buffer.bindVertexBuffers(m_Settings.vertex_binding, packet.mesh.vertex_buffer, packet.mesh.vertex_buffer_offset);
+                }
+                if (packet.mesh.index_buffer) {
+                    command_buffer.bindIndexBuffer(packet.mesh.index_buffer, packet.mesh.index_buffer_offset, packet.mesh.index_type);
+                }
+                bound_mesh = mesh;
+            }
+
+            const auto instance_count = static_cast<uint32_t>(batch_end - batch_begin);
+            const auto first_instance = static_cast<uint32_t>(batch_begin);
+            if (packet.mesh.index_buffer) {
+                command_buffer.drawIndexed(packet.mesh.count, instance_count, packet.mesh.first_index, packet.mesh.vertex_offset, first_instance);
+            } else {
+                command_buffer.draw(packet.mesh.count, instance_count, static_cast<uint32_t>(packet.mesh.vertex_offset), first_instance);
+            }
+
+            batch_begin = batch_end;
+        }
+
+        clear();
+    }
+} // namespace vke
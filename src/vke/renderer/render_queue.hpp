@@ -0,0 +1,120 @@
+//
+// Created by andy on 3/24/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/renderer/buffer.hpp"
+#include "vke/renderer/graphics_pipeline.hpp"
+#include "vke/renderer/renderer.hpp"
+
+#include <span>
+
+namespace vke {
+
+    /**
+     * The geometry a draw packet refers to. If there is no index buffer, `count` is a vertex count and `vertex_offset` is the first vertex.
+     */
+    struct MeshBinding {
+        vk::Buffer     vertex_buffer;
+        vk::DeviceSize vertex_buffer_offset = 0;
+        vk::Buffer     index_buffer;
+        vk::DeviceSize index_buffer_offset = 0;
+        vk::IndexType  index_type          = vk::IndexType::eUint32;
+        uint32_t       count               = 0;
+        uint32_t       first_index         = 0;
+        int32_t        vertex_offset       = 0;
+    };
+
+    /**
+     * One draw pushed into a render queue.
+     *
+     * `material_id` and `mesh_id` are what the queue sorts and batches on, so two packets with the same ids must also have the same descriptor set
+     * and mesh binding. Packets with the same pipeline, material and mesh are merged into a single instanced draw.
+     */
+    struct DrawPacket {
+        const GraphicsPipeline*    pipeline;
+        uint32_t                   material_id;
+        vk::DescriptorSet          material_descriptor_set; // optional, bound at RenderQueue::Settings::material_set
+        uint32_t                   mesh_id;
+        MeshBinding                mesh;
+        std::span<const std::byte> instance_data; // copied on submit, at most RenderQueue::Settings::instance_stride bytes
+    };
+
+    /**
+     * Collects draw packets for a frame, sorts them by a 64-bit key (pipeline, then material, then mesh) and records them with the minimum number of
+     * state changes. Runs of identical pipeline/material/mesh become one instanced draw, with per-instance data read from a per-frame instance buffer
+     * bound at `instance_binding` (so pipelines used with the queue should declare that binding with an instance input rate).
+     */
+    class VKE_API RenderQueue {
+      public:
+        struct Settings {
+            uint32_t frames_in_flight;
+            uint32_t instance_stride;
+            uint32_t vertex_binding   = 0;
+            uint32_t instance_binding = 1;
+            uint32_t material_set     = 0;
+        };
+
+        static constexpr uint32_t MAX_PIPELINE_ID = (1u << 16) - 1;
+        static constexpr uint32_t MAX_MATERIAL_ID = (1u << 24) - 1;
+        static constexpr uint32_t MAX_MESH_ID     = (1u << 24) - 1;
+
+        explicit RenderQueue(const Settings& settings);
+        ~RenderQueue();
+
+        // Throws std::invalid_argument if the packet has no pipeline, an id out of range or too much instance data, and std::length_error if its
+        // pipeline's sort id doesn't fit the key (more than MAX_PIPELINE_ID + 1 pipelines have been created).
+        void submit(const DrawPacket& packet);
+
+        // Sorts the queued packets and records them into the frame's command buffer. This must be called from within `draw` (inside the rendering
+        // scope). The queue is cleared afterwards. It can be flushed several times in a frame: each flush appends its instances after the previous
+        // one's in the frame's instance buffer.
+        void flush(const Renderer::FrameInfo& frame_info);
+
+        void clear();
+
+        [[nodiscard]] inline std::size_t size() const noexcept { return m_Packets.size(); }
+
+        [[nodiscard]] static constexpr uint64_t make_sort_key(const uint32_t pipeline_id, const uint32_t material_id, const uint32_t mesh_id) noexcept {
+            return static_cast<uint64_t>(pipeline_id & MAX_PIPELINE_ID) << 48 | static_cast<uint64_t>(material_id & MAX_MATERIAL_ID) << 24 |
+                   static_cast<uint64_t>(mesh_id & MAX_MESH_ID);
+        }
+
+        struct SortItem {
+            uint64_t key;
+            uint32_t index;
+        };
+
+        // Stable LSD radix sort on the key. Byte passes where every key has the same value are skipped, and large inputs are histogrammed and
+        // scattered in parallel on the job system.
+        static void sort(std::vector<SortItem>& items, std::vector<SortItem>& scratch);
+
+      private:
+        struct QueuedPacket {
+            const GraphicsPipeline* pipeline;
+            vk::DescriptorSet       material_descriptor_set;
+            MeshBinding             mesh;
+            uint32_t                instance_data_offset;
+        };
+
+        struct InstanceFrame {
+            std::shared_ptr<Buffer> buffer;
+            uint64_t                frame_number = UINT64_MAX;
+            vk::DeviceSize          used         = 0;
+        };
+
+        // Returns the offset of `size` bytes in the frame's instance buffer which no earlier flush of the frame has used.
+        vk::DeviceSize allocate_instances(const Renderer::FrameInfo& frame_info, vk::DeviceSize size);
+
+        Settings                   m_Settings;
+        std::vector<QueuedPacket>  m_Packets;
+        std::vector<SortItem>      m_SortItems;
+        std::vector<SortItem>      m_SortScratch;
+        std::vector<std::byte>     m_InstanceData;
+        std::vector<InstanceFrame> m_InstanceFrames;
+    };
+
+} // namespace vke
@@ -26,7 +26,11 @@ namespace vke {
     Renderer::~Renderer() {
         if (m_AddedToStack) { global::g_RendererStack->remove(this); }
 
-        m_Device->handle().waitIdle();
+        // Only this renderer's own work has to finish, whatever else the device is doing.
+        std::vector<vk::Fence> fences;
+        for (const auto& sync : m_SyncObjects) { fences.push_back(sync.in_flight_fence); }
+        [[maybe_unused]] auto _ = m_Device->handle().waitForFences(fences, true, UINT64_MAX);
+
         for (const auto& [read_semaphore, write_semaphore, fence] : m_SyncObjects) {
             m_Device->destroy(read_semaphore);
             m_Device->destroy(write_semaphore);
@@ -39,9 +43,10 @@ namespace vke {
     void Renderer::render() {
         const auto& [read_semaphore, write_semaphore, in_flight_fence] = m_SyncObjects[m_CurrentFrame];
         m_Device->wait_for_fence(in_flight_fence);
-        m_Device->reset_fence(in_flight_fence);
 
+        // Reset only once there is an image: if acquiring throws, the fence has to stay signaled for the next wait on it.
         const auto [image, image_index, will_signal_semaphore] = m_ImageSupplier.lock()->next_image(read_semaphore);
+        m_Device->reset_fence(in_flight_fence);
 
         const auto command_buffer = m_CommandBuffers[m_CurrentFrame];
 
@@ -50,6 +55,7 @@ namespace vke {
           .image            = image,
           .image_index      = image_index,
           .frame_index      = m_CurrentFrame,
+          .frame_number     = m_FrameNumber,
           .read_semaphore   = read_semaphore,
           .write_semaphore  = write_semaphore,
           .in_flight_fence  = in_flight_fence,
@@ -70,18 +76,23 @@ namespace vke {
         wait_semaphore_info.semaphore = read_semaphore;
         wait_semaphore_info.stageMask = vk::PipelineStageFlagBits2::eTopOfPipe;
 
-        vk::SemaphoreSubmitInfo signal_semaphore_info{};
-        signal_semaphore_info.semaphore = write_semaphore;
+        std::array<vk::SemaphoreSubmitInfo, 2> signal_semaphore_infos{};
+        signal_semaphore_infos[0].semaphore = write_semaphore;
+        // Whatever was deferred before this frame can go once it has finished.
+        signal_semaphore_infos[1].semaphore = m_Device->timeline();
+        signal_semaphore_infos[1].value     = m_Device->next_timeline_value();
+        signal_semaphore_infos[1].stageMask = vk::PipelineStageFlagBits2::eAllCommands;
 
         vk::SubmitInfo2 submit_info{};
         submit_info.setCommandBufferInfos(command_buffer_submit_info);
         if (will_signal_semaphore) { submit_info.setWaitSemaphoreInfos(wait_semaphore_info); }
-        submit_info.setSignalSemaphoreInfos(signal_semaphore_info);
+        submit_info.setSignalSemaphoreInfos(signal_semaphore_infos);
 
         m_Device->queues().main.queue.submit2(submit_info, in_flight_fence);
 
         m_ImageSupplier.lock()->return_image(write_semaphore);
         m_CurrentFrame = (m_CurrentFrame + 1) % m_FramesInFlight;
+        m_FrameNumber++;
     }
 
     void Renderer::render_frame_early(const FrameInfo& frame_info) {}
@@ -103,6 +114,8 @@ namespace vke {
         for (Renderer* renderer : m_Renderers) {
             renderer->render();
         }
+
+        global::g_Device->collect();
     }
 
     void push_renderer(Renderer* renderer) {
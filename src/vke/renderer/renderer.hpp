@@ -65,6 +65,7 @@ namespace vke {
             vk::Image         image;
             uint32_t          image_index;
             uint32_t          frame_index;
+            uint64_t          frame_number; // how many frames this renderer rendered before this one
             vk::Semaphore     read_semaphore, write_semaphore;
             vk::Fence         in_flight_fence;
             ImageProperties   image_properties;
@@ -84,6 +85,7 @@ namespace vke {
         std::weak_ptr<ImageSupplier> m_ImageSupplier;
         std::vector<FrameSync>       m_SyncObjects;
         uint32_t                     m_CurrentFrame = 0;
+        uint64_t                     m_FrameNumber  = 0;
 
         vk::CommandPool                m_CommandPool;
         std::vector<vk::CommandBuffer> m_CommandBuffers;
@@ -99,6 +101,7 @@ namespace vke {
 
         void push(Renderer* renderer);
         void remove(Renderer* renderer);
+        // Renders every renderer, then runs whatever the device deferred that the GPU has finished with.
         void render() const;
 
       private:
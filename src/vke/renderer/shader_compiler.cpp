@@ -0,0 +1,284 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#include "shader_compiler.hpp"
+
+#include "vke/global.hpp"
+#include "vke/utils/job_system.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#ifdef VKE_ENABLE_SHADER_COMPILER
+#  include <glslang/Public/ResourceLimits.h>
+#  include <glslang/Public/ShaderLang.h>
+#  include <glslang/SPIRV/GlslangToSpv.h>
+#endif
+
+#ifndef VKE_SHADER_COMPILER_VERSION
+#  define VKE_SHADER_COMPILER_VERSION "none"
+#endif
+
+namespace vke {
+    static constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+    static constexpr uint32_t CACHE_MAGIC = 0x43454B56; // "VKEC"
+
+    // Follows the code in a cache file, so a file which was cut short (a full disk, a crash mid write) is never taken for a valid module.
+    struct CacheTrailer {
+        uint32_t magic;
+        uint32_t word_count;
+        uint64_t checksum;
+    };
+    static_assert(sizeof(CacheTrailer) == 16);
+
+    static uint64_t checksum(const std::span<const uint32_t> code) {
+        // 64-bit FNV-1a, over the words.
+        uint64_t hash = 0xcbf29ce484222325;
+        for (const uint32_t word : code) { hash = (hash ^ word) * 0x100000001b3; }
+        return hash;
+    }
+
+    static std::vector<ShaderDefine> sorted_defines(std::vector<ShaderDefine> defines) {
+        std::ranges::sort(defines, {}, &ShaderDefine::name);
+        return defines;
+    }
+
+    static std::string read_text(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) { throw std::runtime_error("Failed to open " + path.string()); }
+
+        std::string text(static_cast<std::size_t>(file.tellg()), '\0');
+        file.seekg(0);
+        file.read(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!file) { throw std::runtime_error("Failed to read " + path.string()); }
+
+        return text;
+    }
+
+    ShaderSource ShaderSource::from_file(const std::filesystem::path& path, std::vector<ShaderDefine> defines) {
+        ShaderSource source{path, vk::ShaderStageFlagBits::eVertex, ShaderLanguage::Glsl, "main", std::move(defines)};
+
+        auto name = path.filename();
+        if (name.extension() == ".hlsl") {
+            source.language = ShaderLanguage::Hlsl;
+            name            = name.stem();
+        }
+
+        const auto extension = name.extension();
+        if (extension == ".vert") {
+            source.stage = vk::ShaderStageFlagBits::eVertex;
+        } else if (extension == ".frag") {
+            source.stage = vk::ShaderStageFlagBits::eFragment;
+        } else if (extension == ".comp") {
+            source.stage = vk::ShaderStageFlagBits::eCompute;
+        } else if (extension == ".geom") {
+            source.stage = vk::ShaderStageFlagBits::eGeometry;
+        } else if (extension == ".tesc") {
+            source.stage = vk::ShaderStageFlagBits::eTessellationControl;
+        } else if (extension == ".tese") {
+            source.stage = vk::ShaderStageFlagBits::eTessellationEvaluation;
+        } else if (extension == ".task") {
+            source.stage = vk::ShaderStageFlagBits::eTaskEXT;
+        } else if (extension == ".mesh") {
+            source.stage = vk::ShaderStageFlagBits::eMeshEXT;
+        } else {
+            throw std::invalid_argument("Can't tell the shader stage of " + path.string());
+        }
+
+        return source;
+    }
+
+    ShaderCompiler::ShaderCompiler(const Settings& settings) : m_Settings(settings) {
+        if (!m_Settings.cache_directory.empty()) { std::filesystem::create_directories(m_Settings.cache_directory); }
+#ifdef VKE_ENABLE_SHADER_COMPILER
+        glslang::InitializeProcess();
+#endif
+    }
+
+    ShaderCompiler::~ShaderCompiler() {
+#ifdef VKE_ENABLE_SHADER_COMPILER
+        glslang::FinalizeProcess();
+#endif
+    }
+
+    bool ShaderCompiler::available() noexcept {
+#ifdef VKE_ENABLE_SHADER_COMPILER
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::string_view ShaderCompiler::version() noexcept {
+        return VKE_SHADER_COMPILER_VERSION;
+    }
+
+    uint64_t ShaderCompiler::cache_key(const ShaderSource& source, const std::string_view text) {
+        // 64-bit FNV-1a. Strings are hashed with their terminator so neighbouring fields can't run into each other.
+        uint64_t   hash = 0xcbf29ce484222325;
+        const auto add  = [&hash](const std::string_view bytes) {
+            for (const char c : bytes) { hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3; }
+            hash *= 0x100000001b3; // the terminator
+        };
+
+        add(version());
+        add(std::to_string(static_cast<uint32_t>(source.language)) + ":" + std::to_string(static_cast<uint32_t>(source.stage)));
+        add(source.entry_point);
+        for (const auto& [name, value] : sorted_defines(source.defines)) {
+            add(name);
+            add(value);
+        }
+        add(text);
+        return hash;
+    }
+
+    std::vector<uint32_t> ShaderCompiler::compile(const ShaderSource& source) {
+        const auto text = read_text(source.path);
+        if (m_Settings.cache_directory.empty()) {
+            m_CacheMisses.fetch_add(1, std::memory_order_relaxed);
+            return compile_text(source, text);
+        }
+
+        // Zero padded, so every file name in the cache is the same length.
+        char       name[] = "0000000000000000.spv";
+        const auto key    = cache_key(source, text);
+        const auto end    = std::to_chars(name, name + 16, key, 16).ptr;
+        std::rotate(name, end, name + 16);
+
+        const auto path = m_Settings.cache_directory / name;
+        if (std::ifstream cached{path, std::ios::binary | std::ios::ate}) {
+            const auto size = static_cast<std::size_t>(cached.tellg());
+
+            // Anything truncated, corrupted or otherwise not SPIR-V is just compiled again (and overwritten).
+            if (size > sizeof(CacheTrailer) && (size - sizeof(CacheTrailer)) % sizeof(uint32_t) == 0) {
+                std::vector<uint32_t> code((size - sizeof(CacheTrailer)) / sizeof(uint32_t));
+                CacheTrailer          trailer{};
+                cached.seekg(0);
+                cached.read(reinterpret_cast<char*>(code.data()), static_cast<std::streamsize>(code.size() * sizeof(uint32_t)));
+                cached.read(reinterpret_cast<char*>(&trailer), sizeof(trailer));
+
+                if (cached && code[0] == SPIRV_MAGIC && trailer.magic == CACHE_MAGIC && trailer.word_count == code.size()
+                    && trailer.checksum == checksum(code)) {
+                    m_CacheHits.fetch_add(1, std::memory_order_relaxed);
+                    return code;
+                }
+            }
+        }
+
+        m_CacheMisses.fetch_add(1, std::memory_order_relaxed);
+        auto code = compile_text(source, text);
+
+        // Written next to the final name and renamed, so another process (or thread) never reads half a file. Failing to store is harmless, a
+        // file that couldn't be written completely is dropped.
+        const auto thread    = std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        const auto temporary = std::filesystem::path(path).concat("." + thread + ".tmp");
+        bool       written;
+        {
+            const CacheTrailer trailer{CACHE_MAGIC, static_cast<uint32_t>(code.size()), checksum(code)};
+
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(code.data()), static_cast<std::streamsize>(code.size() * sizeof(uint32_t)));
+            file.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+            file.flush();
+            written = static_cast<bool>(file);
+        }
+        std::error_code error;
+        if (written) { std::filesystem::rename(temporary, path, error); }
+        if (!written || error) { std::filesystem::remove(temporary, error); }
+
+        return code;
+    }
+
+    std::vector<std::vector<uint32_t>> ShaderCompiler::compile(const std::span<const ShaderSource> sources) {
+        std::vector<std::vector<uint32_t>> results(sources.size());
+        std::vector<std::string>           errors;
+        std::mutex                         errors_mutex;
+
+        const auto compile_range = [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                try {
+                    results[i] = compile(sources[i]);
+                } catch (const std::exception& e) {
+                    std::lock_guard lock(errors_mutex);
+                    errors.emplace_back(e.what());
+                }
+            }
+        };
+
+        if (sources.size() > 1 && global::g_JobSystem) {
+            global::g_JobSystem->parallel_for(sources.size(), 1, compile_range);
+        } else {
+            compile_range(0, sources.size());
+        }
+
+        if (!errors.empty()) {
+            std::string message = std::to_string(errors.size()) + " of " + std::to_string(sources.size()) + " shaders failed to compile:";
+            for (const auto& error : errors) { message += "\n" + error; }
+            throw std::runtime_error(message);
+        }
+
+        return results;
+    }
+
+    std::shared_ptr<ShaderModule> ShaderCompiler::load(const ShaderSource& source) {
+        return ShaderModule::create(compile(source));
+    }
+
+#ifdef VKE_ENABLE_SHADER_COMPILER
+    static EShLanguage to_glslang(const vk::ShaderStageFlagBits stage) {
+        switch (stage) {
+            case vk::ShaderStageFlagBits::eVertex: return EShLangVertex;
+            case vk::ShaderStageFlagBits::eFragment: return EShLangFragment;
+            case vk::ShaderStageFlagBits::eCompute: return EShLangCompute;
+            case vk::ShaderStageFlagBits::eGeometry: return EShLangGeometry;
+            case vk::ShaderStageFlagBits::eTessellationControl: return EShLangTessControl;
+            case vk::ShaderStageFlagBits::eTessellationEvaluation: return EShLangTessEvaluation;
+            case vk::ShaderStageFlagBits::eTaskEXT: return EShLangTask;
+            case vk::ShaderStageFlagBits::eMeshEXT: return EShLangMesh;
+            default: throw std::invalid_argument("Unsupported shader stage " + vk::to_string(stage));
+        }
+    }
+
+    std::vector<uint32_t> ShaderCompiler::compile_text(const ShaderSource& source, const std::string_view text) {
+        const auto stage    = to_glslang(source.stage);
+        const bool hlsl     = source.language == ShaderLanguage::Hlsl;
+        const auto messages = static_cast<EShMessages>(EShMsgSpvRules | EShMsgVulkanRules | (hlsl ? EShMsgReadHlsl : 0));
+
+        std::string preamble;
+        for (const auto& [name, value] : sorted_defines(source.defines)) { preamble += "#define " + name + " " + value + "\n"; }
+
+        const auto  name   = source.path.string();
+        const char* string = text.data();
+        const auto  length = static_cast<int>(text.size());
+        const char* names  = name.c_str();
+
+        glslang::TShader shader(stage);
+        shader.setStringsWithLengthsAndNames(&string, &length, &names, 1);
+        shader.setPreamble(preamble.c_str());
+        shader.setEntryPoint(source.entry_point.c_str());
+        shader.setSourceEntryPoint(source.entry_point.c_str());
+        shader.setEnvInput(hlsl ? glslang::EShSourceHlsl : glslang::EShSourceGlsl, stage, glslang::EShClientVulkan, 100);
+        shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_3);
+        shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_6);
+        if (!shader.parse(GetDefaultResources(), 100, false, messages)) { throw std::runtime_error(name + ":\n" + shader.getInfoLog()); }
+
+        glslang::TProgram program;
+        program.addShader(&shader);
+        if (!program.link(messages)) { throw std::runtime_error(name + ":\n" + program.getInfoLog()); }
+
+        std::vector<uint32_t> code;
+        glslang::SpvOptions   options{};
+        glslang::GlslangToSpv(*program.getIntermediate(stage), code, &options);
+        return code;
+    }
+#else
+    std::vector<uint32_t> ShaderCompiler::compile_text(const ShaderSource& source, std::string_view) {
+        throw std::runtime_error("Can't compile " + source.path.string() + ": the engine was built without VKE_ENABLE_SHADER_COMPILER");
+    }
+#endif
+} // namespace vke
@@ -0,0 +1,93 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/renderer/shader_module.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vke {
+    enum class ShaderLanguage : uint8_t {
+        Glsl,
+        Hlsl,
+    };
+
+    struct ShaderDefine {
+        std::string name;
+        std::string value;
+    };
+
+    struct ShaderSource {
+        std::filesystem::path     path;
+        vk::ShaderStageFlagBits   stage;
+        ShaderLanguage            language    = ShaderLanguage::Glsl;
+        std::string               entry_point = "main";
+        std::vector<ShaderDefine> defines;
+
+        /**
+         * Works out the stage and language from the file name: `test.vert` is a GLSL vertex shader, `test.vert.hlsl` an HLSL one. Throws
+         * std::invalid_argument for anything else.
+         */
+        static ShaderSource from_file(const std::filesystem::path& path, std::vector<ShaderDefine> defines = {});
+    };
+
+    /**
+     * Compiles GLSL and HLSL to SPIR-V at runtime (with glslang), through a content-addressed cache on disk.
+     *
+     * Each result is stored as `<key>.spv` in the cache directory, where the key is a hash of the source text, stage, language, entry point, defines
+     * and compiler version. Editing a shader or changing its defines just produces a new key, so nothing ever needs invalidating, and a warm start
+     * only reads files. The code is followed by its length and a checksum, files which don't match them are compiled again.
+     *
+     * The compiler itself is only built with the VKE_ENABLE_SHADER_COMPILER CMake option. Without it the cache still works (e.g. one filled by the
+     * shaderc tool), but a miss throws std::runtime_error.
+     */
+    class VKE_API ShaderCompiler {
+      public:
+        struct Settings {
+            std::filesystem::path cache_directory; // empty disables the cache
+        };
+
+        explicit ShaderCompiler(const Settings& settings);
+        ~ShaderCompiler();
+
+        ShaderCompiler(const ShaderCompiler&)            = delete;
+        ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+        // Whether the engine was built with the compiler, rather than only the cache.
+        [[nodiscard]] static bool available() noexcept;
+        [[nodiscard]] static std::string_view version() noexcept;
+
+        [[nodiscard]] static uint64_t cache_key(const ShaderSource& source, std::string_view text);
+
+        // Throws std::runtime_error with the compiler's log if the shader doesn't compile.
+        [[nodiscard]] std::vector<uint32_t> compile(const ShaderSource& source);
+
+        /**
+         * Compiles every source, spread over the job system. This is the one to use for permutations: sources are independent, so it scales with
+         * the number of workers. If any fail, std::runtime_error is thrown after all of them have finished, with every error in its message.
+         */
+        [[nodiscard]] std::vector<std::vector<uint32_t>> compile(std::span<const ShaderSource> sources);
+
+        [[nodiscard]] std::shared_ptr<ShaderModule> load(const ShaderSource& source);
+
+        [[nodiscard]] inline uint64_t cache_hits() const noexcept { return m_CacheHits.load(std::memory_order_relaxed); }
+        [[nodiscard]] inline uint64_t cache_misses() const noexcept { return m_CacheMisses.load(std::memory_order_relaxed); }
+
+      private:
+        static std::vector<uint32_t> compile_text(const ShaderSource& source, std::string_view text);
+
+        Settings              m_Settings;
+        std::atomic<uint64_t> m_CacheHits   = 0;
+        std::atomic<uint64_t> m_CacheMisses = 0;
+    };
+
+} // namespace vke
@@ -6,16 +6,26 @@
 
 #include "vke/global.hpp"
 
+#include <algorithm>
 #include <fstream>
 
 namespace vke {
-    ShaderModule::ShaderModule(const vk::ShaderModule module) : m_Device(global::g_Device), m_ShaderModule(module) {}
+    ShaderModule::ShaderModule(const vk::ShaderModule module, std::filesystem::path path)
+        : m_Device(global::g_Device), m_ShaderModule(module), m_Path(std::move(path)) {}
 
     ShaderModule::~ShaderModule() {
-        m_Device->destroy(m_ShaderModule);
+        m_Device->defer_destroy(m_ShaderModule);
     }
 
     std::shared_ptr<ShaderModule> ShaderModule::load(const std::filesystem::path& path) {
+        const auto code = read_code(path);
+
+        vk::ShaderModuleCreateInfo create_info{};
+        create_info.setCode(code);
+        return std::shared_ptr<ShaderModule>(new ShaderModule(global::g_Device->handle().createShaderModule(create_info), path));
+    }
+
+    std::vector<uint32_t> ShaderModule::read_code(const std::filesystem::path& path) {
         std::ifstream f(path, std::ios::in | std::ios::binary | std::ios::ate);
         if (!f.is_open()) { throw std::invalid_argument("failed to open file"); }
 
@@ -25,7 +35,7 @@ namespace vke {
         f.read(reinterpret_cast<char*>(code.data()), len);
         f.close();
 
-        return create(code);
+        return code;
     }
 
     std::shared_ptr<ShaderModule> ShaderModule::create(const std::vector<uint32_t>& code) {
@@ -33,4 +43,19 @@ namespace vke {
         create_info.setCode(code);
         return std::shared_ptr<ShaderModule>(new ShaderModule(global::g_Device->handle().createShaderModule(create_info)));
     }
+
+    std::vector<GraphicsPipeline*> ShaderModule::users() const {
+        std::lock_guard lock(m_UsersMutex);
+        return m_Users;
+    }
+
+    void ShaderModule::add_user(GraphicsPipeline* pipeline) {
+        std::lock_guard lock(m_UsersMutex);
+        m_Users.push_back(pipeline);
+    }
+
+    void ShaderModule::remove_user(GraphicsPipeline* pipeline) {
+        std::lock_guard lock(m_UsersMutex);
+        std::erase(m_Users, pipeline);
+    }
 } // namespace vke
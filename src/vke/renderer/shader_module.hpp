@@ -9,11 +9,17 @@
 #include "vke/vke.hpp"
 
 #include <filesystem>
+#include <mutex>
 
 namespace vke {
+    class VKE_API GraphicsPipeline;
+
+    namespace res {
+        class VKE_API HotReloader;
+    } // namespace res
 
     class VKE_API ShaderModule : public std::enable_shared_from_this<ShaderModule> {
-        explicit ShaderModule(vk::ShaderModule);
+        explicit ShaderModule(vk::ShaderModule, std::filesystem::path path = {});
 
       public:
         ~ShaderModule();
@@ -21,11 +27,29 @@ namespace vke {
         static std::shared_ptr<ShaderModule> load(const std::filesystem::path& path);
         static std::shared_ptr<ShaderModule> create(const std::vector<uint32_t>& code);
 
+        // Reads a SPIR-V file. Throws std::invalid_argument if it can't be opened.
+        static std::vector<uint32_t> read_code(const std::filesystem::path& path);
+
         [[nodiscard]] inline vk::ShaderModule handle() const noexcept { return m_ShaderModule; };
 
+        // The file the module was loaded from, empty if it was created from code.
+        [[nodiscard]] inline const std::filesystem::path& path() const noexcept { return m_Path; }
+
+        // The pipelines which were built from this module, so a reload only has to rebuild those.
+        [[nodiscard]] std::vector<GraphicsPipeline*> users() const;
+
       private:
-        std::shared_ptr<Device> m_Device;
-        vk::ShaderModule        m_ShaderModule;
+        void add_user(GraphicsPipeline* pipeline);
+        void remove_user(GraphicsPipeline* pipeline);
+
+        friend class GraphicsPipeline;
+        friend class res::HotReloader;
+
+        std::shared_ptr<Device>        m_Device;
+        vk::ShaderModule               m_ShaderModule;
+        std::filesystem::path          m_Path;
+        mutable std::mutex             m_UsersMutex;
+        std::vector<GraphicsPipeline*> m_Users;
     };
 
 } // namespace vke
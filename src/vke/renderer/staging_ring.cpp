@@ -0,0 +1,36 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#include "staging_ring.hpp"
+
+#include <algorithm>
+
+namespace vke {
+    StagingRing::StagingRing(const vk::DeviceSize capacity)
+        : m_Buffer(Buffer::create({
+            capacity,
+            vk::BufferUsageFlagBits::eTransferSrc,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+          })) {}
+
+    std::optional<StagingRing::Allocation> StagingRing::allocate(const vk::DeviceSize size, const vk::DeviceSize alignment) {
+        const vk::DeviceSize ring_size = capacity();
+        if (size == 0 || size > ring_size) { return std::nullopt; }
+
+        uint64_t start = (m_Head + alignment - 1) / alignment * alignment;
+        // The rest of the buffer is skipped (and counts as used) if the allocation would run off its end.
+        if (start % ring_size + size > ring_size) { start = (start / ring_size + 1) * ring_size; }
+        if (start + size - m_Tail > ring_size) { return std::nullopt; }
+
+        m_Head              = start + size;
+        const auto offset   = static_cast<vk::DeviceSize>(start % ring_size);
+        const auto contents = m_Buffer->mapped_as<std::byte>();
+        return Allocation{m_Buffer->handle(), offset, contents.subspan(offset, size)};
+    }
+
+    void StagingRing::release(const uint64_t head) {
+        VKE_ASSERT(head <= m_Head, "Released more of the staging ring than was allocated");
+        m_Tail = std::max(m_Tail, head);
+    }
+} // namespace vke
@@ -0,0 +1,54 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/renderer/buffer.hpp"
+
+#include <optional>
+#include <span>
+
+namespace vke {
+
+    /**
+     * A persistently mapped upload buffer used as a ring: allocations are carved off the head, and space is given back in the same order once the
+     * GPU is done with it. The ring doesn't know about submissions, the owner remembers `head()` when it submits and passes it to `release` once the
+     * submission has finished.
+     *
+     * Allocating never blocks. When the ring is full the upload simply has to wait for a later frame.
+     */
+    class VKE_API StagingRing {
+      public:
+        struct Allocation {
+            vk::Buffer           buffer;
+            vk::DeviceSize       offset;
+            std::span<std::byte> data;
+        };
+
+        // The capacity should be a multiple of every alignment asked for (a power of two is easiest).
+        explicit StagingRing(vk::DeviceSize capacity);
+
+        StagingRing(const StagingRing&)            = delete;
+        StagingRing& operator=(const StagingRing&) = delete;
+
+        // Allocations never wrap around the end of the buffer. nullopt if there isn't room (yet), or if `size` is larger than the whole ring.
+        [[nodiscard]] std::optional<Allocation> allocate(vk::DeviceSize size, vk::DeviceSize alignment);
+
+        // Frees every allocation made before `head` was read.
+        void release(uint64_t head);
+
+        // Only ever grows. Not an offset into the buffer.
+        [[nodiscard]] inline uint64_t       head() const noexcept { return m_Head; }
+        [[nodiscard]] inline vk::DeviceSize capacity() const noexcept { return m_Buffer->size(); }
+        [[nodiscard]] inline vk::DeviceSize used() const noexcept { return m_Head - m_Tail; }
+
+      private:
+        std::shared_ptr<Buffer> m_Buffer;
+        uint64_t                m_Head = 0;
+        uint64_t                m_Tail = 0;
+    };
+
+} // namespace vke
@@ -0,0 +1,645 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#include "texture_streamer.hpp"
+
+#include "vke/global.hpp"
+#include "vke/lifecycle.hpp"
+#include "vke/renderer/format.hpp"
+#include "vke/utils/job_system.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace vke {
+    // Mip offsets are aligned for buffer -> image copies: to the texel block and to 16 bytes, which covers optimalBufferCopyOffsetAlignment.
+    static vk::DeviceSize data_alignment(const vk::Format format) {
+        return std::lcm<vk::DeviceSize>(16, format_info(format).block_size);
+    }
+
+    static vk::Extent3D mip_extent(const TextureHeader& header, const uint32_t level) {
+        return mip_extent(vk::Extent3D{header.width, header.height, 1}, level);
+    }
+
+    std::vector<std::byte> pack_texture(const vk::Format format, const vk::Extent2D extent, const std::span<const std::span<const std::byte>> mips) {
+        const FormatInfo& info = format_info(format);
+        if (!info.valid() || info.multi_planar() || info.has_depth() || info.has_stencil()) {
+            throw std::invalid_argument("Textures need a single plane color format");
+        }
+        if (extent.width == 0 || extent.height == 0) { throw std::invalid_argument("Texture is empty"); }
+        if (mips.empty() || mips.size() > static_cast<uint32_t>(std::bit_width(std::max(extent.width, extent.height)))) {
+            throw std::invalid_argument("Texture has the wrong number of mips");
+        }
+
+        const auto count     = static_cast<uint32_t>(mips.size());
+        const auto alignment = data_alignment(format);
+
+        const TextureHeader header{
+          TEXTURE_MAGIC, static_cast<uint32_t>(format), extent.width, extent.height, count, static_cast<uint32_t>(alignment),
+        };
+        std::vector<TextureMip> table(count);
+
+        uint64_t offset = sizeof(TextureHeader) + sizeof(TextureMip) * count;
+        for (uint32_t level = count; level-- > 0;) {
+            const auto size = format_image_size(format, mip_extent(header, level));
+            if (mips[level].size() != size) { throw std::invalid_argument("Mip " + std::to_string(level) + " has the wrong size"); }
+
+            offset       = (offset + alignment - 1) / alignment * alignment;
+            table[level] = {offset, size};
+            offset += size;
+        }
+
+        std::vector<std::byte> payload(offset);
+        std::memcpy(payload.data(), &header, sizeof(header));
+        std::memcpy(payload.data() + sizeof(header), table.data(), sizeof(TextureMip) * count);
+        for (uint32_t level = 0; level < count; level++) {
+            std::memcpy(payload.data() + table[level].offset, mips[level].data(), mips[level].size());
+        }
+        return payload;
+    }
+
+    TextureStreamer::TextureStreamer(const Settings& settings)
+        : m_Device(global::g_Device), m_Settings(settings), m_Staging(settings.staging_size) {
+        if (!m_Settings.archive) { throw std::invalid_argument("Texture streamer needs an archive"); }
+        if (m_Settings.max_textures == 0 || m_Settings.frames_in_flight == 0) { throw std::invalid_argument("Texture streamer settings are empty"); }
+
+        m_CommandPool = m_Device->handle().createCommandPool({vk::CommandPoolCreateFlagBits::eResetCommandBuffer, m_Device->queues().main.family});
+
+        vk::SamplerCreateInfo sampler_info{};
+        sampler_info.magFilter    = vk::Filter::eLinear;
+        sampler_info.minFilter    = vk::Filter::eLinear;
+        sampler_info.mipmapMode   = vk::SamplerMipmapMode::eLinear;
+        sampler_info.addressModeU = vk::SamplerAddressMode::eRepeat;
+        sampler_info.addressModeV = vk::SamplerAddressMode::eRepeat;
+        sampler_info.addressModeW = vk::SamplerAddressMode::eRepeat;
+        sampler_info.maxLod       = vk::LodClampNone;
+        m_Sampler                 = m_Device->handle().createSampler(sampler_info);
+
+        // Partially bound, since slots nobody has added a texture to are never written.
+        const vk::DescriptorBindingFlags              binding_flags = vk::DescriptorBindingFlagBits::ePartiallyBound;
+        vk::DescriptorSetLayoutBindingFlagsCreateInfo flags_info{};
+        flags_info.setBindingFlags(binding_flags);
+
+        const vk::DescriptorSetLayoutBinding binding{
+          0, vk::DescriptorType::eCombinedImageSampler, m_Settings.max_textures, vk::ShaderStageFlagBits::eAll,
+        };
+        vk::DescriptorSetLayoutCreateInfo layout_info{};
+        layout_info.setBindings(binding);
+        layout_info.setPNext(&flags_info);
+        m_SetLayout = m_Device->handle().createDescriptorSetLayout(layout_info);
+
+        // One set more than there are frames in flight: the set written at the start of a frame was last used by a frame which has finished.
+        const auto set_count = m_Settings.frames_in_flight + 1;
+
+        const vk::DescriptorPoolSize pool_size{vk::DescriptorType::eCombinedImageSampler, m_Settings.max_textures * set_count};
+        vk::DescriptorPoolCreateInfo pool_info{};
+        pool_info.setMaxSets(set_count);
+        pool_info.setPoolSizes(pool_size);
+        m_DescriptorPool = m_Device->handle().createDescriptorPool(pool_info);
+
+        const std::vector layouts(set_count, m_SetLayout);
+        for (const auto set : m_Device->handle().allocateDescriptorSets({m_DescriptorPool, layouts})) { m_Sets.push_back({set, {}}); }
+
+        // The placeholder is cleared once, up front, and waited for.
+        m_Placeholder =
+          Image::create({vk::Format::eR8G8B8A8Unorm, {1, 1}, 1, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst});
+
+        const Upload upload{
+          m_Device->handle().allocateCommandBuffers({m_CommandPool, vk::CommandBufferLevel::ePrimary, 1})[0],
+          m_Device->create_fence(),
+          0,
+        };
+        upload.command_buffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+        const vk::ImageSubresourceRange range{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+        vk::ImageMemoryBarrier2         barrier{};
+        barrier.image            = m_Placeholder->handle();
+        barrier.subresourceRange = range;
+        barrier.dstStageMask     = vk::PipelineStageFlagBits2::eClear;
+        barrier.dstAccessMask    = vk::AccessFlagBits2::eTransferWrite;
+        barrier.newLayout        = vk::ImageLayout::eTransferDstOptimal;
+
+        vk::DependencyInfo dependency_info{};
+        dependency_info.setImageMemoryBarriers(barrier);
+        upload.command_buffer.pipelineBarrier2(dependency_info);
+
+        const vk::ClearColorValue grey{0.5f, 0.5f, 0.5f, 1.0f};
+        upload.command_buffer.clearColorImage(m_Placeholder->handle(), vk::ImageLayout::eTransferDstOptimal, grey, range);
+
+        barrier.srcStageMask  = vk::PipelineStageFlagBits2::eClear;
+        barrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+        barrier.dstStageMask  = vk::PipelineStageFlagBits2::eAllCommands;
+        barrier.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead;
+        barrier.oldLayout     = vk::ImageLayout::eTransferDstOptimal;
+        barrier.newLayout     = vk::ImageLayout::eShaderReadOnlyOptimal;
+        upload.command_buffer.pipelineBarrier2(dependency_info);
+        upload.command_buffer.end();
+
+        vk::CommandBufferSubmitInfo command_buffer_submit_info{};
+        command_buffer_submit_info.setCommandBuffer(upload.command_buffer);
+
+        vk::SubmitInfo2 submit_info{};
+        submit_info.setCommandBufferInfos(command_buffer_submit_info);
+        m_Device->queues().main.queue.submit2(submit_info, upload.fence);
+
+        m_Device->wait_for_fence(upload.fence);
+        m_Device->reset_fence(upload.fence);
+        m_FreeUploads.push_back(upload);
+
+        register_listener(lifecycle::pre_render, lifecycle::pre_render.append([this] { update(); }));
+    }
+
+    TextureStreamer::~TextureStreamer() {
+        for (auto& load : m_Loads) {
+            if (load.copied) { load.copied->wait(); }
+        }
+
+        // Only the streamer's own uploads are waited for. Frames in flight may still be sampling the images and descriptor sets, everything they
+        // can reach goes once the device's timeline says they have finished.
+        std::vector<vk::Fence> fences;
+        for (const auto& upload : m_Uploads) { fences.push_back(upload.fence); }
+        if (!fences.empty()) { [[maybe_unused]] auto _ = m_Device->handle().waitForFences(fences, true, UINT64_MAX); }
+
+        for (const auto& upload : m_Uploads) { m_Device->destroy(upload.fence); }
+        for (const auto& upload : m_FreeUploads) { m_Device->destroy(upload.fence); }
+
+        m_Device->defer_destroy(m_CommandPool);
+        m_Device->defer_destroy(m_DescriptorPool);
+        m_Device->defer_destroy(m_SetLayout);
+        m_Device->defer_destroy(m_Sampler);
+    }
+
+    uint32_t TextureStreamer::add(const uint64_t marker_id) {
+        const auto* entry = m_Settings.archive->find(marker_id);
+        if (!entry) { throw std::invalid_argument("Archive has no texture " + std::to_string(marker_id)); }
+        // Partial reads need the payload as is. Block compressed texels barely compress any further anyway.
+        if (entry->compression() != res::ArchiveCompression::None) { throw std::invalid_argument("Streamed textures must be stored uncompressed"); }
+
+        const auto data = m_Settings.archive->data(*entry);
+
+        Texture texture{};
+        texture.entry = entry;
+        if (data.size() < sizeof(TextureHeader)) { throw std::invalid_argument("Texture payload is truncated"); }
+        std::memcpy(&texture.header, data.data(), sizeof(TextureHeader));
+
+        const auto& header = texture.header;
+        const auto  format = static_cast<vk::Format>(header.format);
+        const auto max_mips = static_cast<uint32_t>(std::bit_width(std::max(header.width, header.height)));
+        if (header.magic != TEXTURE_MAGIC || header.width == 0 || header.height == 0 || header.mip_count == 0 || header.mip_count > max_mips
+            || header.data_alignment != data_alignment(format)) {
+            throw std::invalid_argument("Texture payload has a bad header");
+        }
+
+        const auto table_size = sizeof(TextureMip) * header.mip_count;
+        if (data.size() < sizeof(TextureHeader) + table_size) { throw std::invalid_argument("Texture payload is truncated"); }
+        texture.mips.resize(header.mip_count);
+        std::memcpy(texture.mips.data(), data.data() + sizeof(TextureHeader), table_size);
+
+        // Every mip where it should be: the right size, aligned, inside the payload, and after the next smaller one.
+        for (uint32_t level = 0; level < header.mip_count; level++) {
+            const auto& mip     = texture.mips[level];
+            const bool  ordered = level + 1 == header.mip_count || mip.offset >= texture.mips[level + 1].offset + texture.mips[level + 1].size;
+            if (mip.size != format_image_size(format, mip_extent(header, level)) || mip.offset % header.data_alignment != 0
+                || mip.offset < sizeof(TextureHeader) + table_size || mip.offset + mip.size > data.size() || !ordered) {
+                throw std::invalid_argument("Texture payload has a bad mip " + std::to_string(level));
+            }
+        }
+
+        while (texture.tail_mip + 1 < header.mip_count) {
+            const auto extent = mip_extent(header, texture.tail_mip);
+            if (std::max(extent.width, extent.height) <= m_Settings.tail_size) { break; }
+            texture.tail_mip++;
+        }
+
+        // Whatever is larger than the staging ring could never be loaded, and would keep the textures behind it from streaming in.
+        const auto tail_size = texture.mips[texture.tail_mip].offset + texture.mips[texture.tail_mip].size - texture.mips.back().offset;
+        if (tail_size > m_Staging.capacity()) { throw std::invalid_argument("Texture's mip tail is larger than the staging ring"); }
+        while (texture.first_mip < texture.tail_mip && texture.mips[texture.first_mip].size > m_Staging.capacity()) { texture.first_mip++; }
+
+        texture.resident_mip = header.mip_count;
+        texture.desired_mip  = texture.tail_mip;
+        texture.alive        = true;
+
+        uint32_t index;
+        if (!m_FreeSlots.empty()) {
+            index = m_FreeSlots.back();
+            m_FreeSlots.pop_back();
+            m_Textures[index] = std::move(texture);
+        } else {
+            if (m_Textures.size() == m_Settings.max_textures) { throw std::length_error("Texture streamer is full"); }
+
+            index = static_cast<uint32_t>(m_Textures.size());
+            m_Textures.push_back(std::move(texture));
+        }
+
+        mark_dirty(index);
+        return index;
+    }
+
+    void TextureStreamer::remove(const uint32_t index) {
+        auto& texture = this->texture(index);
+        if (texture.image) {
+            m_ResidentBytes -= texture.image->memory_size();
+            texture.image.reset(); // the device holds on to it while frames in flight may be sampling it
+        }
+
+        // A load which is still in flight is dropped once it arrives, the slot is only reused after that.
+        texture.alive = false;
+        m_RetiredSlots.push_back({index, m_Settings.frames_in_flight + 1});
+        mark_dirty(index);
+    }
+
+    void TextureStreamer::request(const uint32_t index, const float screen_size) {
+        auto& texture = this->texture(index);
+        if (texture.requested != m_Frame) {
+            texture.requested   = m_Frame;
+            texture.screen_size = 0.0f;
+        }
+        texture.screen_size = std::max(texture.screen_size, screen_size);
+    }
+
+    TextureResidency TextureStreamer::residency(const uint32_t index) const {
+        const auto& texture = this->texture(index);
+        return TextureResidency{
+          .mip_count      = texture.header.mip_count,
+          .tail_mip       = texture.tail_mip,
+          .resident_mip   = texture.resident_mip,
+          .desired_mip    = texture.desired_mip,
+          .resident_bytes = texture.image ? texture.image->memory_size() : 0,
+          .streaming      = texture.busy,
+        };
+    }
+
+    TextureStreamerStats TextureStreamer::stats() const {
+        TextureStreamerStats stats{
+          .resident_bytes = m_ResidentBytes,
+          .budget         = m_Settings.budget,
+          .staging_used   = m_Staging.used(),
+          .uploaded_bytes = m_UploadedBytes,
+          .evicted_mips   = m_EvictedMips,
+        };
+        for (const auto& texture : m_Textures) {
+            if (!texture.alive) { continue; }
+            stats.texture_count++;
+            if (texture.busy) { stats.streaming_count++; }
+        }
+        return stats;
+    }
+
+    void TextureStreamer::update() {
+        reclaim();
+        m_SetIndex = (m_SetIndex + 1) % static_cast<uint32_t>(m_Sets.size());
+
+        // Loads whose bytes have arrived in the staging ring go to the GPU together with this frame's evictions.
+        std::vector<Transition> transitions;
+        std::erase_if(m_Loads, [&](PendingLoad& load) {
+            if (load.copied) {
+                if (load.copied->wait_for(std::chrono::seconds(0)) != std::future_status::ready) { return false; }
+                load.copied->get();
+            }
+
+            m_PendingBytes -= load.growth;
+            transitions.push_back(std::move(load.transition));
+            return true;
+        });
+
+        plan();
+        transitions.insert(transitions.end(), m_Evictions.begin(), m_Evictions.end());
+        m_Evictions.clear();
+
+        submit(transitions);
+        write_descriptors(m_Sets[m_SetIndex]);
+        m_Frame++;
+    }
+
+    TextureStreamer::Texture& TextureStreamer::texture(const uint32_t index) {
+        return const_cast<Texture&>(std::as_const(*this).texture(index));
+    }
+
+    const TextureStreamer::Texture& TextureStreamer::texture(const uint32_t index) const {
+        if (index >= m_Textures.size() || !m_Textures[index].alive) { throw std::invalid_argument("No texture at index " + std::to_string(index)); }
+        return m_Textures[index];
+    }
+
+    vk::DeviceSize TextureStreamer::image_size(const Texture& texture, const uint32_t top) const {
+        return format_image_size(static_cast<vk::Format>(texture.header.format), mip_extent(texture.header, top), texture.header.mip_count - top);
+    }
+
+    void TextureStreamer::reclaim() {
+        // Uploads go through one queue, so they finish in order.
+        while (!m_Uploads.empty() && m_Device->handle().getFenceStatus(m_Uploads.front().fence) == vk::Result::eSuccess) {
+            const auto upload = m_Uploads.front();
+            m_Uploads.erase(m_Uploads.begin());
+
+            m_Staging.release(upload.staging_head);
+            m_Device->reset_fence(upload.fence);
+            m_FreeUploads.push_back(upload);
+        }
+
+        std::erase_if(m_RetiredSlots, [this](auto& retired) {
+            if (retired.frames_left > 0) { retired.frames_left--; }
+            if (retired.frames_left > 0 || m_Textures[retired.value].busy) { return false; }
+
+            m_Textures[retired.value] = Texture{};
+            m_FreeSlots.push_back(retired.value);
+            return true;
+        });
+    }
+
+    void TextureStreamer::plan() {
+        // What every texture wants. One which wasn't requested this frame isn't visible, so it only wants its tail.
+        for (auto& texture : m_Textures) {
+            if (!texture.alive) { continue; }
+
+            texture.desired_mip = texture.tail_mip;
+            if (texture.requested == m_Frame && texture.screen_size > 0.0f) {
+                const auto  size  = static_cast<float>(std::max(texture.header.width, texture.header.height));
+                const float lod   = std::floor(std::log2(size / texture.screen_size) + m_Settings.lod_bias);
+                const float first = static_cast<float>(texture.first_mip);
+                texture.desired_mip = static_cast<uint32_t>(std::clamp(lod, first, static_cast<float>(texture.tail_mip)));
+            }
+        }
+
+        // A frame always gets at least one upload, however large. Every load fits the staging ring, so one that doesn't get staging space only has
+        // to wait for earlier uploads to finish.
+        vk::DeviceSize upload_bytes = 0;
+        vk::DeviceSize projected    = m_ResidentBytes + m_PendingBytes;
+        const auto     fits_frame   = [&](const vk::DeviceSize size) {
+            return upload_bytes == 0 || upload_bytes + size <= m_Settings.upload_bytes_per_frame;
+        };
+
+        // Tails first, a texture without one is still showing the placeholder. They don't count against the budget: nothing can be evicted past them.
+        for (uint32_t index = 0; index < m_Textures.size(); index++) {
+            const auto& texture = m_Textures[index];
+            if (!texture.alive || texture.image || texture.busy) { continue; }
+
+            const auto size   = texture.mips[texture.tail_mip].offset + texture.mips[texture.tail_mip].size - texture.mips.back().offset;
+            const auto growth = image_size(texture, texture.tail_mip);
+            if (!fits_frame(size) || !load(index, texture.tail_mip, growth)) { break; }
+
+            upload_bytes += size;
+            projected += growth;
+        }
+
+        std::vector<uint32_t> upgrades, evictions;
+        for (uint32_t index = 0; index < m_Textures.size(); index++) {
+            const auto& texture = m_Textures[index];
+            if (!texture.alive || !texture.image || texture.busy) { continue; }
+
+            if (texture.resident_mip > texture.desired_mip) { upgrades.push_back(index); }
+            if (texture.resident_mip < texture.desired_mip) { evictions.push_back(index); }
+        }
+
+        // The most missing detail on the most screen space first.
+        const auto priority = [this](const uint32_t index) {
+            const auto& texture = m_Textures[index];
+            return static_cast<float>(texture.resident_mip - texture.desired_mip) * std::max(texture.screen_size, 1.0f);
+        };
+        std::ranges::sort(upgrades, std::greater{}, priority);
+
+        // The longest unwanted first, then the ones with the most to spare.
+        std::ranges::sort(evictions, [this](const uint32_t lhs, const uint32_t rhs) {
+            const auto& a = m_Textures[lhs];
+            const auto& b = m_Textures[rhs];
+            if (a.requested != b.requested) { return a.requested < b.requested; }
+            return a.desired_mip - a.resident_mip > b.desired_mip - b.resident_mip;
+        });
+
+        auto       next_eviction = evictions.begin();
+        const auto evict_one     = [&] {
+            const auto& texture = m_Textures[*next_eviction];
+            projected -= texture.image->memory_size() - std::min(texture.image->memory_size(), image_size(texture, texture.resident_mip + 1));
+            evict(*next_eviction++);
+        };
+
+        for (const uint32_t index : upgrades) {
+            const auto& texture = m_Textures[index];
+            const auto  top     = texture.resident_mip - 1;
+            const auto  size    = texture.mips[top].size;
+            const auto  growth  = image_size(texture, top) - std::min(image_size(texture, top), texture.image->memory_size());
+            if (!fits_frame(size)) { break; }
+
+            while (projected + growth > m_Settings.budget && next_eviction != evictions.end()) { evict_one(); }
+            if (projected + growth > m_Settings.budget || !load(index, top, growth)) { break; }
+
+            upload_bytes += size;
+            projected += growth;
+        }
+
+        // Nothing else wants the memory, but the budget may have shrunk below what is resident.
+        while (projected > m_Settings.budget && next_eviction != evictions.end()) { evict_one(); }
+    }
+
+    bool TextureStreamer::load(const uint32_t index, const uint32_t top, const vk::DeviceSize growth) {
+        auto&          texture  = m_Textures[index];
+        const uint32_t previous = texture.image ? texture.resident_mip : texture.header.mip_count;
+
+        // The new mips sit next to each other in the payload, smallest first.
+        const auto begin = texture.mips[previous - 1].offset;
+        const auto end   = texture.mips[top].offset + texture.mips[top].size;
+
+        const uint64_t staging_start = m_Staging.head();
+        const auto     staging       = m_Staging.allocate(end - begin, texture.header.data_alignment);
+        if (!staging) { return false; }
+
+        PendingLoad load{{index, top, staging}, staging_start, growth, std::nullopt};
+
+        auto copy = [source = m_Settings.archive->data(*texture.entry).subspan(begin, end - begin), destination = staging->data] {
+            std::memcpy(destination.data(), source.data(), source.size());
+        };
+        if (global::g_JobSystem) {
+            load.copied = global::g_JobSystem->submit(std::move(copy));
+        } else {
+            copy();
+        }
+
+        texture.busy = true;
+        m_PendingBytes += growth;
+        m_UploadedBytes += end - begin;
+        m_Loads.push_back(std::move(load));
+        return true;
+    }
+
+    void TextureStreamer::evict(const uint32_t index) {
+        auto& texture = m_Textures[index];
+        texture.busy  = true;
+        m_Evictions.push_back({index, texture.resident_mip + 1, std::nullopt});
+        m_EvictedMips++;
+    }
+
+    void TextureStreamer::submit(const std::span<const Transition> transitions) {
+        constexpr auto sampling_stages =
+          vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
+
+        struct Step {
+            const Transition*      transition;
+            Texture*               texture;
+            std::shared_ptr<Image> image;
+            uint32_t               previous; // the old image's finest mip, mip_count if there is none
+        };
+
+        std::vector<Step>                    steps;
+        std::vector<vk::ImageMemoryBarrier2> before, after;
+        for (const auto& transition : transitions) {
+            auto& texture = m_Textures[transition.texture];
+            texture.busy  = false;
+            if (!texture.alive) { continue; }
+
+            const auto format = static_cast<vk::Format>(texture.header.format);
+            const auto extent = mip_extent(texture.header, transition.top);
+
+            std::shared_ptr<Image> image;
+            try {
+                image = Image::create({
+                  format,
+                  {extent.width, extent.height},
+                  texture.header.mip_count - transition.top,
+                  vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc,
+                });
+            } catch (const vk::SystemError&) {
+                // Out of device memory: the texture stays as it is, and asks again next frame.
+                continue;
+            }
+
+            const auto aspect = format_info(format).aspect;
+            const auto levels = texture.header.mip_count - transition.top;
+
+            vk::ImageMemoryBarrier2 barrier{};
+            barrier.image            = image->handle();
+            barrier.subresourceRange = vk::ImageSubresourceRange{aspect, 0, levels, 0, 1};
+            barrier.dstStageMask     = vk::PipelineStageFlagBits2::eCopy;
+            barrier.dstAccessMask    = vk::AccessFlagBits2::eTransferWrite;
+            barrier.newLayout        = vk::ImageLayout::eTransferDstOptimal;
+            before.push_back(barrier);
+
+            barrier.srcStageMask  = vk::PipelineStageFlagBits2::eCopy;
+            barrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+            barrier.dstStageMask  = sampling_stages;
+            barrier.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead;
+            barrier.oldLayout     = vk::ImageLayout::eTransferDstOptimal;
+            barrier.newLayout     = vk::ImageLayout::eShaderReadOnlyOptimal;
+            after.push_back(barrier);
+
+            // The old image is never sampled again after this (later frames get the new one), so it doesn't have to go back to a read layout.
+            if (texture.image) {
+                vk::ImageMemoryBarrier2 source{};
+                source.image            = texture.image->handle();
+                source.subresourceRange = vk::ImageSubresourceRange{aspect, 0, texture.header.mip_count - texture.resident_mip, 0, 1};
+                source.srcStageMask     = sampling_stages;
+                source.dstStageMask     = vk::PipelineStageFlagBits2::eCopy;
+                source.dstAccessMask    = vk::AccessFlagBits2::eTransferRead;
+                source.oldLayout        = vk::ImageLayout::eShaderReadOnlyOptimal;
+                source.newLayout        = vk::ImageLayout::eTransferSrcOptimal;
+                before.push_back(source);
+            }
+
+            steps.push_back({&transition, &texture, std::move(image), texture.image ? texture.resident_mip : texture.header.mip_count});
+        }
+
+        if (steps.empty()) { return; }
+
+        Upload upload{};
+        if (!m_FreeUploads.empty()) {
+            upload = m_FreeUploads.back();
+            m_FreeUploads.pop_back();
+        } else {
+            upload.command_buffer = m_Device->handle().allocateCommandBuffers({m_CommandPool, vk::CommandBufferLevel::ePrimary, 1})[0];
+            upload.fence          = m_Device->create_fence();
+        }
+
+        const auto command_buffer = upload.command_buffer;
+        command_buffer.reset();
+        command_buffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+        vk::DependencyInfo dependency_info{};
+        dependency_info.setImageMemoryBarriers(before);
+        command_buffer.pipelineBarrier2(dependency_info);
+
+        for (auto& [transition, texture, image, previous] : steps) {
+            const auto& header = texture->header;
+            const auto  aspect = format_info(static_cast<vk::Format>(header.format)).aspect;
+            const auto  top    = transition->top;
+
+            // Mips both images have are copied on the GPU.
+            std::vector<vk::ImageCopy> image_copies;
+            for (uint32_t level = std::max(top, previous); level < header.mip_count; level++) {
+                image_copies.emplace_back(
+                  vk::ImageSubresourceLayers{aspect, level - previous, 0, 1}, vk::Offset3D{}, vk::ImageSubresourceLayers{aspect, level - top, 0, 1},
+                  vk::Offset3D{}, mip_extent(header, level)
+                );
+            }
+            if (!image_copies.empty()) {
+                command_buffer.copyImage(
+                  texture->image->handle(), vk::ImageLayout::eTransferSrcOptimal, image->handle(), vk::ImageLayout::eTransferDstOptimal, image_copies
+                );
+            }
+
+            // New mips come from the staging ring.
+            std::vector<vk::BufferImageCopy> buffer_copies;
+            for (uint32_t level = top; level < previous; level++) {
+                const auto offset = transition->staging->offset + (texture->mips[level].offset - texture->mips[previous - 1].offset);
+                buffer_copies.emplace_back(
+                  offset, 0, 0, vk::ImageSubresourceLayers{aspect, level - top, 0, 1}, vk::Offset3D{}, mip_extent(header, level)
+                );
+            }
+            if (!buffer_copies.empty()) {
+                command_buffer.copyBufferToImage(transition->staging->buffer, image->handle(), vk::ImageLayout::eTransferDstOptimal, buffer_copies);
+            }
+
+            if (texture->image) { m_ResidentBytes -= texture->image->memory_size(); }
+            m_ResidentBytes += image->memory_size();
+            texture->image        = std::move(image);
+            texture->resident_mip = top;
+            mark_dirty(transition->texture);
+        }
+
+        dependency_info.setImageMemoryBarriers(after);
+        command_buffer.pipelineBarrier2(dependency_info);
+        command_buffer.end();
+
+        vk::CommandBufferSubmitInfo command_buffer_submit_info{};
+        command_buffer_submit_info.setCommandBuffer(command_buffer);
+
+        vk::SubmitInfo2 submit_info{};
+        submit_info.setCommandBufferInfos(command_buffer_submit_info);
+        m_Device->queues().main.queue.submit2(submit_info, upload.fence);
+
+        // Staging space of loads which are still being copied must outlive this upload.
+        upload.staging_head = m_Loads.empty() ? m_Staging.head() : m_Loads.front().staging_start;
+        m_Uploads.push_back(upload);
+    }
+
+    void TextureStreamer::mark_dirty(const uint32_t index) {
+        for (auto& frame_set : m_Sets) { frame_set.dirty.push_back(index); }
+    }
+
+    void TextureStreamer::write_descriptors(FrameSet& frame_set) {
+        auto& dirty = frame_set.dirty;
+        if (dirty.empty()) { return; }
+
+        std::ranges::sort(dirty);
+        dirty.erase(std::ranges::unique(dirty).begin(), dirty.end());
+
+        std::vector<vk::DescriptorImageInfo> images;
+        std::vector<vk::WriteDescriptorSet>  writes;
+        images.reserve(dirty.size());
+        writes.reserve(dirty.size());
+        for (const uint32_t index : dirty) {
+            const auto& texture = m_Textures[index];
+            const auto  view    = texture.alive && texture.image ? texture.image->view() : m_Placeholder->view();
+
+            images.emplace_back(m_Sampler, view, vk::ImageLayout::eShaderReadOnlyOptimal);
+            writes.emplace_back(frame_set.set, 0, index, 1, vk::DescriptorType::eCombinedImageSampler, &images.back());
+        }
+
+        m_Device->handle().updateDescriptorSets(writes, {});
+        dirty.clear();
+    }
+} // namespace vke
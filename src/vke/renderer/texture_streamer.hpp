@@ -0,0 +1,216 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/renderer/image.hpp"
+#include "vke/renderer/staging_ring.hpp"
+#include "vke/resource/archive.hpp"
+
+#include <future>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Streamable texture payloads (stored uncompressed in an archive, their texel data is usually block compressed already):
+ *
+ *      TextureHeader
+ *      TextureMip mips[mip_count];     // mip 0 is the full resolution
+ *      ...texel data, smallest mip first
+ *
+ * Storing the smallest mips first means the mip tail, and every step up from what is resident, is one contiguous read.
+ */
+namespace vke {
+    constexpr uint32_t TEXTURE_MAGIC = 0x54454B56; // "VKET"
+
+    struct TextureHeader {
+        uint32_t magic;
+        uint32_t format; // vk::Format
+        uint32_t width;
+        uint32_t height;
+        uint32_t mip_count;
+        uint32_t data_alignment; // every mip's offset is a multiple of this
+    };
+
+    struct TextureMip {
+        uint64_t offset; // from the start of the payload
+        uint64_t size;
+    };
+
+    static_assert(sizeof(TextureHeader) == 24 && std::is_trivially_copyable_v<TextureHeader>);
+    static_assert(sizeof(TextureMip) == 16 && std::is_trivially_copyable_v<TextureMip>);
+
+    /**
+     * Builds a texture payload from tightly packed mips, largest first. Throws std::invalid_argument if a mip doesn't have the size its extent needs.
+     */
+    VKE_API std::vector<std::byte> pack_texture(vk::Format format, vk::Extent2D extent, std::span<const std::span<const std::byte>> mips);
+
+    struct TextureResidency {
+        uint32_t       mip_count;
+        uint32_t       tail_mip;       // this mip and everything smaller is always resident
+        uint32_t       resident_mip;   // the finest resident mip, mip_count until the tail has been uploaded
+        uint32_t       desired_mip;    // what the last frame's requests asked for
+        vk::DeviceSize resident_bytes; // device memory of the texture's image
+        bool           streaming;      // an upload or eviction is in flight
+    };
+
+    struct TextureStreamerStats {
+        uint32_t       texture_count   = 0;
+        uint32_t       streaming_count = 0;
+        vk::DeviceSize resident_bytes  = 0;
+        vk::DeviceSize budget          = 0;
+        vk::DeviceSize staging_used    = 0;
+        uint64_t       uploaded_bytes  = 0; // since the streamer was created
+        uint64_t       evicted_mips    = 0;
+    };
+
+    /**
+     * Streams textures out of an archive, mip by mip, and binds them all through one bindless descriptor array.
+     *
+     * Adding a texture only uploads its mip tail (the mips of at most `tail_size` texels). Every frame, textures are given the screen-space size they
+     * are drawn at, which decides the mip each one wants, and finer mips are streamed in one level at a time in order of how much they are missing:
+     * the bytes are copied out of the archive into a staging ring on the job system, and uploaded by the next update. While the budget is exceeded
+     * the finest mips of textures which want less than they have are evicted, least recently wanted first.
+     *
+     * Vulkan images can't grow or shrink their mip chain, so a texture changes residency by getting a new image: the mips that stay are copied over
+     * on the GPU, the new one is uploaded, and the old image is destroyed once no frame in flight can still be sampling it.
+     *
+     * Shaders index the array (set layout `set_layout()`, binding 0) with the texture's index. A texture's slot always holds something sampleable: a
+     * grey placeholder until its tail has arrived. Each frame in flight has its own descriptor set, so slots are never rewritten while the GPU may be
+     * reading them.
+     *
+     * Main thread only. Updates run automatically at lifecycle::pre_render.
+     */
+    class VKE_API TextureStreamer : public ScopedSlotSubscriber {
+      public:
+        struct Settings {
+            std::shared_ptr<res::ArchiveReader> archive;
+            vk::DeviceSize                      budget                 = 512ull * 1024 * 1024;
+            vk::DeviceSize                      staging_size           = 64ull * 1024 * 1024;
+            vk::DeviceSize                      upload_bytes_per_frame = 16ull * 1024 * 1024;
+            uint32_t                            tail_size              = 128;
+            uint32_t                            max_textures           = 4096;
+            uint32_t                            frames_in_flight       = 2;
+            float                               lod_bias               = 0.0f;
+        };
+
+        explicit TextureStreamer(const Settings& settings);
+        ~TextureStreamer() override;
+
+        TextureStreamer(const TextureStreamer&)            = delete;
+        TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+        /**
+         * Returns the texture's index in the descriptor array. Throws std::invalid_argument if the archive doesn't hold a valid, uncompressed texture
+         * payload under the marker id, or if its mip tail is larger than the staging ring, and std::length_error if every slot is taken. Mips
+         * larger than the staging ring are never streamed in, the texture tops out at the finest one that fits.
+         */
+        uint32_t add(uint64_t marker_id);
+        void     remove(uint32_t texture);
+
+        // How many pixels the texture covers along its larger axis this frame. Several requests in one frame keep the largest.
+        void request(uint32_t texture, float screen_size);
+
+        [[nodiscard]] TextureResidency     residency(uint32_t texture) const;
+        [[nodiscard]] TextureStreamerStats stats() const;
+
+        [[nodiscard]] inline vk::DescriptorSetLayout set_layout() const noexcept { return m_SetLayout; }
+
+        // The set for the frame being recorded.
+        [[nodiscard]] inline vk::DescriptorSet descriptor_set() const noexcept { return m_Sets[m_SetIndex].set; }
+
+        void update();
+
+      private:
+        struct Texture {
+            const res::ArchiveEntry* entry = nullptr;
+            TextureHeader            header{};
+            std::vector<TextureMip>  mips;
+            uint32_t                 first_mip    = 0; // the finest mip which fits the staging ring
+            uint32_t                 tail_mip     = 0;
+            uint32_t                 resident_mip = 0;
+            uint32_t                 desired_mip  = 0;
+            float                    screen_size  = 0.0f;
+            uint64_t                 requested    = 0; // frame of the last request
+            std::shared_ptr<Image>   image;
+            bool                     alive = false;
+            bool                     busy  = false;
+        };
+
+        // One step of a texture's residency: to an image whose finest mip is `top`. Mips which aren't in the current image come from `staging`.
+        struct Transition {
+            uint32_t                               texture;
+            uint32_t                               top;
+            std::optional<StagingRing::Allocation> staging;
+        };
+
+        struct PendingLoad {
+            Transition                       transition;
+            uint64_t                         staging_start; // the ring's head before the allocation, everything before it can be released
+            vk::DeviceSize                   growth;        // how much the texture's image is expected to grow
+            std::optional<std::future<void>> copied;        // empty when the copy ran inline
+        };
+
+        struct Upload {
+            vk::CommandBuffer command_buffer;
+            vk::Fence         fence;
+            uint64_t          staging_head;
+        };
+
+        template<typename T>
+        struct Retired {
+            T        value;
+            uint32_t frames_left;
+        };
+
+        struct FrameSet {
+            vk::DescriptorSet     set;
+            std::vector<uint32_t> dirty; // slots whose view changed since this set was last written
+        };
+
+        [[nodiscard]] Texture&       texture(uint32_t index);
+        [[nodiscard]] const Texture& texture(uint32_t index) const;
+        [[nodiscard]] vk::DeviceSize image_size(const Texture& texture, uint32_t top) const;
+
+        void reclaim();
+        void plan();
+        bool load(uint32_t index, uint32_t top, vk::DeviceSize growth);
+        void evict(uint32_t index);
+        void submit(std::span<const Transition> transitions);
+        void mark_dirty(uint32_t index);
+        void write_descriptors(FrameSet& frame_set);
+
+        std::shared_ptr<Device> m_Device;
+        Settings                m_Settings;
+        StagingRing             m_Staging;
+        uint64_t                m_Frame = 0;
+
+        std::vector<Texture>           m_Textures;
+        std::vector<uint32_t>          m_FreeSlots;
+        std::vector<Retired<uint32_t>> m_RetiredSlots;
+        std::vector<PendingLoad>       m_Loads;     // in allocation order
+        std::vector<Transition>        m_Evictions; // recorded with the next submit
+        vk::DeviceSize                 m_ResidentBytes = 0;
+        vk::DeviceSize                 m_PendingBytes  = 0; // growth of loads which haven't been submitted yet
+
+        vk::CommandPool     m_CommandPool;
+        std::vector<Upload> m_Uploads; // in flight, in submission order
+        std::vector<Upload> m_FreeUploads;
+
+        vk::Sampler             m_Sampler;
+        std::shared_ptr<Image>  m_Placeholder;
+        vk::DescriptorSetLayout m_SetLayout;
+        vk::DescriptorPool      m_DescriptorPool;
+        std::vector<FrameSet>   m_Sets;
+        uint32_t                m_SetIndex = 0;
+
+        uint64_t m_UploadedBytes = 0;
+        uint64_t m_EvictedMips   = 0;
+    };
+
+} // namespace vke
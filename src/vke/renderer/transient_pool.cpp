@@ -0,0 +1,250 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#include "transient_pool.hpp"
+
+#include "vke/global.hpp"
+#include "vke/lifecycle.hpp"
+#include "vke/renderer/format.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace vke {
+    TransientAttachmentPool::TransientAttachmentPool(const Settings& settings) : m_Device(global::g_Device), m_Settings(settings) {
+        const auto& properties = m_Device->memory_properties();
+        for (uint32_t i = 0; i < properties.memoryTypeCount; i++) {
+            if (properties.memoryTypes[i].propertyFlags & vk::MemoryPropertyFlagBits::eLazilyAllocated) { m_LazyMemory = settings.lazy_allocation; }
+        }
+
+        register_listener(lifecycle::pre_render, lifecycle::pre_render.append([this] { update(); }));
+    }
+
+    TransientAttachmentPool::~TransientAttachmentPool() {
+        for (const auto& block : m_Blocks) { destroy(*block); }
+    }
+
+    vk::ImageCreateInfo TransientAttachmentPool::create_info(const TransientImageKey& key) const {
+        vk::ImageCreateInfo create_info{};
+        create_info.imageType     = vk::ImageType::e2D;
+        create_info.format        = key.format;
+        create_info.extent        = vk::Extent3D{key.extent, 1};
+        create_info.mipLevels     = 1;
+        create_info.arrayLayers   = 1;
+        create_info.samples       = key.samples;
+        create_info.tiling        = vk::ImageTiling::eOptimal;
+        create_info.usage         = key.usage;
+        create_info.sharingMode   = vk::SharingMode::eExclusive;
+        create_info.initialLayout = vk::ImageLayout::eUndefined;
+        return create_info;
+    }
+
+    vk::MemoryRequirements TransientAttachmentPool::requirements(const TransientImageKey& key) const {
+        // Asked of the device rather than of an image, so nothing is created for requests that end up reusing one.
+        const auto info = create_info(key);
+        return m_Device->handle().getImageMemoryRequirements(vk::DeviceImageMemoryRequirements{&info}).memoryRequirements;
+    }
+
+    uint32_t TransientAttachmentPool::memory_type(const vk::MemoryRequirements& requirements, const bool lazy) const {
+        if (lazy) {
+            const auto& properties = m_Device->memory_properties();
+            for (uint32_t i = 0; i < properties.memoryTypeCount; i++) {
+                const auto flags = properties.memoryTypes[i].propertyFlags;
+                if ((requirements.memoryTypeBits & (1u << i)) && (flags & vk::MemoryPropertyFlagBits::eLazilyAllocated)) { return i; }
+            }
+        }
+        return m_Device->find_memory_type(requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+    }
+
+    TransientAttachmentPool::Allocation TransientAttachmentPool::allocate(const std::span<const Request> requests) {
+        Allocation allocation{m_NextAllocation++};
+        allocation.targets.resize(requests.size());
+
+        std::vector<TransientImageKey>      keys(requests.size());
+        std::vector<vk::MemoryRequirements> image_requirements(requests.size());
+        for (std::size_t i = 0; i < requests.size(); i++) {
+            keys[i] = requests[i].key;
+            if (requests[i].lazy && m_LazyMemory) { keys[i].usage |= vk::ImageUsageFlagBits::eTransientAttachment; }
+            image_requirements[i]       = requirements(keys[i]);
+            allocation.requested_bytes += image_requirements[i].size;
+        }
+
+        // Largest first, each image joins the first group whose images are all dead before it starts or born after it ends. Everything in a group
+        // is bound at offset 0 of one block, so the block just has to be as large as the largest of them. Lazy images are never grouped: their
+        // memory only exists while they are being rendered to.
+        std::vector<uint32_t> order(requests.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::stable_sort(order, std::ranges::greater{}, [&](const uint32_t i) { return image_requirements[i].size; });
+
+        std::vector<Group> groups;
+        for (const auto i : order) {
+            const auto& request = requests[i];
+            const bool  lazy    = request.lazy && m_LazyMemory;
+
+            const auto fits = [&](const Group& group) {
+                if (group.lazy || lazy || !(group.requirements.memoryTypeBits & image_requirements[i].memoryTypeBits)) { return false; }
+                return std::ranges::none_of(group.requests, [&](const uint32_t other) {
+                    return requests[other].first <= request.last && request.first <= requests[other].last;
+                });
+            };
+
+            auto group = std::ranges::find_if(groups, fits);
+            if (group == groups.end()) {
+                groups.push_back({{i}, image_requirements[i], lazy});
+            } else {
+                group->requirements.size            = std::max(group->requirements.size, image_requirements[i].size);
+                group->requirements.alignment       = std::max(group->requirements.alignment, image_requirements[i].alignment);
+                group->requirements.memoryTypeBits &= image_requirements[i].memoryTypeBits;
+                group->requests.push_back(i);
+            }
+        }
+
+        auto& blocks = m_Allocations[allocation.id];
+        for (uint32_t g = 0; g < groups.size(); g++) {
+            const auto& group = groups[g];
+
+            Block* block = find_block(group, keys);
+            if (!block) {
+                const auto type = memory_type(group.requirements, group.lazy);
+                m_Blocks.push_back(std::make_unique<Block>());
+                block              = m_Blocks.back().get();
+                block->memory      = m_Device->handle().allocateMemory(vk::MemoryAllocateInfo{group.requirements.size, type});
+                block->size        = group.requirements.size;
+                block->memory_type = type;
+                block->lazy        = group.lazy;
+            }
+            block->owner       = allocation.id;
+            block->idle_frames = 0;
+            blocks.push_back(block);
+
+            std::vector<bool> taken(block->images.size(), false);
+            for (const auto r : group.requests) {
+                const auto& image     = image_in(*block, keys[r], taken);
+                allocation.targets[r] = {image.image, image.view, g};
+            }
+            allocation.bytes += block->size;
+        }
+
+        allocation.block_count = static_cast<uint32_t>(groups.size());
+        return allocation;
+    }
+
+    TransientAttachmentPool::Block* TransientAttachmentPool::find_block(const Group& group, const std::span<const TransientImageKey> keys) {
+        // Of the free blocks the group fits in, the one which already has images for most of its requests, then the smallest.
+        Block*      best         = nullptr;
+        std::size_t best_matches = 0;
+        for (const auto& block : m_Blocks) {
+            if (block->owner || block->frames_left || block->discard || block->lazy != group.lazy) { continue; }
+            if (!(group.requirements.memoryTypeBits & (1u << block->memory_type)) || block->size < group.requirements.size) { continue; }
+
+            std::vector<bool> taken(block->images.size(), false);
+            std::size_t       matches = 0;
+            for (const auto r : group.requests) {
+                for (std::size_t i = 0; i < block->images.size(); i++) {
+                    if (taken[i] || block->images[i].key != keys[r]) { continue; }
+                    taken[i] = true;
+                    matches++;
+                    break;
+                }
+            }
+
+            if (!best || matches > best_matches || (matches == best_matches && block->size < best->size)) {
+                best         = block.get();
+                best_matches = matches;
+            }
+        }
+        return best;
+    }
+
+    const TransientAttachmentPool::PooledImage&
+    TransientAttachmentPool::image_in(Block& block, const TransientImageKey& key, std::vector<bool>& taken) {
+        for (std::size_t i = 0; i < block.images.size(); i++) {
+            if (taken[i] || block.images[i].key != key) { continue; }
+            taken[i] = true;
+            m_ReusedImages++;
+            return block.images[i];
+        }
+
+        PooledImage pooled{key};
+        pooled.image = m_Device->handle().createImage(create_info(key));
+        m_Device->handle().bindImageMemory(pooled.image, block.memory, 0);
+
+        vk::ImageViewCreateInfo view_info{};
+        view_info.image            = pooled.image;
+        view_info.viewType         = vk::ImageViewType::e2D;
+        view_info.format           = key.format;
+        view_info.subresourceRange = vk::ImageSubresourceRange{format_info(key.format).aspect, 0, 1, 0, 1};
+        pooled.view                = m_Device->handle().createImageView(view_info);
+
+        block.images.push_back(pooled);
+        taken.push_back(true);
+        m_CreatedImages++;
+        return block.images.back();
+    }
+
+    void TransientAttachmentPool::release(const uint64_t allocation) {
+        const auto it = m_Allocations.find(allocation);
+        if (it == m_Allocations.end()) { return; }
+
+        for (Block* block : it->second) {
+            block->owner       = 0;
+            block->frames_left = m_Settings.frames_in_flight;
+        }
+        m_Allocations.erase(it);
+    }
+
+    void TransientAttachmentPool::watch(const std::shared_ptr<ImageSupplier>& image_supplier) {
+        register_listener(
+          image_supplier->on_images_changed, image_supplier->on_images_changed.append([this](const std::vector<vk::Image>&) { trim(); })
+        );
+    }
+
+    void TransientAttachmentPool::trim() {
+        // Blocks in use, or which frames in flight may still be using, go once they have been released and retired.
+        std::erase_if(m_Blocks, [this](const std::unique_ptr<Block>& block) {
+            block->discard = true;
+            if (block->owner || block->frames_left > 0) { return false; }
+
+            destroy(*block);
+            return true;
+        });
+    }
+
+    void TransientAttachmentPool::update() {
+        std::erase_if(m_Blocks, [this](const std::unique_ptr<Block>& block) {
+            if (block->owner) { return false; }
+            if (block->frames_left > 0) {
+                block->frames_left--;
+                return false;
+            }
+            if (!block->discard && ++block->idle_frames <= m_Settings.idle_frames) { return false; }
+
+            destroy(*block);
+            return true;
+        });
+    }
+
+    void TransientAttachmentPool::destroy(Block& block) {
+        // Blocks are only destroyed once retired, except with the pool, which may go while its last frames are still in flight.
+        for (const auto& image : block.images) {
+            m_Device->defer_destroy(image.view);
+            m_Device->defer_destroy(image.image);
+        }
+        m_Device->defer([device = m_Device->handle(), memory = block.memory] { device.freeMemory(memory); });
+    }
+
+    TransientPoolStats TransientAttachmentPool::stats() const {
+        TransientPoolStats stats{};
+        stats.block_count    = static_cast<uint32_t>(m_Blocks.size());
+        stats.reused_images  = m_ReusedImages;
+        stats.created_images = m_CreatedImages;
+        for (const auto& block : m_Blocks) {
+            stats.image_count     += static_cast<uint32_t>(block->images.size());
+            stats.allocated_bytes += block->size;
+            if (block->lazy) { stats.lazy_count += static_cast<uint32_t>(block->images.size()); }
+            if (block->owner) { stats.in_use_bytes += block->size; }
+        }
+        return stats;
+    }
+} // namespace vke
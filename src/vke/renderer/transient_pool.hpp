@@ -0,0 +1,147 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/renderer/renderer.hpp"
+
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace vke {
+    struct TransientImageKey {
+        vk::Format              format;
+        vk::Extent2D            extent;
+        vk::SampleCountFlagBits samples;
+        vk::ImageUsageFlags     usage;
+
+        bool operator==(const TransientImageKey&) const = default;
+    };
+
+    struct TransientPoolStats {
+        uint32_t       block_count     = 0;
+        uint32_t       image_count     = 0;
+        uint32_t       lazy_count      = 0; // images in lazily allocated memory
+        vk::DeviceSize allocated_bytes = 0; // device memory of every block, in use or not
+        vk::DeviceSize in_use_bytes    = 0;
+        uint64_t       reused_images   = 0; // since the pool was created
+        uint64_t       created_images  = 0;
+    };
+
+    /**
+     * Owns the memory of transient render targets (depth buffers, MSAA and G-buffer attachments...), shared between the frame graphs using it.
+     *
+     * An allocation is a set of requested images, each with the span of passes it is used in. Images whose spans don't overlap are placed in
+     * the same block of memory. Attachments that only ever live inside one pass are created with TRANSIENT_ATTACHMENT usage and get memory of
+     * their own, lazily allocated where the device has such memory (tile based GPUs, where they then never take up memory at all).
+     *
+     * Released blocks are kept, with their images, for later allocations: an image with the same format, extent, samples and usage is reused
+     * as is, and a block large enough for a new group of images gets new images bound to it. Vulkan images can't be bound to other memory,
+     * which is why the blocks, not the images, are what gets recycled. Blocks nobody has wanted for `idle_frames` frames are freed, as is
+     * everything released after an image supplier that is being watched changes its images (a resize makes all the old extents useless).
+     *
+     * A released block can't be handed out again until every frame in flight that may still use it has finished. Main thread only, frames are
+     * counted at lifecycle::pre_render.
+     */
+    class VKE_API TransientAttachmentPool : public ScopedSlotSubscriber {
+      public:
+        struct Settings {
+            uint32_t frames_in_flight = 2;
+            uint32_t idle_frames      = 120;
+            bool     lazy_allocation  = true;
+        };
+
+        struct Request {
+            TransientImageKey key;
+            uint32_t          first; // pass indices, inclusive
+            uint32_t          last;
+            bool              lazy;  // only an attachment of a single pass, its contents are never loaded or stored
+        };
+
+        struct Target {
+            vk::Image     image;
+            vk::ImageView view;
+            uint32_t      block; // within the allocation: targets with the same block share memory
+        };
+
+        struct Allocation {
+            uint64_t            id = 0;
+            std::vector<Target> targets; // one per request, in order
+            uint32_t            block_count     = 0;
+            vk::DeviceSize      bytes           = 0; // memory of the allocation's blocks
+            vk::DeviceSize      requested_bytes = 0; // what its images would take without aliasing
+        };
+
+        explicit TransientAttachmentPool(const Settings& settings);
+        ~TransientAttachmentPool() override;
+
+        TransientAttachmentPool(const TransientAttachmentPool&)            = delete;
+        TransientAttachmentPool& operator=(const TransientAttachmentPool&) = delete;
+
+        [[nodiscard]] Allocation allocate(std::span<const Request> requests);
+        void                     release(uint64_t allocation);
+
+        // Trims the pool whenever the supplier's images change.
+        void watch(const std::shared_ptr<ImageSupplier>& image_supplier);
+
+        // Frees every block as soon as no allocation or frame in flight uses it any more, instead of keeping it for later allocations.
+        void trim();
+
+        // Whether lazy requests get lazily allocated memory: the device has it, and the settings didn't turn it off.
+        [[nodiscard]] inline bool lazy_memory_available() const noexcept { return m_LazyMemory; }
+
+        [[nodiscard]] TransientPoolStats stats() const;
+
+      private:
+        struct PooledImage {
+            TransientImageKey key;
+            vk::Image         image;
+            vk::ImageView     view;
+        };
+
+        struct Block {
+            vk::DeviceMemory         memory;
+            vk::DeviceSize           size;
+            uint32_t                 memory_type;
+            bool                     lazy;
+            std::vector<PooledImage> images;
+            uint64_t                 owner       = 0; // allocation, 0 when free
+            uint32_t                 frames_left = 0; // until a released block may be used again
+            uint32_t                 idle_frames = 0;
+            bool                     discard     = false;
+        };
+
+        struct Group {
+            std::vector<uint32_t>  requests;
+            vk::MemoryRequirements requirements;
+            bool                   lazy;
+        };
+
+        void update();
+        void destroy(Block& block);
+
+        [[nodiscard]] vk::ImageCreateInfo    create_info(const TransientImageKey& key) const;
+        [[nodiscard]] vk::MemoryRequirements requirements(const TransientImageKey& key) const;
+
+        [[nodiscard]] uint32_t           memory_type(const vk::MemoryRequirements& requirements, bool lazy) const;
+        [[nodiscard]] Block*             find_block(const Group& group, std::span<const TransientImageKey> keys);
+        [[nodiscard]] const PooledImage& image_in(Block& block, const TransientImageKey& key, std::vector<bool>& taken);
+
+        std::shared_ptr<Device> m_Device;
+        Settings                m_Settings;
+        bool                    m_LazyMemory = false;
+
+        std::vector<std::unique_ptr<Block>>               m_Blocks;
+        std::unordered_map<uint64_t, std::vector<Block*>> m_Allocations;
+        uint64_t                                          m_NextAllocation = 1;
+
+        uint64_t m_ReusedImages  = 0;
+        uint64_t m_CreatedImages = 0;
+    };
+
+} // namespace vke
@@ -0,0 +1,240 @@
+//
+// Created by andy on 3/27/2025.
+//
+
+#include "vertex_packer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define VKE_PACK_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__F16C__) || defined(__AVX2__)
+#define VKE_PACK_F16C
+#include <immintrin.h>
+#endif
+
+namespace vke {
+    namespace {
+        enum class PackKind { Float32, Float16, Snorm8, Unorm8, Snorm16, Unorm16, Snorm2_10_10_10, Unorm2_10_10_10 };
+
+        struct PackFormat {
+            PackKind kind;
+            uint32_t components;
+        };
+
+        std::optional<PackFormat> pack_format(const vk::Format format) {
+            switch (format) {
+            case vk::Format::eR32Sfloat:               return PackFormat{PackKind::Float32, 1};
+            case vk::Format::eR32G32Sfloat:            return PackFormat{PackKind::Float32, 2};
+            case vk::Format::eR32G32B32Sfloat:         return PackFormat{PackKind::Float32, 3};
+            case vk::Format::eR32G32B32A32Sfloat:      return PackFormat{PackKind::Float32, 4};
+            case vk::Format::eR16Sfloat:               return PackFormat{PackKind::Float16, 1};
+            case vk::Format::eR16G16Sfloat:            return PackFormat{PackKind::Float16, 2};
+            case vk::Format::eR16G16B16Sfloat:         return PackFormat{PackKind::Float16, 3};
+            case vk::Format::eR16G16B16A16Sfloat:      return PackFormat{PackKind::Float16, 4};
+            case vk::Format::eR8Snorm:                 return PackFormat{PackKind::Snorm8, 1};
+            case vk::Format::eR8G8Snorm:               return PackFormat{PackKind::Snorm8, 2};
+            case vk::Format::eR8G8B8Snorm:             return PackFormat{PackKind::Snorm8, 3};
+            case vk::Format::eR8G8B8A8Snorm:           return PackFormat{PackKind::Snorm8, 4};
+            case vk::Format::eR8Unorm:                 return PackFormat{PackKind::Unorm8, 1};
+            case vk::Format::eR8G8Unorm:               return PackFormat{PackKind::Unorm8, 2};
+            case vk::Format::eR8G8B8Unorm:             return PackFormat{PackKind::Unorm8, 3};
+            case vk::Format::eR8G8B8A8Unorm:           return PackFormat{PackKind::Unorm8, 4};
+            case vk::Format::eR16Snorm:                return PackFormat{PackKind::Snorm16, 1};
+            case vk::Format::eR16G16Snorm:             return PackFormat{PackKind::Snorm16, 2};
+            case vk::Format::eR16G16B16Snorm:          return PackFormat{PackKind::Snorm16, 3};
+            case vk::Format::eR16G16B16A16Snorm:       return PackFormat{PackKind::Snorm16, 4};
+            case vk::Format::eR16Unorm:                return PackFormat{PackKind::Unorm16, 1};
+            case vk::Format::eR16G16Unorm:             return PackFormat{PackKind::Unorm16, 2};
+            case vk::Format::eR16G16B16Unorm:          return PackFormat{PackKind::Unorm16, 3};
+            case vk::Format::eR16G16B16A16Unorm:       return PackFormat{PackKind::Unorm16, 4};
+            case vk::Format::eA2B10G10R10SnormPack32:  return PackFormat{PackKind::Snorm2_10_10_10, 4};
+            case vk::Format::eA2B10G10R10UnormPack32:  return PackFormat{PackKind::Unorm2_10_10_10, 4};
+            default:                                   return std::nullopt;
+            }
+        }
+
+        float clampf(const float value, const float low, const float high) { return std::min(std::max(value, low), high); }
+
+        // Both the SSE conversions and lrint round to nearest even, so the two paths give the same bits.
+        int32_t quantize(const float value, const float low, const float high, const float scale) {
+            return static_cast<int32_t>(std::lrint(clampf(value, low, high) * scale));
+        }
+
+        uint32_t pack_2_10_10_10(const int32_t (&q)[4]) {
+            return (static_cast<uint32_t>(q[0]) & 0x3FF) | (static_cast<uint32_t>(q[1]) & 0x3FF) << 10 | (static_cast<uint32_t>(q[2]) & 0x3FF) << 20 |
+                   (static_cast<uint32_t>(q[3]) & 0x3) << 30;
+        }
+
+        template <PackKind Kind>
+        void pack_element(const float (&in)[4], const uint32_t components, std::byte* out) {
+            if constexpr (Kind == PackKind::Float32) {
+                std::memcpy(out, in, components * sizeof(float));
+            } else if constexpr (Kind == PackKind::Float16) {
+                uint16_t half[4];
+#ifdef VKE_PACK_F16C
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(half), _mm_cvtps_ph(_mm_loadu_ps(in), _MM_FROUND_TO_NEAREST_INT));
+#else
+                for (uint32_t i = 0; i < 4; i++) { half[i] = float_to_half(in[i]); }
+#endif
+                std::memcpy(out, half, components * sizeof(uint16_t));
+            } else if constexpr (Kind == PackKind::Snorm8 || Kind == PackKind::Unorm8) {
+                constexpr bool signed_ = Kind == PackKind::Snorm8;
+                uint8_t        bytes[4];
+#ifdef VKE_PACK_SSE2
+                const __m128  low     = _mm_set1_ps(signed_ ? -1.0f : 0.0f);
+                const __m128  value   = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in), low), _mm_set1_ps(1.0f)), _mm_set1_ps(signed_ ? 127.0f : 255.0f));
+                const __m128i words   = _mm_packs_epi32(_mm_cvtps_epi32(value), _mm_setzero_si128());
+                const __m128i narrow  = signed_ ? _mm_packs_epi16(words, words) : _mm_packus_epi16(words, words);
+                const int32_t packed  = _mm_cvtsi128_si32(narrow);
+                std::memcpy(bytes, &packed, sizeof(bytes));
+#else
+                for (uint32_t i = 0; i < 4; i++) {
+                    bytes[i] = static_cast<uint8_t>(signed_ ? quantize(in[i], -1.0f, 1.0f, 127.0f) : quantize(in[i], 0.0f, 1.0f, 255.0f));
+                }
+#endif
+                std::memcpy(out, bytes, components);
+            } else if constexpr (Kind == PackKind::Snorm16 || Kind == PackKind::Unorm16) {
+                constexpr bool signed_ = Kind == PackKind::Snorm16;
+                uint16_t       words[4];
+#ifdef VKE_PACK_SSE2
+                const __m128 low   = _mm_set1_ps(signed_ ? -1.0f : 0.0f);
+                const __m128 value = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in), low), _mm_set1_ps(1.0f)), _mm_set1_ps(signed_ ? 32767.0f : 65535.0f));
+                __m128i      ints  = _mm_cvtps_epi32(value);
+                if constexpr (signed_) {
+                    ints = _mm_packs_epi32(ints, ints);
+                } else {
+                    // SSE2 has no unsigned 32 -> 16 pack, so bias into the signed range and flip the top bit back afterwards.
+                    ints = _mm_packs_epi32(_mm_sub_epi32(ints, _mm_set1_epi32(0x8000)), _mm_setzero_si128());
+                    ints = _mm_xor_si128(ints, _mm_set1_epi16(static_cast<int16_t>(0x8000)));
+                }
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(words), ints);
+#else
+                for (uint32_t i = 0; i < 4; i++) {
+                    words[i] = static_cast<uint16_t>(signed_ ? quantize(in[i], -1.0f, 1.0f, 32767.0f) : quantize(in[i], 0.0f, 1.0f, 65535.0f));
+                }
+#endif
+                std::memcpy(out, words, components * sizeof(uint16_t));
+            } else {
+                constexpr bool signed_ = Kind == PackKind::Snorm2_10_10_10;
+                int32_t        q[4];
+#ifdef VKE_PACK_SSE2
+                const __m128 low   = _mm_set1_ps(signed_ ? -1.0f : 0.0f);
+                const __m128 scale = signed_ ? _mm_setr_ps(511.0f, 511.0f, 511.0f, 1.0f) : _mm_setr_ps(1023.0f, 1023.0f, 1023.0f, 3.0f);
+                const __m128 value = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in), low), _mm_set1_ps(1.0f)), scale);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(q), _mm_cvtps_epi32(value));
+#else
+                for (uint32_t i = 0; i < 4; i++) {
+                    const float scale = i == 3 ? (signed_ ? 1.0f : 3.0f) : (signed_ ? 511.0f : 1023.0f);
+                    q[i]              = quantize(in[i], signed_ ? -1.0f : 0.0f, 1.0f, scale);
+                }
+#endif
+                const uint32_t packed = pack_2_10_10_10(q);
+                std::memcpy(out, &packed, sizeof(packed));
+            }
+        }
+
+        template <PackKind Kind>
+        void pack_range(
+          const uint32_t    components,
+          const float*      source,
+          const uint32_t    source_components,
+          const std::size_t count,
+          std::byte*        destination,
+          const std::size_t destination_stride
+        ) {
+            const uint32_t copied = std::min(components, source_components);
+
+            float in[4] = {};
+            for (std::size_t i = 0; i < count; i++) {
+                std::memcpy(in, source + i * source_components, copied * sizeof(float));
+                pack_element<Kind>(in, components, destination + i * destination_stride);
+            }
+        }
+    } // namespace
+
+    uint16_t float_to_half(const float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        const auto     sign      = static_cast<uint16_t>((bits >> 16) & 0x8000);
+        const uint32_t magnitude = bits & 0x7FFFFFFF;
+
+        if (magnitude >= 0x7F800000) { return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0); } // inf / nan
+        if (magnitude >= 0x477FF000) { return sign | 0x7C00; }                                         // rounds past 65504
+        if (magnitude <= 0x33000000) { return sign; }                                                  // rounds to zero
+
+        uint32_t result;
+        uint32_t remainder;
+        uint32_t halfway;
+        if (magnitude < 0x38800000) {
+            // Subnormal half: shift the full mantissa down to units of 2^-24.
+            const uint32_t shift    = 126 - (magnitude >> 23);
+            const uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+            result                  = mantissa >> shift;
+            remainder               = mantissa & ((1u << shift) - 1);
+            halfway                 = 1u << (shift - 1);
+        } else {
+            result    = (magnitude - 0x38000000) >> 13;
+            remainder = magnitude & 0x1FFF;
+            halfway   = 0x1000;
+        }
+
+        // A carry out of the mantissa correctly bumps the exponent.
+        if (remainder > halfway || (remainder == halfway && (result & 1))) { result++; }
+        return static_cast<uint16_t>(sign | result);
+    }
+
+    bool can_pack_vertex_format(const vk::Format format) { return pack_format(format).has_value(); }
+
+    void pack_vertex_attribute(
+      const vk::Format   format,
+      const float*       source,
+      const uint32_t     source_components,
+      const std::size_t  count,
+      std::byte*         destination,
+      const std::size_t  destination_stride
+    ) {
+        const auto pf = pack_format(format);
+        if (!pf) { throw std::invalid_argument("Vertex format can't be packed from floats"); }
+        VKE_ASSERT(source_components <= 4, "Vertex attributes have at most 4 components");
+
+        // Dispatch once per attribute rather than once per vertex.
+        switch (pf->kind) {
+        case PackKind::Float32:         pack_range<PackKind::Float32>(pf->components, source, source_components, count, destination, destination_stride); break;
+        case PackKind::Float16:         pack_range<PackKind::Float16>(pf->components, source, source_components, count, destination, destination_stride); break;
+        case PackKind::Snorm8:          pack_range<PackKind::Snorm8>(pf->components, source, source_components, count, destination, destination_stride); break;
+        case PackKind::Unorm8:          pack_range<PackKind::Unorm8>(pf->components, source, source_components, count, destination, destination_stride); break;
+        case PackKind::Snorm16:         pack_range<PackKind::Snorm16>(pf->components, source, source_components, count, destination, destination_stride); break;
+        case PackKind::Unorm16:         pack_range<PackKind::Unorm16>(pf->components, source, source_components, count, destination, destination_stride); break;
+        case PackKind::Snorm2_10_10_10: pack_range<PackKind::Snorm2_10_10_10>(pf->components, source, source_components, count, destination, destination_stride); break;
+        case PackKind::Unorm2_10_10_10: pack_range<PackKind::Unorm2_10_10_10>(pf->components, source, source_components, count, destination, destination_stride); break;
+        }
+    }
+
+    std::vector<std::vector<std::byte>>
+      pack_vertices(const VertexLayout& layout, const std::span<const VertexAttributeSource> sources, const std::size_t vertex_count) {
+        std::vector<std::vector<std::byte>> streams;
+        streams.reserve(layout.bindings.size());
+
+        for (const auto& binding : layout.bindings) {
+            auto& stream = streams.emplace_back(static_cast<std::size_t>(binding.stride) * vertex_count);
+
+            for (const auto& attribute : binding.attributes) {
+                const auto source = std::ranges::find(sources, attribute.location, &VertexAttributeSource::location);
+                if (source == sources.end()) { continue; }
+
+                pack_vertex_attribute(attribute.format, source->data, source->components, vertex_count, stream.data() + attribute.offset, binding.stride);
+            }
+        }
+
+        return streams;
+    }
+} // namespace vke
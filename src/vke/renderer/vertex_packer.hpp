@@ -0,0 +1,54 @@
+//
+// Created by andy on 3/27/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/renderer/graphics_pipeline.hpp"
+
+#include <span>
+
+namespace vke {
+
+    /**
+     * Float vertex data for one attribute location, `components` floats per vertex, tightly packed.
+     */
+    struct VertexAttributeSource {
+        uint32_t     location;
+        const float* data;
+        uint32_t     components;
+    };
+
+    /**
+     * Can `pack_vertex_attribute` convert floats into this format?
+     *
+     * Supported: 32-bit floats, 16-bit floats, 8 and 16-bit snorm/unorm (1-4 components), and A2B10G10R10 snorm/unorm.
+     */
+    VKE_API bool can_pack_vertex_format(vk::Format format);
+
+    /**
+     * Converts `count` elements of float data into `format`, writing one element every `destination_stride` bytes. Missing components are filled
+     * with 0 and extra source components are ignored. Uses SSE2 (and F16C for half floats, when the compiler targets it) with a scalar fallback.
+     *
+     * Throws std::invalid_argument if the format isn't supported.
+     */
+    VKE_API void pack_vertex_attribute(
+      vk::Format   format,
+      const float* source,
+      uint32_t     source_components,
+      std::size_t  count,
+      std::byte*   destination,
+      std::size_t  destination_stride
+    );
+
+    /**
+     * Packs float attributes into one byte stream per binding of `layout` (ready for MeshPool::upload). Attributes without a source are zeroed.
+     */
+    VKE_API std::vector<std::vector<std::byte>>
+      pack_vertices(const VertexLayout& layout, std::span<const VertexAttributeSource> sources, std::size_t vertex_count);
+
+    VKE_API uint16_t float_to_half(float value);
+
+} // namespace vke
@@ -0,0 +1,216 @@
+//
+// Created by andy on 3/27/2025.
+//
+
+#include "archive.hpp"
+
+#include "vke/resource/compression.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef WIN32
+#  include <Windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace vke::res {
+    static constexpr uint64_t align_up(const uint64_t value, const uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    ArchiveWriter::ArchiveWriter(const uint32_t payload_alignment) : m_PayloadAlignment(payload_alignment) {
+        if (payload_alignment == 0 || (payload_alignment & (payload_alignment - 1)) != 0) {
+            throw std::invalid_argument("Archive payload alignment must be a power of two");
+        }
+    }
+
+    void ArchiveWriter::set_compression(const uint32_t type, const CompressionPolicy& policy) { m_Policies[type] = policy; }
+
+    void ArchiveWriter::add(const uint64_t marker_id, const uint32_t type, const std::span<const std::byte> data) {
+        if (std::ranges::find(m_Entries, marker_id, &PendingEntry::marker_id) != m_Entries.end()) {
+            throw std::invalid_argument("Resource is already in the archive");
+        }
+
+        if (const auto policy = m_Policies.find(type); policy != m_Policies.end()) {
+            if (auto compressed = compress(data, policy->second); !compressed.empty()) {
+                m_Entries.push_back({marker_id, type, static_cast<uint32_t>(policy->second.compression), data.size(), std::move(compressed)});
+                return;
+            }
+        }
+
+        m_Entries.push_back({marker_id, type, static_cast<uint32_t>(ArchiveCompression::None), data.size(), {data.begin(), data.end()}});
+    }
+
+    uint64_t ArchiveWriter::stored_size() const noexcept {
+        uint64_t size = 0;
+        for (const auto& entry : m_Entries) {
+            size += entry.data.size();
+        }
+        return size;
+    }
+
+    uint64_t ArchiveWriter::uncompressed_size() const noexcept {
+        uint64_t size = 0;
+        for (const auto& entry : m_Entries) {
+            size += entry.size;
+        }
+        return size;
+    }
+
+    std::vector<std::byte> ArchiveWriter::serialize() const {
+        const uint64_t table_offset   = align_up(sizeof(ArchiveHeader), alignof(ArchiveEntry));
+        const uint64_t payload_offset = align_up(table_offset + m_Entries.size() * sizeof(ArchiveEntry), m_PayloadAlignment);
+
+        // Payloads go in the order they were added, the table only gets sorted once they're copied.
+        std::vector<ArchiveEntry> table;
+        table.reserve(m_Entries.size());
+
+        uint64_t cursor = payload_offset;
+        for (const auto& [marker_id, type, flags, size, data] : m_Entries) {
+            cursor = align_up(cursor, m_PayloadAlignment);
+            table.push_back({marker_id, cursor, size, data.size(), flags, type});
+            cursor += data.size();
+        }
+
+        const ArchiveHeader header{
+          .magic             = ARCHIVE_MAGIC,
+          .version           = ARCHIVE_VERSION,
+          .header_size       = sizeof(ArchiveHeader),
+          .entry_count       = static_cast<uint32_t>(table.size()),
+          .payload_alignment = m_PayloadAlignment,
+          .table_offset      = table_offset,
+          .payload_offset    = payload_offset,
+          .file_size         = cursor,
+        };
+
+        std::vector<std::byte> out(cursor);
+        for (std::size_t i = 0; i < m_Entries.size(); i++) {
+            std::ranges::copy(m_Entries[i].data, out.begin() + static_cast<std::ptrdiff_t>(table[i].offset));
+        }
+
+        std::ranges::sort(table, {}, &ArchiveEntry::marker_id);
+        std::memcpy(out.data(), &header, sizeof(header));
+        if (!table.empty()) { std::memcpy(out.data() + table_offset, table.data(), table.size() * sizeof(ArchiveEntry)); }
+
+        return out;
+    }
+
+    void ArchiveWriter::write(const std::filesystem::path& path) const {
+        const auto bytes = serialize();
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) { throw std::runtime_error("Failed to open " + path.string() + " for writing"); }
+
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file) { throw std::runtime_error("Failed to write archive " + path.string()); }
+    }
+
+    ArchiveReader::ArchiveReader(const std::filesystem::path& path) : m_Path(path) {
+#ifdef WIN32
+        m_File = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_File == INVALID_HANDLE_VALUE) {
+            m_File = nullptr;
+            throw std::runtime_error("Failed to open archive " + path.string());
+        }
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(m_File, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(ArchiveHeader))) {
+            unmap();
+            throw std::runtime_error("Archive " + path.string() + " is too small");
+        }
+        m_Size = static_cast<std::size_t>(size.QuadPart);
+
+        m_Mapping = CreateFileMappingW(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_Mapping != nullptr) { m_Data = static_cast<const std::byte*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0)); }
+#else
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) { throw std::runtime_error("Failed to open archive " + path.string()); }
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(ArchiveHeader))) {
+            close(fd);
+            throw std::runtime_error("Archive " + path.string() + " is too small");
+        }
+        m_Size = static_cast<std::size_t>(st.st_size);
+
+        // The mapping keeps the file alive on its own.
+        void* mapping = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping != MAP_FAILED) { m_Data = static_cast<const std::byte*>(mapping); }
+#endif
+        if (m_Data == nullptr) {
+            unmap();
+            throw std::runtime_error("Failed to map archive " + path.string());
+        }
+
+        try {
+            validate();
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    ArchiveReader::~ArchiveReader() { unmap(); }
+
+    void ArchiveReader::unmap() noexcept {
+#ifdef WIN32
+        if (m_Data != nullptr) { UnmapViewOfFile(m_Data); }
+        if (m_Mapping != nullptr) { CloseHandle(m_Mapping); }
+        if (m_File != nullptr) { CloseHandle(m_File); }
+        m_Mapping = nullptr;
+        m_File    = nullptr;
+#else
+        if (m_Data != nullptr) { munmap(const_cast<std::byte*>(m_Data), m_Size); }
+#endif
+        m_Data = nullptr;
+    }
+
+    void ArchiveReader::validate() {
+        const auto fail = [this](const char* reason) { throw std::runtime_error("Invalid archive " + m_Path.string() + ": " + reason); };
+
+        m_Header = reinterpret_cast<const ArchiveHeader*>(m_Data);
+        if (m_Header->magic != ARCHIVE_MAGIC) { fail("bad magic"); }
+        if (m_Header->version != ARCHIVE_VERSION) { fail("unsupported version"); }
+        if (m_Header->header_size < sizeof(ArchiveHeader)) { fail("header is too small"); }
+        if (m_Header->file_size != m_Size) { fail("file is truncated"); }
+
+        const uint64_t table_size = static_cast<uint64_t>(m_Header->entry_count) * sizeof(ArchiveEntry);
+        if (m_Header->table_offset % alignof(ArchiveEntry) != 0 || m_Header->table_offset > m_Size || table_size > m_Size - m_Header->table_offset) {
+            fail("resource table is out of bounds");
+        }
+        m_Entries = {reinterpret_cast<const ArchiveEntry*>(m_Data + m_Header->table_offset), m_Header->entry_count};
+
+        for (std::size_t i = 0; i < m_Entries.size(); i++) {
+            const ArchiveEntry& entry = m_Entries[i];
+            if (i > 0 && m_Entries[i - 1].marker_id >= entry.marker_id) { fail("resource table isn't sorted"); }
+            if (entry.offset > m_Size || entry.compressed_size > m_Size - entry.offset) { fail("payload is out of bounds"); }
+            if (entry.compression() == ArchiveCompression::None && entry.size != entry.compressed_size) { fail("uncompressed payload has the wrong size"); }
+        }
+    }
+
+    const ArchiveEntry* ArchiveReader::find(const uint64_t marker_id) const noexcept {
+        const auto it = std::ranges::lower_bound(m_Entries, marker_id, {}, &ArchiveEntry::marker_id);
+        if (it == m_Entries.end() || it->marker_id != marker_id) { return nullptr; }
+        return &*it;
+    }
+
+    std::span<const std::byte> ArchiveReader::data(const ArchiveEntry& entry) const noexcept {
+        return {m_Data + entry.offset, static_cast<std::size_t>(entry.compressed_size)};
+    }
+
+    void ArchiveReader::read(const ArchiveEntry& entry, const std::span<std::byte> destination) const { read_entry(entry, data(entry), destination); }
+
+    std::span<const std::byte> ArchiveReader::view(const uint64_t marker_id) const noexcept {
+        const ArchiveEntry* entry = find(marker_id);
+        if (entry == nullptr) { return {}; }
+        return data(*entry);
+    }
+} // namespace vke::res
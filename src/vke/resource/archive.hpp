@@ -0,0 +1,163 @@
+//
+// Created by andy on 3/27/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Packed binary resource files (archives).
+ *
+ * Layout (all integers little endian):
+ *      1. ArchiveHeader
+ *      2. The resource table: `entry_count` ArchiveEntry records, sorted by marker id so lookups are a binary search.
+ *      3. Payloads, each starting at a multiple of `payload_alignment`. Payloads are stored in the order they were added to the writer (not the
+ *         order of the table), so resources that are used together can be laid out next to each other and read front to back as an asset group.
+ *
+ * The reader maps the whole file, so looking up a resource never touches the disk until its bytes are actually used, and the views it returns
+ * point straight into the mapping.
+ */
+namespace vke::res {
+    constexpr uint32_t ARCHIVE_MAGIC             = 0x41454B56; // "VKEA"
+    constexpr uint16_t ARCHIVE_VERSION           = 1;
+    constexpr uint32_t DEFAULT_ARCHIVE_ALIGNMENT = 16;
+
+    struct ArchiveHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t header_size; // sizeof(ArchiveHeader) when written, so later versions can grow the header
+        uint32_t entry_count;
+        uint32_t payload_alignment;
+        uint64_t table_offset;
+        uint64_t payload_offset; // first payload byte, the start of a sequential read of the whole archive
+        uint64_t file_size;
+    };
+
+    /**
+     * How an entry's payload is stored. Lives in the low byte of ArchiveEntry::flags.
+     */
+    enum class ArchiveCompression : uint8_t {
+        None = 0,
+        Lz4  = 1, // fast to decode, for things that are loaded often or are on the critical path
+        Zstd = 2, // smaller, for big assets where the disk is the bottleneck
+    };
+
+    constexpr uint32_t ARCHIVE_COMPRESSION_MASK = 0xFF;
+
+    /**
+     * How the writer stores resources of one type. `level` is passed to the compressor, 0 means its default.
+     */
+    struct CompressionPolicy {
+        ArchiveCompression compression = ArchiveCompression::None;
+        int                level       = 0;
+    };
+
+    struct ArchiveEntry {
+        uint64_t marker_id;       // ResourceId::marker_id
+        uint64_t offset;          // from the start of the file
+        uint64_t size;            // size once decompressed
+        uint64_t compressed_size; // bytes stored in the archive, equal to `size` for uncompressed entries
+        uint32_t flags;
+        uint32_t type; // which loader understands the payload
+
+        [[nodiscard]] inline ArchiveCompression compression() const noexcept {
+            return static_cast<ArchiveCompression>(flags & ARCHIVE_COMPRESSION_MASK);
+        }
+    };
+
+    static_assert(sizeof(ArchiveHeader) == 40 && std::is_trivially_copyable_v<ArchiveHeader>);
+    static_assert(sizeof(ArchiveEntry) == 40 && std::is_trivially_copyable_v<ArchiveEntry>);
+
+    /**
+     * Builds an archive in memory and writes it out in one go. Resources are compressed as they are added, using the policy of their type. If
+     * compressing a resource doesn't make it smaller it is stored as is.
+     */
+    class VKE_API ArchiveWriter {
+      public:
+        explicit ArchiveWriter(uint32_t payload_alignment = DEFAULT_ARCHIVE_ALIGNMENT);
+
+        // Applies to resources added afterwards.
+        void set_compression(uint32_t type, const CompressionPolicy& policy);
+
+        // Copies `data`. Throws std::invalid_argument if the marker id has already been added.
+        void add(uint64_t marker_id, uint32_t type, std::span<const std::byte> data);
+
+        // Header, table and payloads, exactly as they are written to disk.
+        [[nodiscard]] std::vector<std::byte> serialize() const;
+
+        // Throws std::runtime_error if the file can't be written.
+        void write(const std::filesystem::path& path) const;
+
+        [[nodiscard]] inline std::size_t entry_count() const noexcept { return m_Entries.size(); }
+        [[nodiscard]] uint64_t           stored_size() const noexcept;
+        [[nodiscard]] uint64_t           uncompressed_size() const noexcept;
+
+      private:
+        struct PendingEntry {
+            uint64_t               marker_id;
+            uint32_t               type;
+            uint32_t               flags;
+            uint64_t               size;
+            std::vector<std::byte> data;
+        };
+
+        uint32_t                                        m_PayloadAlignment;
+        std::vector<PendingEntry>                       m_Entries;
+        std::unordered_map<uint32_t, CompressionPolicy> m_Policies;
+    };
+
+    /**
+     * Memory maps an archive for reading. The header, table and every entry's bounds are validated up front (throwing std::runtime_error), so
+     * lookups afterwards can't fail. Views stay valid for the lifetime of the reader.
+     */
+    class VKE_API ArchiveReader {
+      public:
+        explicit ArchiveReader(const std::filesystem::path& path);
+        ~ArchiveReader();
+
+        ArchiveReader(const ArchiveReader&)            = delete;
+        ArchiveReader& operator=(const ArchiveReader&) = delete;
+
+        // nullptr if the archive doesn't contain the resource. O(log n).
+        [[nodiscard]] const ArchiveEntry* find(uint64_t marker_id) const noexcept;
+
+        // The stored (possibly compressed) bytes of an entry.
+        [[nodiscard]] std::span<const std::byte> data(const ArchiveEntry& entry) const noexcept;
+
+        // Decompresses (or copies) an entry straight from the mapping into `destination`, which must be exactly `entry.size` bytes.
+        void read(const ArchiveEntry& entry, std::span<std::byte> destination) const;
+
+        // The stored bytes of a resource, or an empty span if the archive doesn't contain it.
+        [[nodiscard]] std::span<const std::byte> view(uint64_t marker_id) const noexcept;
+
+        [[nodiscard]] inline const ArchiveHeader&          header() const noexcept { return *m_Header; }
+        [[nodiscard]] inline std::span<const ArchiveEntry> entries() const noexcept { return m_Entries; }
+        [[nodiscard]] inline std::span<const std::byte>    bytes() const noexcept { return {m_Data, m_Size}; }
+        [[nodiscard]] inline const std::filesystem::path&  path() const noexcept { return m_Path; }
+
+      private:
+        void validate();
+        void unmap() noexcept;
+
+        std::filesystem::path         m_Path;
+        const std::byte*              m_Data   = nullptr;
+        std::size_t                   m_Size   = 0;
+        const ArchiveHeader*          m_Header = nullptr;
+        std::span<const ArchiveEntry> m_Entries;
+
+#ifdef WIN32
+        void* m_File    = nullptr;
+        void* m_Mapping = nullptr;
+#endif
+    };
+
+} // namespace vke::res
@@ -0,0 +1,298 @@
+//
+// Created by andy on 3/27/2025.
+//
+
+#include "asset_group.hpp"
+
+#include "vke/global.hpp"
+#include "vke/utils/job_system.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef WIN32
+#  include <Windows.h>
+#else
+#  include <cerrno>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+namespace vke::res {
+    using clock = std::chrono::steady_clock;
+
+    namespace {
+        // Positional reads (no shared file pointer to seek), with the OS reading ahead of us.
+        class SequentialFile {
+          public:
+            explicit SequentialFile(const std::filesystem::path& path) {
+#ifdef WIN32
+                m_Handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+                if (m_Handle == INVALID_HANDLE_VALUE) { throw std::runtime_error("Failed to open asset group " + path.string()); }
+#else
+                m_Fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (m_Fd < 0) { throw std::runtime_error("Failed to open asset group " + path.string()); }
+#  ifdef POSIX_FADV_SEQUENTIAL
+                posix_fadvise(m_Fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#  endif
+#endif
+            }
+
+            ~SequentialFile() {
+#ifdef WIN32
+                CloseHandle(m_Handle);
+#else
+                close(m_Fd);
+#endif
+            }
+
+            SequentialFile(const SequentialFile&)            = delete;
+            SequentialFile& operator=(const SequentialFile&) = delete;
+
+            // Reads exactly `size` bytes, throwing if the file ends first.
+            void read(uint64_t offset, std::byte* destination, std::size_t size) const {
+                while (size > 0) {
+#ifdef WIN32
+                    OVERLAPPED overlapped{};
+                    overlapped.Offset     = static_cast<DWORD>(offset);
+                    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+                    DWORD read = 0;
+                    if (!ReadFile(m_Handle, destination, static_cast<DWORD>(std::min<std::size_t>(size, 1u << 30)), &read, &overlapped) || read == 0) {
+                        throw std::runtime_error("Failed to read asset group");
+                    }
+#else
+                    const ssize_t read = pread(m_Fd, destination, size, static_cast<off_t>(offset));
+                    if (read < 0 && errno == EINTR) { continue; }
+                    if (read <= 0) { throw std::runtime_error("Failed to read asset group"); }
+#endif
+                    offset += static_cast<uint64_t>(read);
+                    destination += read;
+                    size -= static_cast<std::size_t>(read);
+                }
+            }
+
+            // Hints that a range is about to be read so the kernel can fetch it while we process the current one. On Windows,
+            // FILE_FLAG_SEQUENTIAL_SCAN already makes the cache manager read ahead aggressively.
+            void prefetch([[maybe_unused]] const uint64_t offset, [[maybe_unused]] const std::size_t size) const noexcept {
+#if !defined(WIN32) && defined(POSIX_FADV_WILLNEED)
+                posix_fadvise(m_Fd, static_cast<off_t>(offset), static_cast<off_t>(size), POSIX_FADV_WILLNEED);
+#endif
+            }
+
+          private:
+#ifdef WIN32
+            HANDLE m_Handle;
+#else
+            int m_Fd;
+#endif
+        };
+    } // namespace
+
+    struct AssetGroupLoader::GroupLoad {
+        std::filesystem::path                     path;
+        std::unordered_map<uint32_t, AssetLoader> loaders;
+        std::promise<AssetGroupStats>             promise;
+        clock::time_point                         start;
+
+        // Bytes read which are still waiting for their loaders.
+        std::mutex              buffer_mutex;
+        std::condition_variable buffer_condition;
+        std::size_t             buffered = 0;
+
+        // One per asset plus one for the I/O thread, so the group can't complete before it has been read fully.
+        std::atomic<uint32_t> remaining  = 1;
+        std::atomic<uint32_t> skipped    = 0;
+        std::atomic<bool>     any_loaded = false;
+        AssetGroupStats       stats;
+
+        std::mutex         error_mutex;
+        std::exception_ptr error;
+
+        void set_error(std::exception_ptr exception) {
+            std::lock_guard lock(error_mutex);
+            if (!error) { error = std::move(exception); }
+        }
+
+        void reserve_buffer(const std::size_t size, const std::size_t limit) {
+            std::unique_lock lock(buffer_mutex);
+            buffer_condition.wait(lock, [&] { return buffered == 0 || buffered + size <= limit; });
+            buffered += size;
+        }
+
+        void release_buffer(const std::size_t size) {
+            {
+                std::lock_guard lock(buffer_mutex);
+                buffered -= size;
+            }
+            buffer_condition.notify_all();
+        }
+    };
+
+    AssetGroupLoader::AssetGroupLoader(const Settings& settings) : m_Settings(settings) {
+        if (m_Settings.read_size == 0) { throw std::invalid_argument("Asset group read size must not be 0"); }
+        if (m_Settings.max_buffered == 0) { throw std::invalid_argument("Asset group buffer limit must not be 0"); }
+        m_IoThread = std::thread([this] { io_main(); });
+    }
+
+    AssetGroupLoader::~AssetGroupLoader() {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_Condition.notify_all();
+        m_IoThread.join();
+    }
+
+    void AssetGroupLoader::register_loader(const uint32_t type, AssetLoader loader) {
+        std::lock_guard lock(m_Mutex);
+        m_Loaders[type] = std::move(loader);
+    }
+
+    std::future<AssetGroupStats> AssetGroupLoader::load(const std::filesystem::path& path) {
+        auto group  = std::make_shared<GroupLoad>();
+        group->path = path;
+        auto future = group->promise.get_future();
+
+        {
+            std::lock_guard lock(m_Mutex);
+            group->loaders = m_Loaders;
+            m_Queue.push_back(std::move(group));
+        }
+        m_Condition.notify_one();
+
+        return future;
+    }
+
+    void AssetGroupLoader::io_main() {
+        while (true) {
+            std::shared_ptr<GroupLoad> group;
+            {
+                std::unique_lock lock(m_Mutex);
+                m_Condition.wait(lock, [this] { return m_Stopping || !m_Queue.empty(); });
+                // Groups which were already requested still get loaded, someone is waiting on them.
+                if (m_Queue.empty()) { return; }
+
+                group = std::move(m_Queue.front());
+                m_Queue.pop_front();
+            }
+
+            read_group(group);
+        }
+    }
+
+    void AssetGroupLoader::read_group(const std::shared_ptr<GroupLoad>& group) const {
+        group->start = clock::now();
+
+        std::vector<ArchiveEntry> entries;
+        std::size_t               next        = 0;
+        bool                      dispatching = false;
+        try {
+            const SequentialFile file(group->path);
+
+            ArchiveHeader header{};
+            file.read(0, reinterpret_cast<std::byte*>(&header), sizeof(header));
+            if (header.magic != ARCHIVE_MAGIC || header.version != ARCHIVE_VERSION || header.payload_offset > header.file_size) {
+                throw std::runtime_error("Invalid asset group " + group->path.string());
+            }
+
+            entries.resize(header.entry_count);
+            file.read(header.table_offset, reinterpret_cast<std::byte*>(entries.data()), entries.size() * sizeof(ArchiveEntry));
+
+            // File order rather than table order: that's the order the bytes arrive in.
+            std::ranges::sort(entries, {}, &ArchiveEntry::offset);
+            for (const auto& entry : entries) {
+                if (entry.offset < header.payload_offset || entry.offset + entry.compressed_size > header.file_size) {
+                    throw std::runtime_error("Invalid asset group " + group->path.string() + ": payload is out of bounds");
+                }
+            }
+
+            group->stats.asset_count = static_cast<uint32_t>(entries.size());
+            group->remaining.fetch_add(static_cast<uint32_t>(entries.size()));
+            dispatching = true;
+
+            while (next < entries.size()) {
+                // The assets which end within one read of where the first starts share a buffer. A larger asset gets one of its own.
+                const uint64_t begin = entries[next].offset;
+                uint64_t       end   = begin + entries[next].compressed_size;
+                std::size_t    last  = next + 1;
+                for (; last < entries.size() && entries[last].offset + entries[last].compressed_size - begin <= m_Settings.read_size; last++) {
+                    end = std::max(end, entries[last].offset + entries[last].compressed_size);
+                }
+
+                const auto size = static_cast<std::size_t>(end - begin);
+                group->reserve_buffer(size, m_Settings.max_buffered);
+                const std::shared_ptr<std::byte[]> buffer(new std::byte[size], [group, size](const std::byte* data) {
+                    delete[] data;
+                    group->release_buffer(size);
+                });
+
+                for (uint64_t read = 0; read < size;) {
+                    const std::size_t chunk = static_cast<std::size_t>(std::min<uint64_t>(m_Settings.read_size, size - read));
+                    file.prefetch(begin + read + chunk, m_Settings.read_size);
+                    file.read(begin + read, buffer.get() + read, chunk);
+                    read += chunk;
+                }
+                group->stats.bytes_read += size;
+
+                // These can start loading while we read the next ones.
+                for (; next < last; next++) {
+                    const auto& entry = entries[next];
+                    dispatch(group, entry, buffer, {buffer.get() + (entry.offset - begin), entry.compressed_size});
+                }
+            }
+
+            group->stats.read_time = clock::now() - group->start;
+        } catch (...) {
+            group->set_error(std::current_exception());
+            // The assets that were never dispatched won't finish on their own.
+            if (dispatching && next < entries.size()) { finish(group, static_cast<uint32_t>(entries.size() - next)); }
+        }
+
+        finish(group, 1);
+    }
+
+    void AssetGroupLoader::dispatch(
+      const std::shared_ptr<GroupLoad>&  group,
+      const ArchiveEntry&                entry,
+      std::shared_ptr<const std::byte[]> buffer,
+      const std::span<const std::byte>   data
+    ) {
+        const auto loader = group->loaders.find(entry.type);
+        if (loader == group->loaders.end()) {
+            group->skipped.fetch_add(1, std::memory_order_relaxed);
+            finish(group, 1);
+            return;
+        }
+
+        auto job = [group, entry, buffer = std::move(buffer), data, &fn = loader->second]() mutable {
+            try {
+                fn(entry, data);
+            } catch (...) { group->set_error(std::current_exception()); }
+            // Its memory goes as soon as the last loader reading from it is done, not with the group.
+            buffer.reset();
+
+            if (!group->any_loaded.exchange(true)) { group->stats.time_to_first_asset = clock::now() - group->start; }
+            finish(group, 1);
+        };
+
+        if (global::g_JobSystem) {
+            global::g_JobSystem->submit(std::move(job));
+        } else {
+            job();
+        }
+    }
+
+    void AssetGroupLoader::finish(const std::shared_ptr<GroupLoad>& group, const uint32_t count) {
+        if (group->remaining.fetch_sub(count, std::memory_order_acq_rel) != count) { return; }
+
+        group->stats.skipped_count = group->skipped.load(std::memory_order_relaxed);
+        group->stats.total_time    = clock::now() - group->start;
+
+        if (group->error) {
+            group->promise.set_exception(group->error);
+        } else {
+            group->promise.set_value(group->stats);
+        }
+    }
+} // namespace vke::res
@@ -0,0 +1,96 @@
+//
+// Created by andy on 3/27/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/resource/archive.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace vke::res {
+
+    /**
+     * Called on the job system with the stored (possibly compressed) bytes of one asset, which are only valid for the duration of the call. Loaders
+     * get the contents with `read_entry`, straight into wherever the asset should end up.
+     */
+    using AssetLoader = std::function<void(const ArchiveEntry& entry, std::span<const std::byte> data)>;
+
+    struct AssetGroupStats {
+        uint64_t                      bytes_read    = 0;
+        uint32_t                      asset_count   = 0;
+        uint32_t                      skipped_count = 0; // assets without a loader for their type
+        std::chrono::duration<double> read_time{};           // until the last byte of the group was read
+        std::chrono::duration<double> time_to_first_asset{}; // until the first loader finished
+        std::chrono::duration<double> total_time{};          // until every loader finished
+
+        [[nodiscard]] inline double megabytes_per_second() const noexcept {
+            return read_time.count() > 0.0 ? static_cast<double>(bytes_read) / (1024.0 * 1024.0) / read_time.count() : 0.0;
+        }
+    };
+
+    /**
+     * Loads asset groups: archives whose payloads are stored in the order they should be loaded.
+     *
+     * Instead of seeking to each resource, a dedicated I/O thread reads the table once and then streams the payload region front to back in large
+     * reads (with the OS asked to read ahead). As soon as the last byte of an asset has arrived, the asset is handed to the loader registered for its
+     * type on the job system, so decoding overlaps with the rest of the group being read. Groups are read one at a time, in the order they are
+     * requested, to keep the disk access sequential.
+     *
+     * Assets which fit in one read share its buffer, larger ones get their own. A buffer is freed once the loaders of its assets have returned,
+     * and reading stops while `max_buffered` bytes are waiting for their loaders, so a group takes as much memory as the loaders let pile up
+     * rather than its whole size.
+     */
+    class VKE_API AssetGroupLoader {
+      public:
+        struct Settings {
+            std::size_t read_size    = 4 * 1024 * 1024;   // bytes per read call
+            std::size_t max_buffered = 256 * 1024 * 1024; // read, but not loaded yet. One larger asset is still read on its own.
+        };
+
+        explicit AssetGroupLoader(const Settings& settings);
+        ~AssetGroupLoader();
+
+        AssetGroupLoader(const AssetGroupLoader&)            = delete;
+        AssetGroupLoader& operator=(const AssetGroupLoader&) = delete;
+
+        // Applies to groups requested afterwards.
+        void register_loader(uint32_t type, AssetLoader loader);
+
+        // Resolves once every asset in the group has been loaded, or with the first exception thrown while reading or loading.
+        [[nodiscard]] std::future<AssetGroupStats> load(const std::filesystem::path& path);
+
+      private:
+        struct GroupLoad;
+
+        void io_main();
+        void read_group(const std::shared_ptr<GroupLoad>& group) const;
+
+        static void dispatch(
+          const std::shared_ptr<GroupLoad>&  group,
+          const ArchiveEntry&                entry,
+          std::shared_ptr<const std::byte[]> buffer,
+          std::span<const std::byte>         data
+        );
+        static void finish(const std::shared_ptr<GroupLoad>& group, uint32_t count);
+
+        Settings m_Settings;
+
+        std::unordered_map<uint32_t, AssetLoader> m_Loaders;
+        std::deque<std::shared_ptr<GroupLoad>>    m_Queue;
+        std::mutex                                m_Mutex;
+        std::condition_variable                   m_Condition;
+        bool                                      m_Stopping = false;
+        std::thread                               m_IoThread;
+    };
+
+} // namespace vke::res
@@ -0,0 +1,162 @@
+//
+// Created by andy on 3/28/2025.
+//
+
+#include "compression.hpp"
+
+#include "vke/global.hpp"
+#include "vke/utils/job_system.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
+
+namespace vke::res {
+    namespace {
+        struct ChunkHeader {
+            uint32_t chunk_size;
+            uint32_t chunk_count;
+        };
+
+        struct ZstdContextDeleter {
+            void operator()(ZSTD_DCtx* context) const noexcept { ZSTD_freeDCtx(context); }
+        };
+
+        // Creating a context per chunk is expensive, so every worker keeps its own.
+        ZSTD_DCtx* zstd_context() {
+            thread_local std::unique_ptr<ZSTD_DCtx, ZstdContextDeleter> context(ZSTD_createDCtx());
+            return context.get();
+        }
+
+        std::size_t compress_bound(const ArchiveCompression compression, const std::size_t size) {
+            switch (compression) {
+            case ArchiveCompression::Lz4:  return static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(size)));
+            case ArchiveCompression::Zstd: return ZSTD_compressBound(size);
+            default:                       throw std::invalid_argument("Unknown compression");
+            }
+        }
+
+        // The compressed size, or 0 if it didn't fit.
+        std::size_t compress_chunk(const CompressionPolicy& policy, const std::span<const std::byte> source, std::byte* destination, const std::size_t capacity) {
+            const auto src = reinterpret_cast<const char*>(source.data());
+            const auto dst = reinterpret_cast<char*>(destination);
+
+            switch (policy.compression) {
+            case ArchiveCompression::Lz4: {
+                const int size = policy.level > 0 ? LZ4_compress_HC(src, dst, static_cast<int>(source.size()), static_cast<int>(capacity), policy.level)
+                                                  : LZ4_compress_default(src, dst, static_cast<int>(source.size()), static_cast<int>(capacity));
+                return size > 0 ? static_cast<std::size_t>(size) : 0;
+            }
+            case ArchiveCompression::Zstd: {
+                const std::size_t size = ZSTD_compress(dst, capacity, src, source.size(), policy.level != 0 ? policy.level : ZSTD_CLEVEL_DEFAULT);
+                return ZSTD_isError(size) ? 0 : size;
+            }
+            default: throw std::invalid_argument("Unknown compression");
+            }
+        }
+
+        bool decompress_chunk(const ArchiveCompression compression, const std::span<const std::byte> source, const std::span<std::byte> destination) {
+            const auto src = reinterpret_cast<const char*>(source.data());
+            const auto dst = reinterpret_cast<char*>(destination.data());
+
+            switch (compression) {
+            case ArchiveCompression::Lz4:
+                return LZ4_decompress_safe(src, dst, static_cast<int>(source.size()), static_cast<int>(destination.size())) ==
+                       static_cast<int>(destination.size());
+            case ArchiveCompression::Zstd: {
+                const std::size_t size = ZSTD_decompressDCtx(zstd_context(), dst, destination.size(), src, source.size());
+                return !ZSTD_isError(size) && size == destination.size();
+            }
+            default: return false;
+            }
+        }
+    } // namespace
+
+    std::vector<std::byte> compress(const std::span<const std::byte> data, const CompressionPolicy& policy) {
+        if (policy.compression == ArchiveCompression::None || data.empty()) { return {}; }
+        if (data.size() > UINT32_MAX * static_cast<uint64_t>(COMPRESSION_CHUNK_SIZE)) { throw std::length_error("Resource is too large to compress"); }
+
+        const auto        chunk_count = static_cast<uint32_t>((data.size() + COMPRESSION_CHUNK_SIZE - 1) / COMPRESSION_CHUNK_SIZE);
+        const std::size_t table_size  = sizeof(ChunkHeader) + chunk_count * sizeof(uint32_t);
+
+        std::vector<std::byte> out(table_size + chunk_count * compress_bound(policy.compression, COMPRESSION_CHUNK_SIZE));
+        std::vector<uint32_t>  sizes(chunk_count);
+
+        std::size_t cursor = table_size;
+        for (uint32_t i = 0; i < chunk_count; i++) {
+            const std::size_t first = static_cast<std::size_t>(i) * COMPRESSION_CHUNK_SIZE;
+            const auto        chunk = data.subspan(first, std::min<std::size_t>(COMPRESSION_CHUNK_SIZE, data.size() - first));
+            const std::size_t size  = compress_chunk(policy, chunk, out.data() + cursor, out.size() - cursor);
+            if (size == 0) { return {}; }
+
+            sizes[i] = static_cast<uint32_t>(size);
+            cursor += size;
+        }
+
+        // Not worth paying for decompression.
+        if (cursor >= data.size()) { return {}; }
+
+        const ChunkHeader header{COMPRESSION_CHUNK_SIZE, chunk_count};
+        std::memcpy(out.data(), &header, sizeof(header));
+        std::memcpy(out.data() + sizeof(header), sizes.data(), sizes.size() * sizeof(uint32_t));
+        out.resize(cursor);
+        return out;
+    }
+
+    void decompress(const ArchiveCompression compression, const std::span<const std::byte> source, const std::span<std::byte> destination) {
+        ChunkHeader header{};
+        if (source.size() < sizeof(header)) { throw std::runtime_error("Compressed resource is corrupt"); }
+        std::memcpy(&header, source.data(), sizeof(header));
+
+        const std::size_t table_size = sizeof(ChunkHeader) + static_cast<std::size_t>(header.chunk_count) * sizeof(uint32_t);
+        if (header.chunk_size == 0 || header.chunk_count != (destination.size() + header.chunk_size - 1) / header.chunk_size || table_size > source.size()) {
+            throw std::runtime_error("Compressed resource is corrupt");
+        }
+
+        // Chunk offsets into the source (the table can't be used in place, it isn't necessarily aligned).
+        std::vector<std::size_t> offsets(header.chunk_count + 1);
+        offsets[0] = table_size;
+        for (uint32_t i = 0; i < header.chunk_count; i++) {
+            uint32_t size;
+            std::memcpy(&size, source.data() + sizeof(ChunkHeader) + i * sizeof(uint32_t), sizeof(size));
+            offsets[i + 1] = offsets[i] + size;
+        }
+        if (offsets.back() > source.size()) { throw std::runtime_error("Compressed resource is corrupt"); }
+
+        std::atomic<bool> failed = false;
+        const auto        decompress_chunks = [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t i = begin; i < end && !failed.load(std::memory_order_relaxed); i++) {
+                const std::size_t first = i * header.chunk_size;
+                const auto        chunk = destination.subspan(first, std::min<std::size_t>(header.chunk_size, destination.size() - first));
+                if (!decompress_chunk(compression, source.subspan(offsets[i], offsets[i + 1] - offsets[i]), chunk)) {
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        if (header.chunk_count > 1 && global::g_JobSystem) {
+            global::g_JobSystem->parallel_for(header.chunk_count, 1, decompress_chunks);
+        } else {
+            decompress_chunks(0, header.chunk_count);
+        }
+
+        if (failed.load()) { throw std::runtime_error("Compressed resource is corrupt"); }
+    }
+
+    void read_entry(const ArchiveEntry& entry, const std::span<const std::byte> stored, const std::span<std::byte> destination) {
+        if (destination.size() != entry.size) { throw std::invalid_argument("Destination doesn't match the size of the resource"); }
+
+        if (entry.compression() == ArchiveCompression::None) {
+            if (stored.size() != entry.size) { throw std::runtime_error("Resource is corrupt"); }
+            std::ranges::copy(stored, destination.begin());
+        } else {
+            decompress(entry.compression(), stored, destination);
+        }
+    }
+} // namespace vke::res
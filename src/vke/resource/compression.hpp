@@ -0,0 +1,39 @@
+//
+// Created by andy on 3/28/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/resource/archive.hpp"
+
+/**
+ * Compressed payloads are split into independently compressed chunks, so a single large asset can be decompressed by several workers at once:
+ *
+ *      uint32_t chunk_size;              // uncompressed bytes per chunk, the last chunk holds the remainder
+ *      uint32_t chunk_count;
+ *      uint32_t compressed_sizes[chunk_count];
+ *      ...chunk data, back to back
+ */
+namespace vke::res {
+    constexpr uint32_t COMPRESSION_CHUNK_SIZE = 256 * 1024;
+
+    /**
+     * Returns the compressed chunk stream, or an empty vector if the policy is None or compressing wouldn't make the data smaller.
+     */
+    VKE_API std::vector<std::byte> compress(std::span<const std::byte> data, const CompressionPolicy& policy);
+
+    /**
+     * Decompresses a chunk stream into `destination`, which must be exactly the uncompressed size. When there is more than one chunk they are spread
+     * over the job system (the calling thread helps). Throws std::runtime_error if the stream is corrupt.
+     */
+    VKE_API void decompress(ArchiveCompression compression, std::span<const std::byte> source, std::span<std::byte> destination);
+
+    /**
+     * Gets the contents of an entry into `destination` from its stored bytes (as handed to an AssetLoader), decompressing if needed. This is the only
+     * copy: `destination` can be a staging buffer or the final resource memory.
+     */
+    VKE_API void read_entry(const ArchiveEntry& entry, std::span<const std::byte> stored, std::span<std::byte> destination);
+
+} // namespace vke::res
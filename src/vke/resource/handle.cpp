@@ -0,0 +1,57 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#include "handle.hpp"
+
+namespace vke::res {
+    ResourceSlotMap::~ResourceSlotMap() {
+        for (const auto chunk : m_Chunks) {
+            delete[] chunk;
+        }
+    }
+
+    ResourceSlot ResourceSlotMap::insert(Resource* resource) {
+        const auto pointer = reinterpret_cast<uint64_t>(resource);
+        VKE_ASSERT(resource != nullptr && (pointer & ~POINTER_MASK) == 0, "Resource pointers must fit in 48 bits");
+
+        std::lock_guard lock(m_Mutex);
+
+        uint32_t index;
+        if (!m_Free.empty()) {
+            index = m_Free.back();
+            m_Free.pop_back();
+        } else {
+            if (m_Size == CHUNK_SIZE * MAX_CHUNKS) { throw std::length_error("Too many loaded resources"); }
+
+            index = m_Size++;
+            if (index % CHUNK_SIZE == 0) {
+                // New slots start at generation 1, so they never match a default constructed handle.
+                auto chunk = new std::atomic<uint64_t>[CHUNK_SIZE];
+                for (uint32_t i = 0; i < CHUNK_SIZE; i++) { chunk[i].store(uint64_t{1} << 48, std::memory_order_relaxed); }
+                m_Chunks[index / CHUNK_SIZE] = chunk;
+            }
+        }
+
+        auto&          slot       = m_Chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+        const uint64_t generation = slot.load(std::memory_order_relaxed) >> 48;
+        slot.store(generation << 48 | pointer, std::memory_order_release);
+        return ResourceSlot{index, static_cast<uint16_t>(generation)};
+    }
+
+    void ResourceSlotMap::remove(const ResourceSlot slot) {
+        if (slot.index >= CHUNK_SIZE * MAX_CHUNKS) { return; }
+
+        std::lock_guard lock(m_Mutex);
+        if (slot.index >= m_Size) { return; }
+
+        auto&          word    = m_Chunks[slot.index / CHUNK_SIZE][slot.index % CHUNK_SIZE];
+        const uint64_t current = word.load(std::memory_order_relaxed);
+        if (current >> 48 != slot.generation || (current & POINTER_MASK) == 0) { return; }
+
+        // Generation 0 is never handed out, so a wrapped slot stays empty for good.
+        const auto next = static_cast<uint16_t>(slot.generation + 1);
+        word.store(static_cast<uint64_t>(next) << 48, std::memory_order_release);
+        if (next != 0) { m_Free.push_back(slot.index); }
+    }
+} // namespace vke::res
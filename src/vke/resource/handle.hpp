@@ -0,0 +1,117 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/global.hpp"
+#include "vke/resource/resource.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace vke::res {
+
+    /**
+     * Maps handles to loaded resources without hashing or locking.
+     *
+     * Every slot is a single atomic word holding a 16 bit generation and a 48 bit pointer, so resolving a handle is one atomic load and a compare.
+     * Removing a resource bumps its slot's generation, which makes every handle to it stale. Slots live in fixed size chunks which are never moved
+     * or freed while the map exists, so handles can be resolved while other threads insert. A slot whose generation would wrap is retired instead
+     * of reused, so stale handles can never alias a newer resource.
+     *
+     * The pointer returned by resolve() is only valid while the resource stays loaded. Don't keep it past the frame it was resolved in.
+     */
+    class VKE_API ResourceSlotMap {
+      public:
+        static constexpr uint32_t CHUNK_SIZE   = 4096;
+        static constexpr uint32_t MAX_CHUNKS   = 1024;
+        static constexpr uint64_t POINTER_MASK = (uint64_t{1} << 48) - 1;
+
+        ResourceSlotMap() = default;
+        ~ResourceSlotMap();
+
+        ResourceSlotMap(const ResourceSlotMap&)            = delete;
+        ResourceSlotMap& operator=(const ResourceSlotMap&) = delete;
+
+        // Throws std::length_error once every slot is in use.
+        ResourceSlot insert(Resource* resource);
+        // Does nothing if the slot is already stale.
+        void         remove(ResourceSlot slot);
+
+        [[nodiscard]] inline Resource* resolve(const uint32_t index, const uint16_t generation) const noexcept {
+            // Also rejects default constructed handles, whose index is out of range.
+            const uint32_t chunk = index / CHUNK_SIZE;
+            if (chunk >= MAX_CHUNKS) { return nullptr; }
+
+            const uint64_t word = m_Chunks[chunk][index % CHUNK_SIZE].load(std::memory_order_acquire);
+            return word >> 48 == generation ? reinterpret_cast<Resource*>(word & POINTER_MASK) : nullptr;
+        }
+
+      private:
+        // Chunks are only ever added (under the lock) before a handle to one of their slots exists, so reading the array doesn't need to be atomic.
+        std::atomic<uint64_t>* m_Chunks[MAX_CHUNKS] = {};
+        std::mutex             m_Mutex;
+        std::vector<uint32_t>  m_Free;
+        uint32_t               m_Size = 0;
+    };
+
+    /**
+     * A typed reference to a loaded resource. Resolving it is a single atomic load. Once the resource is unloaded the handle resolves to nullptr,
+     * even if the slot has been reused since.
+     */
+    template<typename T>
+    class ResourceHandle {
+        static_assert(std::is_base_of_v<Resource, T>, "ResourceHandle can only refer to resources");
+
+      public:
+        ResourceHandle() = default;
+
+        // The resource must be loaded through the ResourceGraph, otherwise the handle is invalid from the start.
+        explicit ResourceHandle(const T& resource) noexcept : m_Index(resource.slot().index), m_Generation(resource.slot().generation) {}
+
+        [[nodiscard]] inline T* get() const noexcept { return static_cast<T*>(global::g_ResourceSlots.resolve(m_Index, m_Generation)); }
+        [[nodiscard]] inline bool is_loaded() const noexcept { return get() != nullptr; }
+
+        [[nodiscard]] inline uint32_t index() const noexcept { return m_Index; }
+        [[nodiscard]] inline uint16_t generation() const noexcept { return m_Generation; }
+
+        inline bool operator==(const ResourceHandle&) const noexcept = default;
+
+      private:
+        uint32_t m_Index      = UINT32_MAX;
+        uint16_t m_Generation = 0;
+    };
+
+    /**
+     * A reference to a permanent resource. Permanent resources are only unloaded during cleanup, so this holds the pointer directly and resolving it
+     * is free.
+     */
+    template<typename T>
+    class PermanentResourceHandle {
+        static_assert(std::is_base_of_v<Resource, T>, "PermanentResourceHandle can only refer to resources");
+
+      public:
+        PermanentResourceHandle() = default;
+
+        // Throws std::invalid_argument if the resource isn't permanent.
+        explicit PermanentResourceHandle(T& resource) : m_Resource(&resource) {
+            if (!resource.is_permanent()) { throw std::invalid_argument("PermanentResourceHandle needs a permanent resource"); }
+        }
+
+        [[nodiscard]] inline T* get() const noexcept { return m_Resource; }
+        inline T*               operator->() const noexcept { return m_Resource; }
+        inline T&               operator*() const noexcept { return *m_Resource; }
+
+        inline bool operator==(const PermanentResourceHandle&) const noexcept = default;
+
+      private:
+        T* m_Resource = nullptr;
+    };
+
+} // namespace vke::res
@@ -0,0 +1,200 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#include "hot_reload.hpp"
+
+#include "vke/global.hpp"
+#include "vke/lifecycle.hpp"
+#include "vke/utils/job_system.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace vke::res {
+    // The watcher reports absolute paths, but modules may have been loaded through relative ones or symlinks.
+    static std::filesystem::path normalize(const std::filesystem::path& path) {
+        std::error_code error;
+        auto            canonical = std::filesystem::weakly_canonical(path, error);
+        return error ? std::filesystem::absolute(path) : canonical;
+    }
+
+    HotReloader::HotReloader(const Settings& settings) : m_Settings(settings), m_Device(global::g_Device) {
+        register_listener(lifecycle::pre_render, lifecycle::pre_render.append([this] { apply(); }));
+        m_Watcher = std::make_unique<FileWatcher>(
+          FileWatcher::Settings{m_Settings.roots, m_Settings.debounce}, [this](const std::span<const std::filesystem::path> paths) { changed(paths); }
+        );
+    }
+
+    HotReloader::~HotReloader() {
+        m_Watcher.reset();
+        {
+            std::unique_lock lock(m_Mutex);
+            m_Idle.wait(lock, [this] { return m_Jobs == 0; });
+        }
+
+        // Whatever was built but never swapped in was never used.
+        for (const auto& batch : m_Pending) {
+            for (const auto& shader : batch.shaders) { m_Device->destroy(shader.handle); }
+            for (const auto& pipeline : batch.pipelines) { m_Device->destroy(pipeline.handle); }
+        }
+    }
+
+    void HotReloader::watch(const std::shared_ptr<ShaderModule>& shader_module) {
+        if (shader_module->path().empty()) { throw std::invalid_argument("Only shader modules loaded from a file can be hot reloaded"); }
+
+        std::lock_guard lock(m_Mutex);
+        m_Shaders[normalize(shader_module->path())] = shader_module;
+    }
+
+    void HotReloader::watch(const std::filesystem::path& path, AssetReloader reloader) {
+        std::lock_guard lock(m_Mutex);
+        m_Assets[normalize(path)] = std::move(reloader);
+    }
+
+    void HotReloader::changed(const std::span<const std::filesystem::path> paths) {
+        std::vector<std::pair<std::filesystem::path, std::shared_ptr<ShaderModule>>> shaders;
+        std::vector<std::pair<std::filesystem::path, AssetReloader>>                 assets;
+        {
+            std::lock_guard lock(m_Mutex);
+            for (const auto& changed_path : paths) {
+                const auto path = normalize(changed_path);
+
+                if (const auto shader = m_Shaders.find(path); shader != m_Shaders.end()) {
+                    if (auto shader_module = shader->second.lock()) {
+                        shaders.emplace_back(path, std::move(shader_module));
+                    } else {
+                        m_Shaders.erase(shader);
+                    }
+                }
+
+                if (const auto asset = m_Assets.find(path); asset != m_Assets.end()) { assets.emplace_back(path, asset->second); }
+            }
+
+            m_Jobs += static_cast<uint32_t>(assets.size()) + (shaders.empty() ? 0 : 1);
+        }
+
+        // All shaders which changed together are rebuilt together, so a pipeline whose vertex and fragment shaders were both saved is built once.
+        if (!shaders.empty()) {
+            dispatch([this, shaders = std::move(shaders)] { rebuild_shaders(shaders); });
+        }
+        for (auto& [path, reloader] : assets) {
+            dispatch([this, path = std::move(path), reloader = std::move(reloader)] { reload_asset(path, reloader); });
+        }
+    }
+
+    void HotReloader::rebuild_shaders(const std::vector<std::pair<std::filesystem::path, std::shared_ptr<ShaderModule>>>& shaders) {
+        std::lock_guard build(m_BuildMutex);
+        Batch           batch;
+
+        for (const auto& [path, shader_module] : shaders) {
+            try {
+                const auto                 code = ShaderModule::read_code(path);
+                vk::ShaderModuleCreateInfo create_info{};
+                create_info.setCode(code);
+
+                const auto handle = m_Device->handle().createShaderModule(create_info);
+                batch.shaders.push_back({shader_module, handle});
+                batch.reloaded.push_back(path);
+                m_Unapplied[shader_module.get()] = handle;
+            } catch (const std::exception& e) { batch.failed.emplace_back(path, e.what()); }
+        }
+
+        // Modules from earlier reloads which haven't been swapped in yet count too, otherwise this build would undo them.
+        std::vector<GraphicsPipeline::ShaderOverride> overrides;
+        overrides.reserve(m_Unapplied.size());
+        for (const auto& [shader_module, handle] : m_Unapplied) { overrides.push_back({shader_module, handle}); }
+
+        // Only the pipelines built from a changed module, each once. Their settings are copied under the module's lock: a pipeline removes itself
+        // from its modules (under that lock) before it is destroyed.
+        std::vector<std::pair<PipelineSwap, GraphicsPipeline::Settings>> rebuilds;
+        for (const auto& [shader_module, handle] : batch.shaders) {
+            std::lock_guard users(shader_module->m_UsersMutex);
+            for (GraphicsPipeline* pipeline : shader_module->m_Users) {
+                const bool seen = std::ranges::any_of(rebuilds, [pipeline](const auto& rebuild) { return rebuild.first.pipeline == pipeline; });
+                if (seen) { continue; }
+
+                rebuilds.emplace_back(PipelineSwap{shader_module, pipeline, pipeline->sort_id(), nullptr}, pipeline->settings());
+            }
+        }
+
+        for (auto& [swap, settings] : rebuilds) {
+            try {
+                swap.handle = GraphicsPipeline::create_pipeline(settings, overrides);
+                batch.pipelines.push_back(std::move(swap));
+            } catch (const std::exception& e) { batch.failed.emplace_back(swap.via->path(), e.what()); }
+        }
+
+        queue(std::move(batch));
+    }
+
+    void HotReloader::reload_asset(const std::filesystem::path& path, const AssetReloader& reloader) {
+        Batch batch;
+        try {
+            if (auto commit = reloader(path)) { batch.commits.push_back(std::move(commit)); }
+            batch.reloaded.push_back(path);
+        } catch (const std::exception& e) { batch.failed.emplace_back(path, e.what()); }
+
+        queue(std::move(batch));
+    }
+
+    void HotReloader::apply() {
+        std::unique_lock build(m_BuildMutex, std::try_to_lock);
+        if (!build.owns_lock()) { return; }
+
+        std::vector<Batch> batches;
+        {
+            std::lock_guard lock(m_Mutex);
+            batches.swap(m_Pending);
+        }
+
+        for (auto& batch : batches) {
+            for (const auto& [shader_module, handle] : batch.shaders) {
+                m_Device->defer_destroy(shader_module->m_ShaderModule);
+                shader_module->m_ShaderModule = handle;
+
+                if (const auto it = m_Unapplied.find(shader_module.get()); it != m_Unapplied.end() && it->second == handle) { m_Unapplied.erase(it); }
+            }
+
+            for (const auto& [via, pipeline, sort_id, handle] : batch.pipelines) {
+                std::lock_guard users(via->m_UsersMutex);
+                // The sort id catches a new pipeline which happens to live at the same address as a destroyed one.
+                const bool alive = std::ranges::find(via->m_Users, pipeline) != via->m_Users.end() && pipeline->sort_id() == sort_id;
+                if (!alive) {
+                    m_Device->destroy(handle);
+                    continue;
+                }
+
+                m_Device->defer_destroy(pipeline->m_Pipeline);
+                pipeline->m_Pipeline = handle;
+            }
+        }
+        build.unlock();
+
+        for (auto& batch : batches) {
+            for (const auto& commit : batch.commits) { commit(); }
+            for (const auto& path : batch.reloaded) { on_reloaded(path); }
+            for (const auto& [path, error] : batch.failed) { on_reload_failed(path, error); }
+        }
+    }
+
+    void HotReloader::dispatch(std::function<void()> job) {
+        auto run = [this, job = std::move(job)] {
+            job();
+
+            std::lock_guard lock(m_Mutex);
+            if (--m_Jobs == 0) { m_Idle.notify_all(); }
+        };
+
+        if (global::g_JobSystem) {
+            global::g_JobSystem->submit(std::move(run));
+        } else {
+            run();
+        }
+    }
+
+    void HotReloader::queue(Batch batch) {
+        std::lock_guard lock(m_Mutex);
+        m_Pending.push_back(std::move(batch));
+    }
+} // namespace vke::res
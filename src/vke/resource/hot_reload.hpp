@@ -0,0 +1,106 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/renderer/graphics_pipeline.hpp"
+#include "vke/renderer/shader_module.hpp"
+#include "vke/utils/file_watcher.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vke::res {
+
+    // Loads a changed asset on a worker thread and returns what swaps the result in at the next frame boundary (which may be empty).
+    using AssetReloader = std::function<std::function<void()>(const std::filesystem::path& path)>;
+
+    /**
+     * Reloads shaders and other assets when their files change on disk, without stalling the frame loop.
+     *
+     * Changed SPIR-V is turned into a new shader module on a worker, which then rebuilds only the graphics pipelines built from that module (every
+     * other pipeline is left alone). The new modules and pipelines are swapped in together at the start of a frame (lifecycle::pre_render), so a
+     * frame never sees half a reload. The replaced handles go to Device::defer_destroy, since frames in flight may still be using them.
+     *
+     * If a build is still running when a frame starts, its results simply wait for the next frame.
+     */
+    class VKE_API HotReloader : public ScopedSlotSubscriber {
+      public:
+        struct Settings {
+            std::vector<std::filesystem::path> roots;
+            std::chrono::milliseconds          debounce{100};
+        };
+
+        explicit HotReloader(const Settings& settings);
+        ~HotReloader() override;
+
+        HotReloader(const HotReloader&)            = delete;
+        HotReloader& operator=(const HotReloader&) = delete;
+
+        // The module must have been loaded from a file (ShaderModule::load). Throws std::invalid_argument otherwise.
+        void watch(const std::shared_ptr<ShaderModule>& shader_module);
+        void watch(const std::filesystem::path& path, AssetReloader reloader);
+
+        // Both are emitted on the main thread, at the frame boundary where the reload is swapped in.
+        Signal<void(const std::filesystem::path&)>                     on_reloaded;
+        Signal<void(const std::filesystem::path&, const std::string&)> on_reload_failed;
+
+      private:
+        struct ShaderSwap {
+            std::shared_ptr<ShaderModule> shader_module;
+            vk::ShaderModule              handle;
+        };
+
+        struct PipelineSwap {
+            std::shared_ptr<ShaderModule> via; // the pipeline is only alive as long as it is one of this module's users
+            GraphicsPipeline*             pipeline;
+            uint32_t                      sort_id;
+            vk::Pipeline                  handle;
+        };
+
+        struct Batch {
+            std::vector<ShaderSwap>                                    shaders;
+            std::vector<PipelineSwap>                                  pipelines;
+            std::vector<std::function<void()>>                         commits;
+            std::vector<std::filesystem::path>                         reloaded;
+            std::vector<std::pair<std::filesystem::path, std::string>> failed;
+        };
+
+        void changed(std::span<const std::filesystem::path> paths);
+        void rebuild_shaders(const std::vector<std::pair<std::filesystem::path, std::shared_ptr<ShaderModule>>>& shaders);
+        void reload_asset(const std::filesystem::path& path, const AssetReloader& reloader);
+        void apply();
+
+        void dispatch(std::function<void()> job);
+        void queue(Batch batch);
+
+        Settings                m_Settings;
+        std::shared_ptr<Device> m_Device;
+
+        std::mutex                                                   m_Mutex;
+        std::condition_variable                                      m_Idle;
+        uint32_t                                                     m_Jobs = 0;
+        std::map<std::filesystem::path, std::weak_ptr<ShaderModule>> m_Shaders;
+        std::map<std::filesystem::path, AssetReloader>               m_Assets;
+        std::vector<Batch>                                           m_Pending;
+
+        // Held by builds, and by the swap (which only tries), so a build never reads a module handle while it is being replaced.
+        std::mutex                                                m_BuildMutex;
+        std::unordered_map<const ShaderModule*, vk::ShaderModule> m_Unapplied; // built, but not swapped in yet
+
+        std::unique_ptr<FileWatcher> m_Watcher;
+    };
+
+} // namespace vke::res
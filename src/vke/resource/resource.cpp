@@ -6,5 +6,58 @@
 
 namespace vke {
 namespace res {
+    Resource::Resource(const uint64_t marker_id, const ResourceHeader& header) : m_MarkerId(marker_id), m_Header(header) {}
+
+    bool Resource::allow_auto_unload() const noexcept { return m_Header.allow_auto_unload; }
+
+    bool Resource::allow_as_child() const noexcept { return m_Header.allow_as_child; }
+
+    bool Resource::allow_children() const noexcept { return m_Header.allow_children; }
+
+    bool Resource::is_static() const noexcept { return m_Header.is_static; }
+
+    bool Resource::is_permanent() const noexcept { return m_Header.is_permanent; }
+
+    // Pin propagation walks up the graph iteratively with a per-thread stack, so pinning doesn't allocate once the stack has grown.
+    static std::vector<Resource*>& pin_stack() {
+        thread_local std::vector<Resource*> stack = [] {
+            std::vector<Resource*> v;
+            v.reserve(64);
+            return v;
+        }();
+        return stack;
+    }
+
+    void Resource::pin() noexcept {
+        // Only the first pin is passed on to the parents.
+        if (m_Pins.fetch_add(1, std::memory_order_acq_rel) != 0 || m_Parents.empty()) { return; }
+
+        auto& stack = pin_stack();
+        for (const auto& parent : m_Parents) { stack.push_back(parent.get()); }
+        while (!stack.empty()) {
+            Resource* resource = stack.back();
+            stack.pop_back();
+            if (resource->m_Pins.fetch_add(1, std::memory_order_acq_rel) == 0) {
+                for (const auto& parent : resource->m_Parents) { stack.push_back(parent.get()); }
+            }
+        }
+    }
+
+    void Resource::unpin() noexcept {
+        VKE_ASSERT(m_Pins.load(std::memory_order_relaxed) > 0, "Unpinning a resource which isn't pinned");
+        if (m_Pins.fetch_sub(1, std::memory_order_acq_rel) != 1 || m_Parents.empty()) { return; }
+
+        auto& stack = pin_stack();
+        for (const auto& parent : m_Parents) { stack.push_back(parent.get()); }
+        while (!stack.empty()) {
+            Resource* resource = stack.back();
+            stack.pop_back();
+            if (resource->m_Pins.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                for (const auto& parent : resource->m_Parents) { stack.push_back(parent.get()); }
+            }
+        }
+    }
+
+    bool Resource::is_evictable() const noexcept { return allow_auto_unload() && !is_permanent() && !is_pinned(); }
 } // res
 } // vke
\ No newline at end of file
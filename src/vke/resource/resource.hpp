@@ -4,8 +4,14 @@
 
 #pragma once
 
+#include "vke/pre.hpp"
+
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
+#include <memory>
+#include <span>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 
 /**
@@ -85,13 +91,13 @@ namespace vke::res {
         bool is_permanent : 1;
 
         /**
-         * Does the system need to preserve this resource unless it is manually cleaned up?
+         * Can the cache unload this resource when it isn't being used enough?
          *
          * This is extremely important, and mainly is used for non-asset resources (for example, a render target).
          * The resource system is great for managing resources, since it can help to maintain lifetimes and safety.
          * However, generally the system will use a blend of an LFU and an LRU cache to hold onto resources, and will then unload them if they aren't
-         * used enough. Setting this flag prevents them from being managed by the cache, instead keeping them in storage until they are manually
-         * unloaded and cleaned up (or at the application lifecycle stage which their resource scope is required to clean them up at).
+         * used enough (see ResourceCache). Clearing this flag prevents them from being managed by the cache, instead keeping them in storage until they
+         * are manually unloaded and cleaned up (or at the application lifecycle stage which their resource scope is required to clean them up at).
          *
          * This should also be used for resources which are in active use. While the cache *shouldn't* unload them if the system parameters are right,
          * you probably don't want to be reloading your scene from disk every frame (in the case of something wrong happening that makes it the least
@@ -114,9 +120,22 @@ namespace vke::res {
                                // to properly convert this to the right type.
     };
 
-    class Resource {
+    // Where a loaded resource lives in the resource slot map (see ResourceHandle). The default value is never a valid slot.
+    struct ResourceSlot {
+        uint32_t index      = UINT32_MAX;
+        uint16_t generation = 0;
+    };
+
+    /**
+     * Base class for everything managed by the resource system. Subclasses report how much memory they hold so the cache can keep within its budgets.
+     */
+    class VKE_API Resource {
       public:
-        Resource();
+        Resource(uint64_t marker_id, const ResourceHeader& header);
+        virtual ~Resource() = default;
+
+        Resource(const Resource&)            = delete;
+        Resource& operator=(const Resource&) = delete;
 
         bool allow_auto_unload() const noexcept;
         bool allow_as_child() const noexcept;
@@ -124,7 +143,35 @@ namespace vke::res {
         bool is_static() const noexcept;
         bool is_permanent() const noexcept;
 
+        [[nodiscard]] inline uint64_t              marker_id() const noexcept { return m_MarkerId; }
+        [[nodiscard]] inline const ResourceHeader& header() const noexcept { return m_Header; }
+
+        [[nodiscard]] virtual std::size_t cpu_size() const noexcept { return 0; }
+        [[nodiscard]] virtual std::size_t gpu_size() const noexcept { return 0; }
+
+        // Pinned resources are in active use and are never evicted, whatever the cache thinks of them. A pinned resource holds one pin on each of its
+        // parents, so everything it depends on stays loaded too.
+        void                      pin() noexcept;
+        void                      unpin() noexcept;
+        [[nodiscard]] inline bool is_pinned() const noexcept { return m_Pins.load(std::memory_order_acquire) != 0; }
+
+        // The resources this one depends on. Set by the ResourceGraph before the resource is handed out, and never changed afterwards.
+        [[nodiscard]] inline std::span<const std::shared_ptr<Resource>> parents() const noexcept { return m_Parents; }
+
+        // Set by the ResourceGraph while the resource is loaded.
+        [[nodiscard]] inline ResourceSlot slot() const noexcept { return m_Slot; }
+
+        // Can the cache evict this resource right now?
+        [[nodiscard]] bool is_evictable() const noexcept;
+
       private:
+        friend class ResourceGraph;
+
+        uint64_t                               m_MarkerId;
+        ResourceHeader                         m_Header;
+        std::atomic<uint32_t>                  m_Pins = 0;
+        std::vector<std::shared_ptr<Resource>> m_Parents; // children keep their parents alive
+        ResourceSlot                           m_Slot;
     };
 
 } // namespace vke::res
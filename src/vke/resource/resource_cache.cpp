@@ -0,0 +1,309 @@
+//
+// Created by andy on 3/28/2025.
+//
+
+#include "resource_cache.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace vke::res {
+    static uint64_t mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    ResourceCache::FrequencySketch::FrequencySketch(const uint32_t width) {
+        const uint32_t row_width = std::bit_ceil(std::max(width, 64u));
+        m_Counters.resize(static_cast<std::size_t>(row_width) * DEPTH);
+        m_Mask       = row_width - 1;
+        m_SampleSize = row_width * 10;
+    }
+
+    std::size_t ResourceCache::FrequencySketch::index(const uint64_t key, const uint32_t row) const noexcept {
+        return static_cast<std::size_t>(row) * (m_Mask + 1) + (mix(key + row * 0x632BE59BD9B4E019ull) & m_Mask);
+    }
+
+    void ResourceCache::FrequencySketch::increment(const uint64_t key) noexcept {
+        for (uint32_t row = 0; row < DEPTH; row++) {
+            uint8_t& counter = m_Counters[index(key, row)];
+            if (counter < 15) { counter++; }
+        }
+
+        // Aging: halve everything once in a while so resources which were popular a long time ago don't stay in forever.
+        if (++m_Additions >= m_SampleSize) {
+            for (auto& counter : m_Counters) {
+                counter >>= 1;
+            }
+            m_Additions /= 2;
+        }
+    }
+
+    uint32_t ResourceCache::FrequencySketch::frequency(const uint64_t key) const noexcept {
+        uint32_t frequency = 15;
+        for (uint32_t row = 0; row < DEPTH; row++) {
+            frequency = std::min<uint32_t>(frequency, m_Counters[index(key, row)]);
+        }
+        return frequency;
+    }
+
+    ResourceCache::ResourceCache(const Settings& settings) : m_Settings(settings), m_Sketch(settings.sketch_width) {}
+
+    ResourceCache::~ResourceCache() = default;
+
+    void ResourceCache::insert(const std::shared_ptr<Resource>& resource) {
+        VKE_ASSERT(resource != nullptr, "Can't cache a null resource");
+
+        std::vector<std::shared_ptr<Resource>> evicted;
+        std::shared_ptr<Resource>              replaced;
+        {
+            std::lock_guard lock(m_Mutex);
+
+            const uint64_t marker_id = resource->marker_id();
+            m_Sketch.increment(marker_id);
+
+            // A replaced resource starts over in the window, but keeps its frequency.
+            if (const auto it = m_Entries.find(marker_id); it != m_Entries.end()) {
+                account(it->second, false);
+                segment_list(it->second.segment).erase(it->second.position);
+                replaced = std::move(it->second.resource);
+                m_Entries.erase(it);
+            }
+
+            const bool managed = resource->allow_auto_unload() && !resource->is_permanent();
+            const auto segment = managed ? Segment::Window : Segment::Unmanaged;
+            auto&      list    = segment_list(segment);
+            list.push_front(marker_id);
+
+            const Entry entry{
+              .resource = resource,
+              .cpu_size = resource->cpu_size(),
+              .gpu_size = resource->gpu_size(),
+              .segment  = segment,
+              .position = list.begin(),
+            };
+            account(entry, true);
+            m_Entries.emplace(marker_id, entry);
+
+            maintain(evicted);
+        }
+        notify(evicted);
+    }
+
+    std::shared_ptr<Resource> ResourceCache::find(const uint64_t marker_id) {
+        std::lock_guard lock(m_Mutex);
+
+        // Misses count towards the frequency too, so something that keeps getting requested gets admitted once it is loaded again.
+        m_Sketch.increment(marker_id);
+
+        const auto it = m_Entries.find(marker_id);
+        if (it == m_Entries.end()) {
+            m_Misses++;
+            return nullptr;
+        }
+
+        m_Hits++;
+        touch(it->second);
+        return it->second.resource;
+    }
+
+    std::shared_ptr<Resource> ResourceCache::remove(const uint64_t marker_id) {
+        std::lock_guard lock(m_Mutex);
+
+        const auto it = m_Entries.find(marker_id);
+        if (it == m_Entries.end()) { return nullptr; }
+
+        account(it->second, false);
+        segment_list(it->second.segment).erase(it->second.position);
+        auto resource = std::move(it->second.resource);
+        m_Entries.erase(it);
+        return resource;
+    }
+
+    void ResourceCache::update_size(const uint64_t marker_id) {
+        std::vector<std::shared_ptr<Resource>> evicted;
+        {
+            std::lock_guard lock(m_Mutex);
+
+            const auto it = m_Entries.find(marker_id);
+            if (it == m_Entries.end()) { return; }
+
+            account(it->second, false);
+            it->second.cpu_size = it->second.resource->cpu_size();
+            it->second.gpu_size = it->second.resource->gpu_size();
+            account(it->second, true);
+
+            maintain(evicted);
+        }
+        notify(evicted);
+    }
+
+    void ResourceCache::set_budgets(const uint64_t cpu_budget, const uint64_t gpu_budget) {
+        std::vector<std::shared_ptr<Resource>> evicted;
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Settings.cpu_budget = cpu_budget;
+            m_Settings.gpu_budget = gpu_budget;
+            maintain(evicted);
+        }
+        notify(evicted);
+    }
+
+    void ResourceCache::trim() {
+        std::vector<std::shared_ptr<Resource>> evicted;
+        {
+            std::lock_guard lock(m_Mutex);
+            maintain(evicted);
+        }
+        notify(evicted);
+    }
+
+    void ResourceCache::clear() {
+        std::vector<std::shared_ptr<Resource>> resources;
+        {
+            std::lock_guard lock(m_Mutex);
+
+            resources.reserve(m_Entries.size());
+            for (auto& [marker_id, entry] : m_Entries) {
+                resources.push_back(std::move(entry.resource));
+            }
+
+            m_Entries.clear();
+            m_Window.clear();
+            m_Probation.clear();
+            m_Protected.clear();
+            m_Unmanaged.clear();
+            m_CpuBytes = m_GpuBytes = m_WindowBytes = m_ProtectedBytes = 0;
+        }
+        // The resources are destroyed here, outside of the lock.
+    }
+
+    ResourceCache::Stats ResourceCache::stats() const {
+        std::lock_guard lock(m_Mutex);
+        return Stats{
+          .hits      = m_Hits,
+          .misses    = m_Misses,
+          .evictions = m_Evictions,
+          .cpu_bytes = m_CpuBytes,
+          .gpu_bytes = m_GpuBytes,
+          .resident  = m_Entries.size(),
+        };
+    }
+
+    void ResourceCache::reset_counters() {
+        std::lock_guard lock(m_Mutex);
+        m_Hits = m_Misses = m_Evictions = 0;
+    }
+
+    std::list<uint64_t>& ResourceCache::segment_list(const Segment segment) noexcept {
+        switch (segment) {
+        case Segment::Window:    return m_Window;
+        case Segment::Probation: return m_Probation;
+        case Segment::Protected: return m_Protected;
+        default:                 return m_Unmanaged;
+        }
+    }
+
+    const std::list<uint64_t>& ResourceCache::segment_list(const Segment segment) const noexcept {
+        return const_cast<ResourceCache*>(this)->segment_list(segment);
+    }
+
+    void ResourceCache::account(const Entry& entry, const bool add) noexcept {
+        const auto apply = [add](uint64_t& total, const uint64_t amount) { total = add ? total + amount : total - amount; };
+
+        apply(m_CpuBytes, entry.cpu_size);
+        apply(m_GpuBytes, entry.gpu_size);
+        if (entry.segment == Segment::Window) { apply(m_WindowBytes, entry.cost()); }
+        if (entry.segment == Segment::Protected) { apply(m_ProtectedBytes, entry.cost()); }
+    }
+
+    void ResourceCache::move_to(Entry& entry, const Segment segment) {
+        account(entry, false);
+        auto& from = segment_list(entry.segment);
+        auto& to   = segment_list(segment);
+        to.splice(to.begin(), from, entry.position);
+        entry.segment = segment;
+        account(entry, true);
+    }
+
+    void ResourceCache::touch(Entry& entry) {
+        if (entry.segment != Segment::Probation) {
+            auto& list = segment_list(entry.segment);
+            list.splice(list.begin(), list, entry.position);
+            return;
+        }
+
+        // A second use while on probation earns a place in the protected segment, pushing its least recently used resources back to probation.
+        move_to(entry, Segment::Protected);
+        while (m_ProtectedBytes > protected_capacity() && m_Protected.size() > 1) {
+            move_to(m_Entries.at(m_Protected.back()), Segment::Probation);
+        }
+    }
+
+    std::optional<uint64_t> ResourceCache::eviction_candidate(const Segment segment) const {
+        const auto& list = segment_list(segment);
+        for (auto it = list.rbegin(); it != list.rend(); ++it) {
+            if (m_Entries.at(*it).resource->is_evictable()) { return *it; }
+        }
+        return std::nullopt;
+    }
+
+    void ResourceCache::maintain(std::vector<std::shared_ptr<Resource>>& evicted) {
+        // Resources falling out of the window try to get into the main cache. If there isn't room, whichever of them and the main cache's victim
+        // is used less often goes.
+        while (m_WindowBytes > window_capacity() && !m_Window.empty()) {
+            const uint64_t candidate = m_Window.back();
+            move_to(m_Entries.at(candidate), Segment::Probation);
+            if (!over_budget()) { continue; }
+
+            const auto victim = eviction_candidate(Segment::Probation);
+            if (!victim) { continue; }
+
+            if (*victim != candidate && m_Sketch.frequency(candidate) > m_Sketch.frequency(*victim)) {
+                evict(*victim, evicted);
+            } else if (m_Entries.at(candidate).resource->is_evictable()) {
+                evict(candidate, evicted);
+            } else {
+                evict(*victim, evicted);
+            }
+        }
+
+        while (over_budget()) {
+            auto victim = eviction_candidate(Segment::Probation);
+            if (!victim) { victim = eviction_candidate(Segment::Window); }
+            if (!victim) { victim = eviction_candidate(Segment::Protected); }
+            // Everything left is pinned or unmanaged.
+            if (!victim) { break; }
+
+            evict(*victim, evicted);
+        }
+    }
+
+    void ResourceCache::evict(const uint64_t marker_id, std::vector<std::shared_ptr<Resource>>& evicted) {
+        const auto it = m_Entries.find(marker_id);
+        account(it->second, false);
+        segment_list(it->second.segment).erase(it->second.position);
+        evicted.push_back(std::move(it->second.resource));
+        m_Entries.erase(it);
+        m_Evictions++;
+    }
+
+    void ResourceCache::notify(std::vector<std::shared_ptr<Resource>>& evicted) {
+        for (const auto& resource : evicted) {
+            on_evict(resource);
+        }
+        evicted.clear();
+    }
+
+    // The segments are sized by combined CPU + GPU bytes, while the budgets themselves are enforced separately.
+    uint64_t ResourceCache::window_capacity() const noexcept {
+        return static_cast<uint64_t>(static_cast<double>(m_Settings.cpu_budget + m_Settings.gpu_budget) * m_Settings.window_fraction);
+    }
+
+    uint64_t ResourceCache::protected_capacity() const noexcept {
+        const uint64_t main = m_Settings.cpu_budget + m_Settings.gpu_budget - window_capacity();
+        return static_cast<uint64_t>(static_cast<double>(main) * m_Settings.protected_fraction);
+    }
+} // namespace vke::res
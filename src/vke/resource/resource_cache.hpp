@@ -0,0 +1,152 @@
+//
+// Created by andy on 3/28/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/resource/resource.hpp"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace vke::res {
+
+    /**
+     * Holds loaded resources within CPU and GPU memory budgets, evicting the ones least worth keeping.
+     *
+     * The policy is W-TinyLFU: new resources enter a small LRU window, and only move into the main cache (a segmented LRU with a probation and a
+     * protected segment) if they have been used more often than the resource they would push out, according to a count-min sketch of recent access
+     * frequencies. The window catches bursts of recently used resources, the sketch keeps one-off loads (a level's worth of assets streamed past once)
+     * from flushing out the resources which are used all the time.
+     *
+     * Resources which don't allow auto-unloading, permanent resources and pinned resources are never evicted, but still count towards the budgets.
+     * All functions are thread safe.
+     */
+    class VKE_API ResourceCache {
+      public:
+        struct Settings {
+            uint64_t cpu_budget; // bytes
+            uint64_t gpu_budget; // bytes
+            float    window_fraction    = 0.01f; // of the total budget
+            float    protected_fraction = 0.8f;  // of the main cache
+            uint32_t sketch_width       = 4096;  // counters per row of the frequency sketch, rounded up to a power of two
+        };
+
+        struct Stats {
+            uint64_t    hits      = 0;
+            uint64_t    misses    = 0;
+            uint64_t    evictions = 0;
+            uint64_t    cpu_bytes = 0;
+            uint64_t    gpu_bytes = 0;
+            std::size_t resident  = 0;
+
+            [[nodiscard]] inline double hit_rate() const noexcept {
+                return hits + misses > 0 ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0;
+            }
+        };
+
+        explicit ResourceCache(const Settings& settings);
+        ~ResourceCache();
+
+        ResourceCache(const ResourceCache&)            = delete;
+        ResourceCache& operator=(const ResourceCache&) = delete;
+
+        // Adds a freshly loaded resource (replacing one with the same marker id) and evicts whatever no longer fits.
+        void insert(const std::shared_ptr<Resource>& resource);
+
+        // Counts as a use of the resource. nullptr (and a miss) if it isn't resident.
+        [[nodiscard]] std::shared_ptr<Resource> find(uint64_t marker_id);
+
+        // Takes a resource out of the cache without counting it as an eviction.
+        std::shared_ptr<Resource> remove(uint64_t marker_id);
+
+        // Re-reads the sizes of a resource whose memory use changed (for example a texture which streamed in more mips).
+        void update_size(uint64_t marker_id);
+
+        void set_budgets(uint64_t cpu_budget, uint64_t gpu_budget);
+
+        // Evicts until the budgets are met or nothing else can be evicted (resources which were pinned may have been unpinned since).
+        void trim();
+
+        // Drops every resource, evictable or not.
+        void clear();
+
+        [[nodiscard]] Stats stats() const;
+        void                reset_counters();
+
+        // Called (outside of the cache's lock, on whichever thread caused the eviction) for every resource the cache evicts.
+        ConcurrentSignal<void(const std::shared_ptr<Resource>&)> on_evict;
+
+      private:
+        // Resources which can never be evicted (permanent, or not allowed to auto-unload) are kept in Unmanaged, so eviction doesn't have to walk
+        // past them.
+        enum class Segment : uint8_t { Window, Probation, Protected, Unmanaged };
+
+        struct Entry {
+            std::shared_ptr<Resource>     resource;
+            uint64_t                      cpu_size;
+            uint64_t                      gpu_size;
+            Segment                       segment;
+            std::list<uint64_t>::iterator position;
+
+            [[nodiscard]] inline uint64_t cost() const noexcept { return cpu_size + gpu_size; }
+        };
+
+        // Count-min sketch with 4 bit counters (stored in bytes) which are halved every 10 * width increments, so old popularity fades.
+        class FrequencySketch {
+          public:
+            explicit FrequencySketch(uint32_t width);
+
+            void                   increment(uint64_t key) noexcept;
+            [[nodiscard]] uint32_t frequency(uint64_t key) const noexcept;
+
+          private:
+            static constexpr uint32_t DEPTH = 4;
+
+            [[nodiscard]] std::size_t index(uint64_t key, uint32_t row) const noexcept;
+
+            std::vector<uint8_t> m_Counters;
+            uint32_t             m_Mask;
+            uint32_t             m_Additions = 0;
+            uint32_t             m_SampleSize;
+        };
+
+        [[nodiscard]] std::list<uint64_t>&       segment_list(Segment segment) noexcept;
+        [[nodiscard]] const std::list<uint64_t>& segment_list(Segment segment) const noexcept;
+
+        void account(const Entry& entry, bool add) noexcept;
+        void touch(Entry& entry);
+        void move_to(Entry& entry, Segment segment);
+        void maintain(std::vector<std::shared_ptr<Resource>>& evicted);
+        void evict(uint64_t marker_id, std::vector<std::shared_ptr<Resource>>& evicted);
+        void notify(std::vector<std::shared_ptr<Resource>>& evicted);
+
+        // The least recently used entry of a segment that can be evicted right now, if any.
+        [[nodiscard]] std::optional<uint64_t> eviction_candidate(Segment segment) const;
+
+        [[nodiscard]] inline bool over_budget() const noexcept { return m_CpuBytes > m_Settings.cpu_budget || m_GpuBytes > m_Settings.gpu_budget; }
+        [[nodiscard]] uint64_t    window_capacity() const noexcept;
+        [[nodiscard]] uint64_t    protected_capacity() const noexcept;
+
+        Settings                            m_Settings;
+        mutable std::mutex                  m_Mutex;
+        std::unordered_map<uint64_t, Entry> m_Entries;
+        std::list<uint64_t>                 m_Window, m_Probation, m_Protected, m_Unmanaged; // most recently used at the front
+        FrequencySketch                     m_Sketch;
+
+        uint64_t m_CpuBytes       = 0;
+        uint64_t m_GpuBytes       = 0;
+        uint64_t m_WindowBytes    = 0;
+        uint64_t m_ProtectedBytes = 0;
+        uint64_t m_Hits           = 0;
+        uint64_t m_Misses         = 0;
+        uint64_t m_Evictions      = 0;
+    };
+
+} // namespace vke::res
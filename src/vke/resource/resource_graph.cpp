@@ -0,0 +1,309 @@
+//
+// Created by andy on 3/29/2025.
+//
+
+#include "resource_graph.hpp"
+
+#include "vke/global.hpp"
+#include "vke/resource/handle.hpp"
+#include "vke/utils/job_system.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace vke::res {
+    using ResourcePromise = std::promise<std::shared_ptr<Resource>>;
+
+    enum class NodeState : uint8_t { Unloaded, Loading, Loaded };
+
+    struct ResourceGraph::Node {
+        uint64_t           marker_id;
+        ResourceHeader     header;
+        std::vector<Node*> parents;
+        std::vector<Node*> children;
+
+        NodeState state   = NodeState::Unloaded;
+        uint32_t  pending = 0; // parents which are still loading
+        uint64_t  visit   = 0;
+
+        std::shared_ptr<Resource>                     resource;
+        std::shared_ptr<ResourcePromise>              promise;
+        std::shared_future<std::shared_ptr<Resource>> future;
+    };
+
+    ResourceGraph::ResourceGraph(ResourceLoader loader) : m_Loader(std::move(loader)) {
+        if (!m_Loader) { throw std::invalid_argument("Resource graph needs a loader"); }
+    }
+
+    ResourceGraph::~ResourceGraph() {
+        // Loads in flight reference the nodes.
+        std::unique_lock lock(m_Mutex);
+        m_Idle.wait(lock, [this] { return m_InFlight == 0; });
+    }
+
+    void ResourceGraph::declare(const uint64_t marker_id, const ResourceHeader& header, const std::span<const uint64_t> parents) {
+        std::lock_guard lock(m_Mutex);
+        insert_node(marker_id, header, parents);
+    }
+
+    void ResourceGraph::add(const std::shared_ptr<Resource>& resource, const std::span<const uint64_t> parents) {
+        VKE_ASSERT(resource != nullptr, "Can't add a null resource");
+        VKE_ASSERT(!resource->is_pinned(), "Resources must be added to the graph before they are pinned");
+
+        std::lock_guard lock(m_Mutex);
+        for (const uint64_t parent : parents) {
+            const auto it = m_Nodes.find(parent);
+            if (it != m_Nodes.end() && it->second->state != NodeState::Loaded) {
+                throw std::invalid_argument("The parents of an added resource must be loaded");
+            }
+        }
+
+        Node& node = insert_node(resource->marker_id(), resource->header(), parents);
+
+        resource->m_Parents.clear();
+        for (const Node* parent : node.parents) { resource->m_Parents.push_back(parent->resource); }
+
+        resource->m_Slot = global::g_ResourceSlots.insert(resource.get());
+        node.resource    = resource;
+        node.state       = NodeState::Loaded;
+        node.promise     = std::make_shared<ResourcePromise>();
+        node.future      = node.promise->get_future().share();
+        node.promise->set_value(resource);
+    }
+
+    std::shared_future<std::shared_ptr<Resource>> ResourceGraph::load(const uint64_t marker_id) {
+        std::vector<Node*>                            ready;
+        std::shared_future<std::shared_ptr<Resource>> future;
+        {
+            std::lock_guard lock(m_Mutex);
+
+            Node& root = node(marker_id);
+            if (root.state != NodeState::Unloaded) { return root.future; }
+
+            // Everything above the resource which isn't loaded or loading yet starts loading too. Each node waits on the parents which aren't loaded,
+            // whether they are part of this load or an earlier one.
+            const uint64_t visit = ++m_Visit;
+            auto&          stack = walk_stack();
+            root.visit           = visit;
+            stack.push_back(&root);
+            while (!stack.empty()) {
+                Node* current = stack.back();
+                stack.pop_back();
+
+                current->state   = NodeState::Loading;
+                current->pending = 0;
+                current->promise = std::make_shared<ResourcePromise>();
+                current->future  = current->promise->get_future().share();
+
+                for (Node* parent : current->parents) {
+                    if (parent->state == NodeState::Loaded) { continue; }
+
+                    current->pending++;
+                    if (parent->state == NodeState::Unloaded && parent->visit != visit) {
+                        parent->visit = visit;
+                        stack.push_back(parent);
+                    }
+                }
+
+                if (current->pending == 0) { ready.push_back(current); }
+            }
+
+            m_InFlight += static_cast<uint32_t>(ready.size());
+            future = root.future;
+        }
+
+        for (Node* current : ready) { dispatch(current); }
+        return future;
+    }
+
+    void ResourceGraph::unload(const uint64_t marker_id) { unload(std::span(&marker_id, 1)); }
+
+    void ResourceGraph::unload(const std::span<const uint64_t> marker_ids) {
+        std::vector<std::shared_ptr<Resource>> released;
+        {
+            std::lock_guard lock(m_Mutex);
+            for (const uint64_t marker_id : marker_ids) { node(marker_id); }
+
+            // Post-order, so children are released before their parents. Descendants which aren't loaded can't have loaded children of their own.
+            const uint64_t visit = ++m_Visit;
+            auto&          stack = post_order_stack();
+            auto&          order = walk_stack();
+            for (const uint64_t marker_id : marker_ids) {
+                Node& root = node(marker_id);
+                if (root.state == NodeState::Unloaded || root.visit == visit) { continue; }
+
+                root.visit = visit;
+                stack.emplace_back(&root, 0);
+                while (!stack.empty()) {
+                    auto [current, next] = stack.back();
+                    if (next < current->children.size()) {
+                        stack.back().second++;
+
+                        Node* child = current->children[next];
+                        if (child->visit != visit && child->state != NodeState::Unloaded) {
+                            child->visit = visit;
+                            stack.emplace_back(child, 0);
+                        }
+                    } else {
+                        order.push_back(current);
+                        stack.pop_back();
+                    }
+                }
+            }
+
+            for (const Node* current : order) {
+                if (current->state == NodeState::Loading) {
+                    order.clear();
+                    throw std::runtime_error("Can't unload a resource while it or something depending on it is loading");
+                }
+                if (current->resource->is_pinned()) {
+                    order.clear();
+                    throw std::runtime_error("Can't unload a pinned resource");
+                }
+            }
+
+            released.reserve(order.size());
+            // Handles go stale before the resources are let go of.
+            for (Node* current : order) {
+                global::g_ResourceSlots.remove(current->resource->m_Slot);
+                current->resource->m_Slot = {};
+                released.push_back(std::move(current->resource));
+                current->state = NodeState::Unloaded;
+                current->promise.reset();
+                current->future = {};
+            }
+            order.clear();
+        }
+
+        for (const auto& resource : released) { on_unload(resource); }
+    }
+
+    std::shared_ptr<Resource> ResourceGraph::get(const uint64_t marker_id) const {
+        std::lock_guard lock(m_Mutex);
+
+        const auto it = m_Nodes.find(marker_id);
+        if (it == m_Nodes.end() || it->second->state != NodeState::Loaded) { return nullptr; }
+        return it->second->resource;
+    }
+
+    bool ResourceGraph::is_declared(const uint64_t marker_id) const {
+        std::lock_guard lock(m_Mutex);
+        return m_Nodes.contains(marker_id);
+    }
+
+    ResourceGraph::Node& ResourceGraph::node(const uint64_t marker_id) const {
+        const auto it = m_Nodes.find(marker_id);
+        if (it == m_Nodes.end()) { throw std::invalid_argument("Resource " + std::to_string(marker_id) + " isn't declared"); }
+        return *it->second;
+    }
+
+    ResourceGraph::Node& ResourceGraph::insert_node(const uint64_t marker_id, const ResourceHeader& header, const std::span<const uint64_t> parents) {
+        if (m_Nodes.contains(marker_id)) { throw std::invalid_argument("Resource " + std::to_string(marker_id) + " is already declared"); }
+        if (!parents.empty() && !header.allow_as_child) {
+            throw std::invalid_argument("Resource " + std::to_string(marker_id) + " isn't allowed to be a child resource");
+        }
+
+        auto node       = std::make_unique<Node>();
+        node->marker_id = marker_id;
+        node->header    = header;
+        node->parents.reserve(parents.size());
+        for (const uint64_t parent_id : parents) {
+            Node& parent = this->node(parent_id);
+            if (!parent.header.allow_children) {
+                throw std::invalid_argument("Resource " + std::to_string(parent_id) + " isn't allowed to have child resources");
+            }
+            node->parents.push_back(&parent);
+        }
+
+        for (Node* parent : node->parents) { parent->children.push_back(node.get()); }
+        return *m_Nodes.emplace(marker_id, std::move(node)).first->second;
+    }
+
+    std::vector<ResourceGraph::Node*>& ResourceGraph::walk_stack() {
+        thread_local std::vector<Node*> stack;
+        return stack;
+    }
+
+    std::vector<std::pair<ResourceGraph::Node*, std::size_t>>& ResourceGraph::post_order_stack() {
+        thread_local std::vector<std::pair<Node*, std::size_t>> stack;
+        return stack;
+    }
+
+    void ResourceGraph::dispatch(Node* node) {
+        if (global::g_JobSystem) {
+            global::g_JobSystem->submit([this, node] { run(node); });
+        } else {
+            run(node);
+        }
+    }
+
+    void ResourceGraph::run(Node* node) {
+        std::vector<std::shared_ptr<Resource>> parents;
+        {
+            // A node which is loading can't have its parents unloaded, so these are all still there.
+            std::lock_guard lock(m_Mutex);
+            parents.reserve(node->parents.size());
+            for (const Node* parent : node->parents) { parents.push_back(parent->resource); }
+        }
+
+        std::shared_ptr<Resource> resource;
+        std::exception_ptr        error;
+        try {
+            resource = m_Loader(node->marker_id, node->header);
+            if (!resource) { throw std::runtime_error("Loader didn't create resource " + std::to_string(node->marker_id)); }
+            if (resource->marker_id() != node->marker_id) {
+                throw std::runtime_error("Loader created the wrong resource for " + std::to_string(node->marker_id));
+            }
+            resource->m_Parents = std::move(parents);
+            resource->m_Slot    = global::g_ResourceSlots.insert(resource.get());
+        } catch (...) { error = std::current_exception(); }
+
+        std::vector<Node*>                            ready;
+        std::vector<std::shared_ptr<ResourcePromise>> failed;
+        std::shared_ptr<ResourcePromise>              promise;
+        {
+            std::lock_guard lock(m_Mutex);
+            if (error) {
+                fail(node, failed);
+            } else {
+                node->resource = resource;
+                node->state    = NodeState::Loaded;
+                promise        = node->promise;
+
+                for (Node* child : node->children) {
+                    if (child->state == NodeState::Loading && --child->pending == 0) { ready.push_back(child); }
+                }
+            }
+            m_InFlight += static_cast<uint32_t>(ready.size());
+        }
+
+        if (promise) { promise->set_value(resource); }
+        for (const auto& failed_promise : failed) { failed_promise->set_exception(error); }
+        for (Node* child : ready) { dispatch(child); }
+
+        {
+            std::lock_guard lock(m_Mutex);
+            if (--m_InFlight == 0) { m_Idle.notify_all(); }
+        }
+    }
+
+    void ResourceGraph::fail(Node* node, std::vector<std::shared_ptr<ResourcePromise>>& failed) {
+        // Whatever was waiting on this resource can't load either.
+        auto& stack = walk_stack();
+        stack.push_back(node);
+        while (!stack.empty()) {
+            Node* current = stack.back();
+            stack.pop_back();
+            if (current->state != NodeState::Loading) { continue; }
+
+            current->state = NodeState::Unloaded;
+            failed.push_back(std::move(current->promise));
+            current->future = {};
+
+            for (Node* child : current->children) {
+                if (child->state == NodeState::Loading) { stack.push_back(child); }
+            }
+        }
+    }
+} // namespace vke::res
@@ -0,0 +1,94 @@
+//
+// Created by andy on 3/29/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/resource/resource.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vke::res {
+
+    // Creates the resource for a marker id. Its parents are already loaded when this is called. Throwing fails the load.
+    using ResourceLoader = std::function<std::shared_ptr<Resource>(uint64_t marker_id, const ResourceHeader& header)>;
+
+    /**
+     * Tracks which resources depend on which, so that dependencies are loaded before (and stay loaded for as long as) the resources that need them.
+     *
+     * Resources are declared with their parents, which must have been declared first (so the graph can't have cycles), must allow children, and the
+     * child must allow being one. Loading a resource loads every parent which isn't loaded yet, with independent branches loading in parallel on
+     * the job system. Unloading a resource unloads all of its descendants first.
+     *
+     * Loaded resources hold shared pointers to their parents, and pinning a resource pins its parents (see Resource::pin), so a pinned resource's
+     * whole dependency chain stays resident and can't be unloaded.
+     */
+    class VKE_API ResourceGraph {
+      public:
+        explicit ResourceGraph(ResourceLoader loader);
+        ~ResourceGraph();
+
+        ResourceGraph(const ResourceGraph&)            = delete;
+        ResourceGraph& operator=(const ResourceGraph&) = delete;
+
+        // Throws std::invalid_argument if the resource is already declared, or a parent is unknown or the headers don't allow the relationship.
+        void declare(uint64_t marker_id, const ResourceHeader& header, std::span<const uint64_t> parents = {});
+
+        // Declares a resource which was created by code rather than a loader (a surface, for example). Its parents must be loaded.
+        void add(const std::shared_ptr<Resource>& resource, std::span<const uint64_t> parents = {});
+
+        // Loads the resource and any of its dependencies which aren't loaded yet. Loading something which is already loaded (or loading) is cheap.
+        std::shared_future<std::shared_ptr<Resource>> load(uint64_t marker_id);
+
+        /**
+         * Unloads the resource and everything which depends on it, children first. Does nothing if it isn't loaded. Throws std::runtime_error
+         * without unloading anything if any of them is pinned or still loading.
+         *
+         * The graph lets go of the resources; they are destroyed once nothing else holds them.
+         */
+        void unload(uint64_t marker_id);
+
+        // Unloads several resources (and their descendants) at once, with a single walk of the graph. Used to release whole scopes.
+        void unload(std::span<const uint64_t> marker_ids);
+
+        // nullptr if it isn't loaded.
+        [[nodiscard]] std::shared_ptr<Resource> get(uint64_t marker_id) const;
+        [[nodiscard]] bool                      is_declared(uint64_t marker_id) const;
+
+        // Called (outside of the graph's lock) for every resource unload() lets go of, children before their parents.
+        ConcurrentSignal<void(const std::shared_ptr<Resource>&)> on_unload;
+
+      private:
+        struct Node;
+
+        [[nodiscard]] Node& node(uint64_t marker_id) const;
+        Node&               insert_node(uint64_t marker_id, const ResourceHeader& header, std::span<const uint64_t> parents);
+
+        void dispatch(Node* node);
+        void run(Node* node);
+        void fail(Node* node, std::vector<std::shared_ptr<std::promise<std::shared_ptr<Resource>>>>& failed);
+
+        // Walks happen under the lock and never call into user code, so one stack per thread is enough, and it stops allocating once it has grown
+        // to the size of the graph.
+        static std::vector<Node*>&                         walk_stack();
+        static std::vector<std::pair<Node*, std::size_t>>& post_order_stack();
+
+        ResourceLoader                                       m_Loader;
+        mutable std::mutex                                   m_Mutex;
+        std::condition_variable                              m_Idle;
+        std::unordered_map<uint64_t, std::unique_ptr<Node>> m_Nodes;
+        uint64_t                                             m_Visit    = 0; // traversal stamp, so walks don't need a visited set
+        uint32_t                                             m_InFlight = 0; // nodes dispatched to the job system which haven't finished
+    };
+
+} // namespace vke::res
@@ -0,0 +1,188 @@
+//
+// Created by andy on 3/29/2025.
+//
+
+#include "scope.hpp"
+
+#include "vke/lifecycle.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace vke::res {
+    static bool is_ready(const std::shared_future<std::shared_ptr<Resource>>& future) {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    Scope::Settings Scope::image() {
+        return Settings{
+          .name     = "image",
+          .open_on  = &lifecycle::device_ready,
+          .close_on = &lifecycle::device_cleanup,
+        };
+    }
+
+    Scope::Scope(ResourceGraph& graph, const Settings& settings) : m_Graph(graph), m_Name(settings.name) {
+        if (m_Name.empty() || m_Name.size() >= MAX_RESOURCE_SCOPE_NAME_LENGTH) {
+            throw std::length_error("Resource scope names must be between 1 and " + std::to_string(MAX_RESOURCE_SCOPE_NAME_LENGTH - 1) + " characters");
+        }
+
+        if (settings.preload_on) { register_listener(*settings.preload_on, settings.preload_on->append([this] { preload(); })); }
+        if (settings.open_on) { register_listener(*settings.open_on, settings.open_on->append([this] { open(); })); }
+        if (settings.close_on) {
+            // Throwing would escape whatever emitted close_on (for the image scope, the device cleanup sequence). The scope keeps its resources,
+            // so closing can still be retried.
+            register_listener(*settings.close_on, settings.close_on->append([this] {
+                try {
+                    close();
+                } catch (const std::exception& e) { on_close_failed(e.what()); }
+            }));
+        }
+    }
+
+    Scope::~Scope() {
+        // A scope that is still open takes its resources with it. If that fails (something is still pinned), the resources stay in the graph.
+        try {
+            close();
+        } catch (...) {}
+    }
+
+    void Scope::add(const uint64_t marker_id) { add(std::span(&marker_id, 1)); }
+
+    void Scope::add(const std::span<const uint64_t> marker_ids) {
+        for (const uint64_t marker_id : marker_ids) {
+            if (!m_Graph.is_declared(marker_id)) {
+                throw std::invalid_argument("Resource " + std::to_string(marker_id) + " must be declared before adding it to scope " + m_Name);
+            }
+        }
+
+        std::vector<uint64_t> load;
+        {
+            std::lock_guard lock(m_Mutex);
+            for (const uint64_t marker_id : marker_ids) {
+                if (std::ranges::find(m_MarkerIds, marker_id) != m_MarkerIds.end()) { continue; }
+
+                m_MarkerIds.push_back(marker_id);
+                if (m_Loading) { load.push_back(marker_id); }
+            }
+        }
+
+        if (!load.empty()) { start_loading(std::move(load)); }
+    }
+
+    void Scope::preload() {
+        std::vector<uint64_t> load;
+        {
+            std::lock_guard lock(m_Mutex);
+            if (m_Loading) { return; }
+
+            m_Loading = true;
+            load      = m_MarkerIds;
+        }
+
+        start_loading(std::move(load));
+    }
+
+    void Scope::open() {
+        std::vector<uint64_t> load;
+        {
+            std::lock_guard lock(m_Mutex);
+            if (m_Open) { return; }
+
+            m_Open = true;
+            if (!m_Loading) {
+                m_Loading = true;
+                load      = m_MarkerIds;
+            }
+        }
+
+        if (!load.empty()) { start_loading(std::move(load)); }
+        on_open();
+    }
+
+    void Scope::close() {
+        std::vector<uint64_t>                                      marker_ids;
+        std::vector<std::shared_future<std::shared_ptr<Resource>>> loads;
+        bool                                                       was_open;
+        {
+            std::lock_guard lock(m_Mutex);
+            if (!m_Loading) { return; }
+
+            was_open  = m_Open;
+            m_Open    = false;
+            m_Loading = false;
+
+            marker_ids.reserve(m_Loads.size());
+            loads.reserve(m_Loads.size());
+            for (auto& [marker_id, future] : m_Loads) {
+                marker_ids.push_back(marker_id);
+                loads.push_back(std::move(future));
+            }
+            m_Loads.clear();
+        }
+
+        // Listeners get the chance to let go of (and unpin) the resources before they are released.
+        if (was_open) { on_close(); }
+
+        // The graph can't unload something which is still loading.
+        for (const auto& future : loads) { future.wait(); }
+        try {
+            m_Graph.unload(marker_ids);
+        } catch (...) {
+            // Nothing was unloaded: the scope keeps its loads, as if preloaded, so closing can be retried (and opening works again).
+            std::lock_guard lock(m_Mutex);
+            m_Loading = true;
+            for (std::size_t i = 0; i < marker_ids.size(); i++) { m_Loads.try_emplace(marker_ids[i], std::move(loads[i])); }
+            throw;
+        }
+    }
+
+    bool Scope::is_open() const {
+        std::lock_guard lock(m_Mutex);
+        return m_Open;
+    }
+
+    std::shared_ptr<Resource> Scope::get(const uint64_t marker_id) const {
+        std::shared_future<std::shared_ptr<Resource>> future;
+        {
+            std::lock_guard lock(m_Mutex);
+            if (!m_Open) { return nullptr; }
+
+            const auto it = m_Loads.find(marker_id);
+            if (it == m_Loads.end()) { return nullptr; }
+            future = it->second;
+        }
+
+        if (!is_ready(future)) { return nullptr; }
+        try {
+            return future.get();
+        } catch (...) { return nullptr; }
+    }
+
+    float Scope::progress() const {
+        std::lock_guard lock(m_Mutex);
+        if (m_MarkerIds.empty()) { return 1.0f; }
+
+        const auto finished = std::ranges::count_if(m_Loads, [](const auto& load) { return is_ready(load.second); });
+        return static_cast<float>(finished) / static_cast<float>(m_MarkerIds.size());
+    }
+
+    bool Scope::is_loaded() const {
+        std::lock_guard lock(m_Mutex);
+        return std::ranges::all_of(m_MarkerIds, [this](const uint64_t marker_id) {
+            const auto it = m_Loads.find(marker_id);
+            return it != m_Loads.end() && is_ready(it->second);
+        });
+    }
+
+    void Scope::start_loading(std::vector<uint64_t> marker_ids) {
+        // Loads run outside of the lock: without a job system the loaders run right here, and they might use the scope.
+        std::vector<std::shared_future<std::shared_ptr<Resource>>> loads;
+        loads.reserve(marker_ids.size());
+        for (const uint64_t marker_id : marker_ids) { loads.push_back(m_Graph.load(marker_id)); }
+
+        std::lock_guard lock(m_Mutex);
+        for (std::size_t i = 0; i < marker_ids.size(); i++) { m_Loads.try_emplace(marker_ids[i], std::move(loads[i])); }
+    }
+} // namespace vke::res
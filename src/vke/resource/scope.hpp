@@ -0,0 +1,90 @@
+//
+// Created by andy on 3/29/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include "vke/resource/resource_graph.hpp"
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vke::res {
+
+    /**
+     * A set of resources which share a lifetime, usually tied to lifecycle events (or a level).
+     *
+     * Preloading starts loading every resource of the scope in the background (through the resource graph, so on the job system) before the scope is
+     * needed. Opening never blocks: whatever was preloaded is available straight away, and anything that wasn't starts loading and becomes available
+     * when it is done. Closing releases all of the scope's resources from the graph in one go.
+     *
+     * A resource should only belong to one scope, since closing a scope unloads its resources from the graph.
+     */
+    class VKE_API Scope : public ScopedSlotSubscriber {
+      public:
+        struct Settings {
+            std::string     name;
+            Signal<void()>* preload_on = nullptr; // optional, starts loading in the background when emitted
+            Signal<void()>* open_on    = nullptr; // optional
+            Signal<void()>* close_on   = nullptr; // optional, failures are reported through on_close_failed instead of thrown
+        };
+
+        // The scope which holds loaded images. It opens at `lifecycle::device_ready` and closes at `lifecycle::device_cleanup`.
+        static Settings image();
+
+        Scope(ResourceGraph& graph, const Settings& settings);
+        ~Scope() override;
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        // The resources must be declared in the graph. Adding to an open (or preloading) scope starts loading them right away.
+        void add(uint64_t marker_id);
+        void add(std::span<const uint64_t> marker_ids);
+
+        // Starts loading everything in the background without opening the scope.
+        void preload();
+
+        // Makes the scope's resources available, starting any loads which haven't been started by preload(). Never waits for them.
+        void open();
+
+        // Waits for loads which are still running, then unloads every resource of the scope from the graph. If the graph refuses (a resource is
+        // pinned, or something depending on one is loading) it throws, and the scope is left closed but still holding its resources.
+        void close();
+
+        [[nodiscard]] bool is_open() const;
+
+        // nullptr if the scope isn't open, the resource isn't loaded (yet) or it isn't part of the scope.
+        [[nodiscard]] std::shared_ptr<Resource> get(uint64_t marker_id) const;
+
+        // Loads of the scope which have finished, for loading screens. Failed loads count as finished.
+        [[nodiscard]] float progress() const;
+        [[nodiscard]] bool  is_loaded() const;
+
+        [[nodiscard]] inline const std::string& name() const noexcept { return m_Name; }
+
+        Signal<void()>                   on_open;
+        Signal<void()>                   on_close;
+        Signal<void(const std::string&)> on_close_failed; // when closing at Settings::close_on fails, with the error
+
+      private:
+        void start_loading(std::vector<uint64_t> marker_ids);
+
+        ResourceGraph&     m_Graph;
+        std::string        m_Name;
+        mutable std::mutex m_Mutex;
+
+        std::vector<uint64_t>                                                       m_MarkerIds;
+        std::unordered_map<uint64_t, std::shared_future<std::shared_ptr<Resource>>> m_Loads;
+        bool                                                                        m_Loading = false; // preloading or open
+        bool                                                                        m_Open    = false;
+    };
+
+} // namespace vke::res
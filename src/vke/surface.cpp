@@ -8,7 +8,12 @@
 #include "lifecycle.hpp"
 #include "utils/utils.hpp"
 
+#include <algorithm>
+
 namespace vke {
+    // Long enough for any display to show a frame, short enough that a minimized window, which may never show one, doesn't stall the loop.
+    constexpr uint64_t PRESENT_WAIT_TIMEOUT = 100'000'000;
+
     static vk::SurfaceFormatKHR select_surface_format(const std::vector<vk::SurfaceFormatKHR>& formats) {
         for (const auto& format : formats) {
             if (format.format == vk::Format::eB8G8R8A8Srgb && format.colorSpace == vk::ColorSpaceKHR::eSrgbNonlinear) { return format; }
@@ -16,17 +21,34 @@ namespace vke {
         return formats[0];
     }
 
-    static vk::PresentModeKHR select_present_mode(const std::vector<vk::PresentModeKHR>& modes, const bool prefer_vsync = true) {
-        bool has_immediate = false;
-        for (const auto& mode : modes) {
-            if (mode == vk::PresentModeKHR::eMailbox) { return mode; }
-            if (mode == vk::PresentModeKHR::eImmediate) { has_immediate = true; }
+    static vk::PresentModeKHR select_present_mode(const std::vector<vk::PresentModeKHR>& modes, const PresentPolicy policy) {
+        const auto has = [&](const vk::PresentModeKHR mode) { return std::ranges::find(modes, mode) != modes.end(); };
+        switch (policy) {
+            case PresentPolicy::Latency:
+                if (has(vk::PresentModeKHR::eMailbox)) { return vk::PresentModeKHR::eMailbox; }
+                if (has(vk::PresentModeKHR::eImmediate)) { return vk::PresentModeKHR::eImmediate; }
+                break;
+            case PresentPolicy::Throughput:
+                if (has(vk::PresentModeKHR::eMailbox)) { return vk::PresentModeKHR::eMailbox; }
+                break;
+            case PresentPolicy::PowerSaving: break;
         }
-        if (!prefer_vsync && has_immediate) { return vk::PresentModeKHR::eImmediate; }
-        return vk::PresentModeKHR::eFifo;
+        return vk::PresentModeKHR::eFifo; // always supported
+    }
+
+    static uint32_t select_image_count(const vk::SurfaceCapabilitiesKHR& capabilities, const PresentPolicy policy) {
+        // One more than the minimum lets the next frame acquire an image while the display holds one and another is queued behind it.
+        uint32_t count = policy == PresentPolicy::PowerSaving ? std::max(capabilities.minImageCount, 2u) : capabilities.minImageCount + 1;
+        if (capabilities.maxImageCount > 0) { count = std::min(count, capabilities.maxImageCount); }
+        return count;
+    }
+
+    static uint32_t default_max_queued_frames(const PresentPolicy policy) {
+        return policy == PresentPolicy::Throughput ? 0 : 1;
     }
 
-    Surface::Surface(const std::shared_ptr<Device>& device, const std::shared_ptr<Window>& window) : m_Device(device), m_Window(window) {
+    Surface::Surface(const std::shared_ptr<Device>& device, const std::shared_ptr<Window>& window, const PresentPolicy present_policy)
+        : m_Device(device), m_Window(window), m_PresentPolicy(present_policy), m_MaxQueuedFrames(default_max_queued_frames(present_policy)) {
         // Create surface
         {
             vk::Win32SurfaceCreateInfoKHR create_info{};
@@ -36,6 +58,8 @@ namespace vke {
             m_Surface = m_Device->instance()->handle().createWin32SurfaceKHR(create_info);
         }
 
+        m_PresentWait = m_Device->has_extension(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+
         recreate_swapchain();
 
         register_listener(m_Window->on_resize, m_Window->on_resize.append([&](vk::Extent2D extent) { m_PendingRecreateSwapchain = true; }));
@@ -45,8 +69,9 @@ namespace vke {
     }
 
     Surface::~Surface() {
-        m_Device->destroy(m_Swapchain);
-        m_Device->destroy(m_Surface);
+        // Frames in flight may still be presenting to it. The surface has to outlive its swapchain.
+        m_Device->defer_destroy(m_Swapchain);
+        m_Device->defer([instance = m_Device->instance(), surface = m_Surface] { instance->destroy(surface); });
     }
 
     void Surface::recreate_swapchain() {
@@ -60,7 +85,7 @@ namespace vke {
             m_SwapchainConfiguration.format      = surface_format.format;
             m_SwapchainConfiguration.color_space = surface_format.colorSpace;
 
-            m_SwapchainConfiguration.present_mode = select_present_mode(present_modes);
+            m_SwapchainConfiguration.present_mode = select_present_mode(present_modes, m_PresentPolicy);
 
             m_SwapchainConfiguration.extent = surface_capabilities.currentExtent;
             if (m_SwapchainConfiguration.extent.height == UINT32_MAX) {
@@ -69,10 +94,7 @@ namespace vke {
                 );
             }
 
-            m_SwapchainConfiguration.min_image_count = surface_capabilities.minImageCount + 1;
-            if (surface_capabilities.maxImageCount > 0 && m_SwapchainConfiguration.min_image_count > surface_capabilities.maxImageCount) {
-                m_SwapchainConfiguration.min_image_count = surface_capabilities.maxImageCount;
-            }
+            m_SwapchainConfiguration.min_image_count = select_image_count(surface_capabilities, m_PresentPolicy);
 
             m_SwapchainConfiguration.pre_transform = surface_capabilities.currentTransform;
         }
@@ -94,17 +116,34 @@ namespace vke {
 
         m_Swapchain = m_Device->handle().createSwapchainKHR(create_info);
         m_Images    = m_Device->handle().getSwapchainImagesKHR(m_Swapchain);
+        m_PresentId = 0;
         on_images_changed(m_Images);
 
         if (create_info.oldSwapchain) {
             // only fire this when actually recreating the swapchain, but not when we first create it.
             on_recreate_swapchain(m_Swapchain, m_SwapchainConfiguration);
-            m_Device->destroy(create_info.oldSwapchain);
+            // Retired rather than destroyed: frames still in flight were rendered to its images and may not have been presented yet.
+            m_Device->defer_destroy(create_info.oldSwapchain);
         }
 
         m_PendingRecreateSwapchain = false;
     }
 
+    void Surface::set_present_policy(const PresentPolicy policy) {
+        m_PresentPolicy            = policy;
+        m_MaxQueuedFrames          = default_max_queued_frames(policy);
+        m_PendingRecreateSwapchain = true;
+    }
+
+    void Surface::wait_for_present(const uint64_t present_id) {
+        try {
+            const auto result = m_Device->handle().waitForPresentKHR(m_Swapchain, present_id, PRESENT_WAIT_TIMEOUT);
+            if (result == vk::Result::eSuboptimalKHR) { m_PendingRecreateSwapchain = true; }
+        } catch (vk::OutOfDateKHRError& e) {
+            m_PendingRecreateSwapchain = true;
+        }
+    }
+
     ImageProperties Surface::get_image_properties() {
         return ImageProperties{
           {m_SwapchainConfiguration.extent.width, m_SwapchainConfiguration.extent.height, 1},
@@ -122,6 +161,10 @@ namespace vke {
     }
 
     std::tuple<vk::Image, uint32_t, bool> Surface::next_image(const vk::Semaphore read_start_semaphore) {
+        // The frame about to be rendered starts no earlier than the display catching up: everything it reads (input above all) is as fresh
+        // as it can be when it is shown.
+        if (m_PresentWait && m_MaxQueuedFrames > 0 && m_PresentId > m_MaxQueuedFrames) { wait_for_present(m_PresentId - m_MaxQueuedFrames); }
+
         try {
             const auto ir = m_Device->handle().acquireNextImageKHR(m_Swapchain, UINT64_MAX, read_start_semaphore);
             if (ir.result == vk::Result::eSuboptimalKHR) { m_PendingRecreateSwapchain = true; }
@@ -146,6 +189,15 @@ namespace vke {
         present_info.setWaitSemaphores(write_finished_semaphore);
         present_info.setSwapchains(m_Swapchain);
         present_info.setImageIndices(m_CurrentImageIndex);
+
+        const uint64_t   present_id = m_PresentId + 1;
+        vk::PresentIdKHR present_id_info{};
+        if (m_PresentWait) {
+            present_id_info.setPresentIds(present_id);
+            present_info.setPNext(&present_id_info);
+        }
+
         [[maybe_unused]] auto _ = m_Device->queues().main.queue.presentKHR(present_info);
+        if (m_PresentWait) { m_PresentId = present_id; }
     }
 } // namespace vke
@@ -17,7 +17,7 @@ namespace vke {
                             public ScopedSlotSubscriber,
                             public ImageSupplier,
                             public Ownable {
-        Surface(const std::shared_ptr<Device>& device, const std::shared_ptr<Window>& window);
+        Surface(const std::shared_ptr<Device>& device, const std::shared_ptr<Window>& window, PresentPolicy present_policy);
 
       public:
         static constexpr std::size_t FRAMES_IN_FLIGHT = 2;
@@ -31,14 +31,29 @@ namespace vke {
             vk::SurfaceTransformFlagBitsKHR pre_transform;
         };
 
-        [[nodiscard]] static inline std::shared_ptr<Surface> create(const std::shared_ptr<Window>& window) {
-            return std::shared_ptr<Surface>(new Surface(global::g_Device, window));
+        // The first swapchain is already built for the policy.
+        [[nodiscard]] static inline std::shared_ptr<Surface>
+        create(const std::shared_ptr<Window>& window, const PresentPolicy present_policy = PresentPolicy::Throughput) {
+            return std::shared_ptr<Surface>(new Surface(global::g_Device, window, present_policy));
         }
 
         ~Surface() override;
 
         void recreate_swapchain();
 
+        // Takes effect when the swapchain is next recreated, which this schedules. Also resets the queued frame cap to the policy's.
+        void                               set_present_policy(PresentPolicy policy);
+        [[nodiscard]] inline PresentPolicy present_policy() const noexcept { return m_PresentPolicy; }
+
+        /**
+         * How many presented frames may still be waiting for the display when next_image() hands out the image for a new one; 0 turns the cap
+         * off. Waiting happens through VK_KHR_present_wait, so without it (see DeviceOptions::present_wait) frames are only bounded by the
+         * renderer's frames in flight and the swapchain's image count.
+         */
+        inline void                   set_max_queued_frames(const uint32_t frames) noexcept { m_MaxQueuedFrames = frames; }
+        [[nodiscard]] inline uint32_t max_queued_frames() const noexcept { return m_MaxQueuedFrames; }
+        [[nodiscard]] inline bool     present_wait_available() const noexcept { return m_PresentWait; }
+
         [[nodiscard]] inline vk::SwapchainKHR              swapchain() const { return m_Swapchain; };
         [[nodiscard]] inline vk::SurfaceKHR                surface() const { return m_Surface; };
         [[nodiscard]] inline const SwapchainConfiguration& configuration() const { return m_SwapchainConfiguration; }
@@ -61,10 +76,17 @@ namespace vke {
         SwapchainConfiguration m_SwapchainConfiguration;
         bool                   m_PendingRecreateSwapchain = false;
 
+        PresentPolicy m_PresentPolicy   = PresentPolicy::Throughput;
+        uint32_t      m_MaxQueuedFrames = 0;
+        bool          m_PresentWait     = false;
+        uint64_t      m_PresentId       = 0; // of the last present to the current swapchain, ids start over with every swapchain
+
         vk::SurfaceKHR         m_Surface;
         vk::SwapchainKHR       m_Swapchain;
         std::vector<vk::Image> m_Images;
 
         uint32_t m_CurrentImageIndex = 0;
+
+        void wait_for_present(uint64_t present_id);
     };
 } // namespace vke
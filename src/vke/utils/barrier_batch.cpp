@@ -0,0 +1,286 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#include "barrier_batch.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <tuple>
+
+namespace vke {
+    using Access = vk::AccessFlagBits2;
+
+    static constexpr vk::AccessFlags2 WRITE_ACCESS = Access::eShaderWrite | Access::eShaderStorageWrite | Access::eColorAttachmentWrite |
+                                                     Access::eDepthStencilAttachmentWrite | Access::eTransferWrite | Access::eHostWrite |
+                                                     Access::eMemoryWrite;
+
+    // VK_REMAINING_MIP_LEVELS and VK_REMAINING_ARRAY_LAYERS are both ~0U.
+    static uint64_t range_end(const uint32_t base, const uint32_t count) {
+        return count == VK_REMAINING_MIP_LEVELS ? UINT64_MAX : static_cast<uint64_t>(base) + count;
+    }
+
+    static bool overlaps(const vk::ImageSubresourceRange& a, const vk::ImageSubresourceRange& b) {
+        return (a.aspectMask & b.aspectMask) && a.baseMipLevel < range_end(b.baseMipLevel, b.levelCount) &&
+               b.baseMipLevel < range_end(a.baseMipLevel, a.levelCount) && a.baseArrayLayer < range_end(b.baseArrayLayer, b.layerCount) &&
+               b.baseArrayLayer < range_end(a.baseArrayLayer, a.layerCount);
+    }
+
+    static bool overlaps(const vk::DeviceSize a_offset, const vk::DeviceSize a_size, const vk::DeviceSize b_offset, const vk::DeviceSize b_size) {
+        const auto a_end = a_size == vk::WholeSize ? UINT64_MAX : a_offset + a_size;
+        const auto b_end = b_size == vk::WholeSize ? UINT64_MAX : b_offset + b_size;
+        return a_offset < b_end && b_offset < a_end;
+    }
+
+    template<typename T>
+    static uint64_t bits(const vk::Flags<T> flags) {
+        return static_cast<uint64_t>(static_cast<typename vk::Flags<T>::MaskType>(flags));
+    }
+
+    void BarrierBatch::image_barrier(
+      const vk::Image                  image,
+      const vk::ImageSubresourceRange& range,
+      const vk::PipelineStageFlags2    src_stage,
+      const ImageTransitionState&      src_state,
+      const vk::PipelineStageFlags2    dst_stage,
+      const ImageTransitionState&      dst_state
+    ) {
+        add(ImageBarrier{image, range, src_stage, src_state.access, dst_stage, dst_state.access, src_state.layout, dst_state.layout});
+    }
+
+    void BarrierBatch::buffer_barrier(
+      const vk::Buffer              buffer,
+      const vk::DeviceSize          offset,
+      const vk::DeviceSize          size,
+      const vk::PipelineStageFlags2 src_stage,
+      const vk::AccessFlags2        src_access,
+      const vk::PipelineStageFlags2 dst_stage,
+      const vk::AccessFlags2        dst_access
+    ) {
+        add(BufferBarrier{buffer, offset, size, src_stage, src_access, dst_stage, dst_access});
+    }
+
+    void BarrierBatch::memory_barrier(
+      const vk::PipelineStageFlags2 src_stage,
+      const vk::AccessFlags2        src_access,
+      const vk::PipelineStageFlags2 dst_stage,
+      const vk::AccessFlags2        dst_access
+    ) {
+        // One barrier covering both is a superset of the two, and memory barriers don't have anything else that could differ.
+        auto& memory = batch().memory;
+        if (!memory) { memory.emplace(); }
+        memory->srcStageMask  |= src_stage;
+        memory->srcAccessMask |= src_access;
+        memory->dstStageMask  |= dst_stage;
+        memory->dstAccessMask |= dst_access;
+    }
+
+    void BarrierBatch::track(
+      const vk::Image image, const vk::ImageSubresourceRange& range, const vk::PipelineStageFlags2 stage, const ImageTransitionState& state
+    ) {
+        if (range.baseMipLevel != 0 || range.baseArrayLayer != 0 || range.levelCount == VK_REMAINING_MIP_LEVELS ||
+            range.layerCount == VK_REMAINING_ARRAY_LAYERS) {
+            throw std::invalid_argument("Tracked images need a range from the first mip and layer, with explicit counts");
+        }
+
+        const bool       write = static_cast<bool>(state.access & WRITE_ACCESS);
+        SubresourceState subresource{state.layout, stage, state.access & WRITE_ACCESS, write ? vk::PipelineStageFlags2{} : stage, {}, {}};
+        m_Tracked[static_cast<VkImage>(image)] = {range.levelCount, range.layerCount, std::vector(range.levelCount * range.layerCount, subresource)};
+    }
+
+    void BarrierBatch::forget(const vk::Image image) {
+        m_Tracked.erase(static_cast<VkImage>(image));
+    }
+
+    void BarrierBatch::transition(
+      const vk::Image image, const vk::ImageSubresourceRange& range, const vk::PipelineStageFlags2 stage, const ImageTransitionState& state
+    ) {
+        const auto tracked = m_Tracked.find(static_cast<VkImage>(image));
+        if (tracked == m_Tracked.end()) { throw std::invalid_argument("Image isn't tracked"); }
+
+        auto&      image_state = tracked->second;
+        const auto mip_end     = std::min<uint64_t>(range_end(range.baseMipLevel, range.levelCount), image_state.mip_levels);
+        const auto layer_end   = std::min<uint64_t>(range_end(range.baseArrayLayer, range.layerCount), image_state.array_layers);
+        if (range.baseMipLevel >= mip_end || range.baseArrayLayer >= layer_end ||
+            (range.levelCount != VK_REMAINING_MIP_LEVELS && range.baseMipLevel + range.levelCount > image_state.mip_levels) ||
+            (range.layerCount != VK_REMAINING_ARRAY_LAYERS && range.baseArrayLayer + range.layerCount > image_state.array_layers)) {
+            throw std::invalid_argument("Range isn't part of the tracked image");
+        }
+
+        const bool write = static_cast<bool>(state.access & WRITE_ACCESS);
+        for (auto mip = range.baseMipLevel; mip < mip_end; mip++) {
+            for (auto layer = range.baseArrayLayer; layer < layer_end; layer++) {
+                auto&                           current = image_state.subresources[mip * image_state.array_layers + layer];
+                const vk::ImageSubresourceRange subresource{range.aspectMask, mip, 1, layer, 1};
+
+                if (current.layout != state.layout || write) {
+                    // Transitions and writes wait for the last write, and every read since.
+                    const auto src_stages = current.write_stages | current.read_stages;
+                    if (current.layout != state.layout || src_stages) {
+                        add(ImageBarrier{image, subresource, src_stages, current.write_access, stage, state.access, current.layout, state.layout});
+                    }
+
+                    current = {state.layout, stage, state.access & WRITE_ACCESS, write ? vk::PipelineStageFlags2{} : stage, stage, state.access};
+                    continue;
+                }
+
+                // A read in the same layout only waits if no earlier barrier has made the last write visible to it.
+                const bool synced = !(stage & ~current.synced_stages) && !(state.access & ~current.synced_access);
+                if (current.write_stages && !synced) {
+                    const auto kept = state.layout;
+                    add(ImageBarrier{image, subresource, current.write_stages, current.write_access, stage, state.access, kept, kept});
+                    current.synced_stages |= stage;
+                    current.synced_access |= state.access;
+                }
+                current.read_stages |= stage;
+            }
+        }
+    }
+
+    vk::ImageLayout BarrierBatch::layout(const vk::Image image, const uint32_t mip_level, const uint32_t array_layer) const {
+        const auto tracked = m_Tracked.find(static_cast<VkImage>(image));
+        if (tracked == m_Tracked.end()) { throw std::invalid_argument("Image isn't tracked"); }
+
+        const auto& image_state = tracked->second;
+        if (mip_level >= image_state.mip_levels || array_layer >= image_state.array_layers) {
+            throw std::invalid_argument("Subresource isn't part of the tracked image");
+        }
+        return image_state.subresources[mip_level * image_state.array_layers + array_layer].layout;
+    }
+
+    BarrierBatch::Batch& BarrierBatch::batch() {
+        if (m_Batches.empty()) { m_Batches.emplace_back(); }
+        return m_Batches.back();
+    }
+
+    void BarrierBatch::add(const ImageBarrier& barrier) {
+        auto& current = batch();
+        for (auto& pending : current.images) {
+            if (pending.image != barrier.image || !overlaps(pending.range, barrier.range)) { continue; }
+
+            // Nothing runs between the two, so the first one's source and the second one's destination make one barrier.
+            if (pending.range == barrier.range && pending.new_layout == barrier.old_layout) {
+                pending.new_layout  = barrier.new_layout;
+                pending.src_stage  |= barrier.src_stage;
+                pending.src_access |= barrier.src_access;
+                pending.dst_stage  |= barrier.dst_stage;
+                pending.dst_access |= barrier.dst_access;
+                return;
+            }
+
+            m_Batches.emplace_back().images.push_back(barrier);
+            return;
+        }
+        current.images.push_back(barrier);
+    }
+
+    void BarrierBatch::add(const BufferBarrier& barrier) {
+        auto& current = batch();
+        for (auto& pending : current.buffers) {
+            if (pending.buffer != barrier.buffer || !overlaps(pending.offset, pending.size, barrier.offset, barrier.size)) { continue; }
+
+            if (pending.offset == barrier.offset && pending.size == barrier.size) {
+                pending.src_stage  |= barrier.src_stage;
+                pending.src_access |= barrier.src_access;
+                pending.dst_stage  |= barrier.dst_stage;
+                pending.dst_access |= barrier.dst_access;
+                return;
+            }
+
+            m_Batches.emplace_back().buffers.push_back(barrier);
+            return;
+        }
+        current.buffers.push_back(barrier);
+    }
+
+    // Merges barriers whose ranges line up: first the layers of each mip range, then the mips of each layer range.
+    template<typename Barrier>
+    static void coalesce(std::vector<Barrier>& barriers) {
+        if (barriers.size() < 2) { return; }
+
+        // Everything but the range, so barriers with equal keys only differ in which subresources they cover.
+        const auto key = [](const Barrier& barrier) {
+            return std::tuple(
+              std::bit_cast<uint64_t>(static_cast<VkImage>(barrier.image)), bits(barrier.range.aspectMask), barrier.old_layout, barrier.new_layout,
+              bits(barrier.src_stage), bits(barrier.src_access), bits(barrier.dst_stage), bits(barrier.dst_access)
+            );
+        };
+
+        const auto merge = [&](const auto& order, const auto& next_to) {
+            const auto less = [&](const Barrier& a, const Barrier& b) { return std::tuple(key(a), order(a)) < std::tuple(key(b), order(b)); };
+            std::ranges::sort(barriers, less);
+
+            std::size_t last = 0;
+            for (std::size_t i = 1; i < barriers.size(); i++) {
+                if (key(barriers[last]) == key(barriers[i]) && next_to(barriers[last].range, barriers[i].range)) { continue; }
+                barriers[++last] = barriers[i];
+            }
+            barriers.resize(last + 1);
+        };
+
+        merge(
+          [](const Barrier& barrier) { return std::tuple(barrier.range.baseMipLevel, barrier.range.levelCount, barrier.range.baseArrayLayer); },
+          [](vk::ImageSubresourceRange& range, const vk::ImageSubresourceRange& next) {
+              const bool merged = range.baseMipLevel == next.baseMipLevel && range.levelCount == next.levelCount &&
+                                  range_end(range.baseArrayLayer, range.layerCount) == next.baseArrayLayer &&
+                                  next.layerCount != VK_REMAINING_ARRAY_LAYERS;
+              if (merged) { range.layerCount += next.layerCount; }
+              return merged;
+          }
+        );
+        merge(
+          [](const Barrier& barrier) { return std::tuple(barrier.range.baseArrayLayer, barrier.range.layerCount, barrier.range.baseMipLevel); },
+          [](vk::ImageSubresourceRange& range, const vk::ImageSubresourceRange& next) {
+              const bool merged = range.baseArrayLayer == next.baseArrayLayer && range.layerCount == next.layerCount &&
+                                  range_end(range.baseMipLevel, range.levelCount) == next.baseMipLevel &&
+                                  next.levelCount != VK_REMAINING_MIP_LEVELS;
+              if (merged) { range.levelCount += next.levelCount; }
+              return merged;
+          }
+        );
+    }
+
+    void BarrierBatch::flush(const vk::CommandBuffer command_buffer) {
+        for (auto& batch : m_Batches) {
+            coalesce(batch.images);
+
+            m_ImageBarriers.clear();
+            for (const auto& barrier : batch.images) {
+                vk::ImageMemoryBarrier2 imb{};
+                imb.image            = barrier.image;
+                imb.subresourceRange = barrier.range;
+                imb.oldLayout        = barrier.old_layout;
+                imb.newLayout        = barrier.new_layout;
+                imb.srcStageMask     = barrier.src_stage;
+                imb.srcAccessMask    = barrier.src_access;
+                imb.dstStageMask     = barrier.dst_stage;
+                imb.dstAccessMask    = barrier.dst_access;
+                m_ImageBarriers.push_back(imb);
+            }
+
+            m_BufferBarriers.clear();
+            for (const auto& barrier : batch.buffers) {
+                vk::BufferMemoryBarrier2 bmb{};
+                bmb.buffer        = barrier.buffer;
+                bmb.offset        = barrier.offset;
+                bmb.size          = barrier.size;
+                bmb.srcStageMask  = barrier.src_stage;
+                bmb.srcAccessMask = barrier.src_access;
+                bmb.dstStageMask  = barrier.dst_stage;
+                bmb.dstAccessMask = barrier.dst_access;
+                m_BufferBarriers.push_back(bmb);
+            }
+
+            vk::DependencyInfo dependency_info{};
+            dependency_info.setImageMemoryBarriers(m_ImageBarriers);
+            dependency_info.setBufferMemoryBarriers(m_BufferBarriers);
+            if (batch.memory) { dependency_info.setMemoryBarriers(*batch.memory); }
+            command_buffer.pipelineBarrier2(dependency_info);
+
+            m_BarrierCount += m_ImageBarriers.size() + m_BufferBarriers.size() + (batch.memory ? 1 : 0);
+            m_DependencyCount++;
+        }
+        m_Batches.clear();
+    }
+} // namespace vke
@@ -0,0 +1,135 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+#include "vke/utils/types.hpp"
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace vke {
+
+    /**
+     * Collects image, buffer and global memory barriers, and records them together in one vk::DependencyInfo when flushed: call flush() right
+     * before the draw, dispatch or copy which needs them, rather than recording a pipelineBarrier2 per resource as they come up.
+     *
+     * Barriers are merged on the way in. Global memory barriers are folded into one. A barrier for exactly the subresources (or buffer range)
+     * of one already waiting is folded into it, since nothing can run between the two. On flush, barriers which only differ in their range, and
+     * whose ranges line up, are recorded as one (e.g. all the mips of an image, transitioned one at a time). Barriers that overlap in any other
+     * way can't share a dependency info, so they start a second one in the same flush.
+     *
+     * Images can also be tracked: the batch then remembers the layout and last access of every subresource, and transition() works out the
+     * source side itself, adding nothing for reads which an earlier barrier already made the last write visible to.
+     */
+    class VKE_API BarrierBatch {
+      public:
+        void image_barrier(
+          vk::Image                        image,
+          const vk::ImageSubresourceRange& range,
+          vk::PipelineStageFlags2          src_stage,
+          const ImageTransitionState&      src_state,
+          vk::PipelineStageFlags2          dst_stage,
+          const ImageTransitionState&      dst_state
+        );
+
+        void buffer_barrier(
+          vk::Buffer              buffer,
+          vk::DeviceSize          offset,
+          vk::DeviceSize          size,
+          vk::PipelineStageFlags2 src_stage,
+          vk::AccessFlags2        src_access,
+          vk::PipelineStageFlags2 dst_stage,
+          vk::AccessFlags2        dst_access
+        );
+
+        void memory_barrier(
+          vk::PipelineStageFlags2 src_stage,
+          vk::AccessFlags2        src_access,
+          vk::PipelineStageFlags2 dst_stage,
+          vk::AccessFlags2        dst_access
+        );
+
+        /**
+         * Starts tracking the image as being in the given state, last accessed by the given stage. The range describes the whole image: it starts
+         * at mip 0 and layer 0, and its counts are explicit. Throws std::invalid_argument otherwise. Tracking an image again replaces what was
+         * known about it.
+         */
+        void track(vk::Image image, const vk::ImageSubresourceRange& range, vk::PipelineStageFlags2 stage, const ImageTransitionState& state);
+        void forget(vk::Image image);
+
+        // Throws std::invalid_argument if the image isn't tracked, or the range isn't part of what is.
+        void transition(vk::Image image, const vk::ImageSubresourceRange& range, vk::PipelineStageFlags2 stage, const ImageTransitionState& state);
+
+        [[nodiscard]] vk::ImageLayout layout(vk::Image image, uint32_t mip_level, uint32_t array_layer) const;
+
+        // Records everything collected so far. Does nothing if nothing was.
+        void flush(vk::CommandBuffer command_buffer);
+
+        [[nodiscard]] inline bool     empty() const noexcept { return m_Batches.empty(); }
+        [[nodiscard]] inline uint64_t barrier_count() const noexcept { return m_BarrierCount; }       // recorded, after merging
+        [[nodiscard]] inline uint64_t dependency_count() const noexcept { return m_DependencyCount; } // pipelineBarrier2 calls
+
+      private:
+        struct ImageBarrier {
+            vk::Image                 image;
+            vk::ImageSubresourceRange range;
+            vk::PipelineStageFlags2   src_stage;
+            vk::AccessFlags2          src_access;
+            vk::PipelineStageFlags2   dst_stage;
+            vk::AccessFlags2          dst_access;
+            vk::ImageLayout           old_layout;
+            vk::ImageLayout           new_layout;
+        };
+
+        struct BufferBarrier {
+            vk::Buffer              buffer;
+            vk::DeviceSize          offset;
+            vk::DeviceSize          size;
+            vk::PipelineStageFlags2 src_stage;
+            vk::AccessFlags2        src_access;
+            vk::PipelineStageFlags2 dst_stage;
+            vk::AccessFlags2        dst_access;
+        };
+
+        // One dependency info's worth.
+        struct Batch {
+            std::vector<ImageBarrier>         images;
+            std::vector<BufferBarrier>        buffers;
+            std::optional<vk::MemoryBarrier2> memory;
+        };
+
+        struct SubresourceState {
+            vk::ImageLayout         layout;
+            vk::PipelineStageFlags2 write_stages;  // of the last write or layout transition
+            vk::AccessFlags2        write_access;
+            vk::PipelineStageFlags2 read_stages;   // since then, which the next write has to wait for
+            vk::PipelineStageFlags2 synced_stages; // which the last write has been made visible to
+            vk::AccessFlags2        synced_access;
+        };
+
+        struct TrackedImage {
+            uint32_t                      mip_levels;
+            uint32_t                      array_layers;
+            std::vector<SubresourceState> subresources; // mip major
+        };
+
+        Batch& batch();
+        void   add(const ImageBarrier& barrier);
+        void   add(const BufferBarrier& barrier);
+
+        std::vector<Batch>                        m_Batches;
+        std::unordered_map<VkImage, TrackedImage> m_Tracked;
+
+        // Reused by every flush.
+        std::vector<vk::ImageMemoryBarrier2>  m_ImageBarriers;
+        std::vector<vk::BufferMemoryBarrier2> m_BufferBarriers;
+
+        uint64_t m_BarrierCount    = 0;
+        uint64_t m_DependencyCount = 0;
+    };
+
+} // namespace vke
@@ -0,0 +1,211 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#include "file_watcher.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef WIN32
+#  include <Windows.h>
+#else
+#  include <cerrno>
+#  include <fcntl.h>
+#  include <poll.h>
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#  include <unordered_map>
+#endif
+
+namespace vke {
+#ifdef WIN32
+    struct FileWatcher::Platform {
+        struct Root {
+            std::filesystem::path path;
+            HANDLE                directory = INVALID_HANDLE_VALUE;
+            OVERLAPPED            overlapped{};
+            alignas(DWORD) std::byte buffer[64 * 1024];
+        };
+
+        std::vector<std::unique_ptr<Root>> roots;
+        HANDLE                             stop_event = nullptr;
+
+        ~Platform() {
+            for (const auto& root : roots) {
+                if (root->directory == INVALID_HANDLE_VALUE) { continue; }
+
+                DWORD bytes;
+                CancelIoEx(root->directory, &root->overlapped);
+                GetOverlappedResult(root->directory, &root->overlapped, &bytes, TRUE);
+                CloseHandle(root->directory);
+                CloseHandle(root->overlapped.hEvent);
+            }
+            if (stop_event) { CloseHandle(stop_event); }
+        }
+
+        static void arm(Root& root) {
+            ResetEvent(root.overlapped.hEvent);
+            constexpr DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME;
+            if (!ReadDirectoryChangesW(root.directory, root.buffer, sizeof(root.buffer), TRUE, filter, nullptr, &root.overlapped, nullptr)) {
+                throw std::runtime_error("Failed to watch " + root.path.string());
+            }
+        }
+    };
+#else
+    struct FileWatcher::Platform {
+        int                                            inotify = -1;
+        int                                            wake[2] = {-1, -1}; // written to on shutdown
+        std::unordered_map<int, std::filesystem::path> directories;
+
+        ~Platform() {
+            if (inotify >= 0) { close(inotify); }
+            if (wake[0] >= 0) { close(wake[0]); }
+            if (wake[1] >= 0) { close(wake[1]); }
+        }
+
+        // inotify isn't recursive, every directory of the tree needs its own watch.
+        void add_tree(const std::filesystem::path& root) {
+            add(root);
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied)) {
+                if (entry.is_directory()) { add(entry.path()); }
+            }
+        }
+
+        void add(const std::filesystem::path& directory) {
+            const int watch = inotify_add_watch(inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if (watch < 0) { throw std::runtime_error("Failed to watch " + directory.string()); }
+            directories[watch] = directory;
+        }
+    };
+#endif
+
+    FileWatcher::FileWatcher(const Settings& settings, Callback callback)
+        : m_Settings(settings), m_Callback(std::move(callback)), m_Platform(std::make_unique<Platform>()) {
+        if (!m_Callback) { throw std::invalid_argument("File watcher needs a callback"); }
+
+#ifdef WIN32
+        m_Platform->stop_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        for (const auto& path : m_Settings.roots) {
+            auto root       = std::make_unique<Platform::Root>();
+            root->path      = std::filesystem::absolute(path);
+            root->directory = CreateFileW(
+              root->path.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+              FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr
+            );
+            if (root->directory == INVALID_HANDLE_VALUE) { throw std::runtime_error("Failed to watch " + root->path.string()); }
+
+            root->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            m_Platform->roots.push_back(std::move(root));
+            Platform::arm(*m_Platform->roots.back());
+        }
+#else
+        m_Platform->inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_Platform->inotify < 0 || pipe2(m_Platform->wake, O_CLOEXEC) != 0) { throw std::runtime_error("Failed to create file watcher"); }
+        for (const auto& root : m_Settings.roots) { m_Platform->add_tree(std::filesystem::absolute(root)); }
+#endif
+
+        m_Thread = std::thread([this] { watch_main(); });
+    }
+
+    FileWatcher::~FileWatcher() {
+#ifdef WIN32
+        SetEvent(m_Platform->stop_event);
+#else
+        constexpr char stop = 0;
+        [[maybe_unused]] const auto written = write(m_Platform->wake[1], &stop, 1);
+#endif
+        m_Thread.join();
+    }
+
+    void FileWatcher::watch_main() {
+        std::vector<std::filesystem::path> changed;
+
+        // Reports what has changed once things have been quiet for a while. Files which were only temporary (or are directories) are dropped.
+        const auto flush = [&] {
+            std::ranges::sort(changed);
+            const auto [first, last] = std::ranges::unique(changed);
+            changed.erase(first, last);
+            std::erase_if(changed, [](const std::filesystem::path& path) {
+                std::error_code error;
+                return !std::filesystem::is_regular_file(path, error);
+            });
+
+            if (!changed.empty()) { m_Callback(changed); }
+            changed.clear();
+        };
+
+#ifdef WIN32
+        std::vector<HANDLE> handles{m_Platform->stop_event};
+        for (const auto& root : m_Platform->roots) { handles.push_back(root->overlapped.hEvent); }
+
+        while (true) {
+            const DWORD timeout = changed.empty() ? INFINITE : static_cast<DWORD>(m_Settings.debounce.count());
+            const DWORD result  = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE, timeout);
+            if (result == WAIT_TIMEOUT) {
+                flush();
+                continue;
+            }
+            if (result == WAIT_OBJECT_0 || result >= WAIT_OBJECT_0 + handles.size()) { return; }
+
+            auto& root  = *m_Platform->roots[result - WAIT_OBJECT_0 - 1];
+            DWORD bytes = 0;
+            // 0 bytes means the buffer overflowed and the changes were lost.
+            if (GetOverlappedResult(root.directory, &root.overlapped, &bytes, FALSE) && bytes > 0) {
+                auto info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(root.buffer);
+                while (true) {
+                    if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+                        changed.push_back(root.path / std::wstring_view(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+                    }
+                    if (info->NextEntryOffset == 0) { break; }
+                    info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(reinterpret_cast<const std::byte*>(info) + info->NextEntryOffset);
+                }
+            }
+
+            try {
+                Platform::arm(root);
+            } catch (const std::runtime_error&) { return; }
+        }
+#else
+        alignas(inotify_event) std::byte buffer[16 * 1024];
+        while (true) {
+            pollfd descriptors[2] = {{m_Platform->inotify, POLLIN, 0}, {m_Platform->wake[0], POLLIN, 0}};
+
+            const int timeout = changed.empty() ? -1 : static_cast<int>(m_Settings.debounce.count());
+            const int ready   = poll(descriptors, 2, timeout);
+            if (ready < 0 && errno == EINTR) { continue; }
+            if (ready < 0 || descriptors[1].revents != 0) { return; }
+            if (ready == 0) {
+                flush();
+                continue;
+            }
+
+            const ssize_t length = read(m_Platform->inotify, buffer, sizeof(buffer));
+            for (ssize_t offset = 0; offset < length;) {
+                const auto event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if (event->mask & IN_IGNORED) {
+                    m_Platform->directories.erase(event->wd);
+                    continue;
+                }
+
+                const auto directory = m_Platform->directories.find(event->wd);
+                if (directory == m_Platform->directories.end() || event->len == 0) { continue; }
+
+                const auto path = directory->second / event->name;
+                if (event->mask & IN_ISDIR) {
+                    // New directories need watches of their own. Whatever was written to them before the watch existed is missed.
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                        try {
+                            m_Platform->add_tree(path);
+                        } catch (const std::exception&) {}
+                    }
+                } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    changed.push_back(path);
+                }
+            }
+        }
+#endif
+    }
+} // namespace vke
@@ -0,0 +1,53 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace vke {
+
+    /**
+     * Watches directory trees for files which are written, created or moved in, on a background thread (ReadDirectoryChangesW on Windows, inotify on
+     * Linux).
+     *
+     * Editors and build tools usually touch a file several times when saving it, so changes are collected until the trees have been quiet for the
+     * debounce interval and then reported once, as a batch of unique absolute paths.
+     */
+    class VKE_API FileWatcher {
+      public:
+        struct Settings {
+            std::vector<std::filesystem::path> roots;
+            std::chrono::milliseconds          debounce{100};
+        };
+
+        // Called on the watcher thread.
+        using Callback = std::function<void(std::span<const std::filesystem::path> changed)>;
+
+        // Throws std::runtime_error if a root can't be watched.
+        FileWatcher(const Settings& settings, Callback callback);
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&)            = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+      private:
+        struct Platform;
+
+        void watch_main();
+
+        Settings                  m_Settings;
+        Callback                  m_Callback;
+        std::unique_ptr<Platform> m_Platform;
+        std::thread               m_Thread;
+    };
+
+} // namespace vke
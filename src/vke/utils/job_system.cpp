@@ -0,0 +1,106 @@
+//
+// Created by andy on 3/24/2025.
+//
+
+#include "vke/utils/job_system.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace vke {
+    JobSystem::JobSystem(uint32_t worker_count) {
+        if (worker_count == 0) { worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1; }
+
+        m_Workers.reserve(worker_count);
+        for (uint32_t i = 0; i < worker_count; i++) {
+            m_Workers.emplace_back([this] { worker_main(); });
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_Condition.notify_all();
+
+        for (auto& worker : m_Workers) {
+            worker.join();
+        }
+    }
+
+    void JobSystem::enqueue(std::function<void()> job) {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Jobs.push_back(std::move(job));
+        }
+        m_Condition.notify_one();
+    }
+
+    void JobSystem::worker_main() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock lock(m_Mutex);
+                m_Condition.wait(lock, [this] { return m_Stopping || !m_Jobs.empty(); });
+                if (m_Stopping && m_Jobs.empty()) { return; }
+
+                job = std::move(m_Jobs.front());
+                m_Jobs.pop_front();
+            }
+
+            job();
+        }
+    }
+
+    void JobSystem::parallel_for(const std::size_t count, const std::size_t min_batch, const std::function<void(std::size_t, std::size_t)>& fn) {
+        if (count == 0) { return; }
+
+        const std::size_t batch_size  = std::max<std::size_t>(min_batch, 1);
+        const std::size_t batch_count = (count + batch_size - 1) / batch_size;
+
+        if (batch_count == 1 || m_Workers.empty()) {
+            fn(0, count);
+            return;
+        }
+
+        // The shared state outlives this call if a helper only gets scheduled after all of the batches are already done.
+        struct State {
+            std::function<void(std::size_t, std::size_t)> fn;
+            std::size_t                                   count, batch_size, batch_count;
+            std::atomic<std::size_t>                      next_batch{0};
+            std::atomic<std::size_t>                      finished_batches{0};
+            std::mutex                                    mutex;
+            std::condition_variable                       condition;
+
+            void run() {
+                std::size_t batch;
+                while ((batch = next_batch.fetch_add(1, std::memory_order_relaxed)) < batch_count) {
+                    const std::size_t begin = batch * batch_size;
+                    fn(begin, std::min(begin + batch_size, count));
+
+                    if (finished_batches.fetch_add(1, std::memory_order_acq_rel) + 1 == batch_count) {
+                        std::lock_guard lock(mutex);
+                        condition.notify_all();
+                    }
+                }
+            }
+        };
+
+        const auto state   = std::make_shared<State>();
+        state->fn          = fn;
+        state->count       = count;
+        state->batch_size  = batch_size;
+        state->batch_count = batch_count;
+
+        const std::size_t helpers = std::min<std::size_t>(m_Workers.size(), batch_count - 1);
+        for (std::size_t i = 0; i < helpers; i++) {
+            enqueue([state] { state->run(); });
+        }
+
+        state->run();
+
+        std::unique_lock lock(state->mutex);
+        state->condition.wait(lock, [&] { return state->finished_batches.load(std::memory_order_acquire) == batch_count; });
+    }
+} // namespace vke
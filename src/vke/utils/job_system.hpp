@@ -0,0 +1,62 @@
+//
+// Created by andy on 3/24/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace vke {
+
+    /**
+     * A small pool of worker threads for engine work (sorting, decoding, loading, etc).
+     *
+     * Jobs are plain callables. `parallel_for` splits a range into batches and lets the calling thread help out, so it is safe to call it from inside
+     * another job (the caller never blocks on a job which hasn't started yet).
+     */
+    class VKE_API JobSystem {
+      public:
+        // 0 means "one less than the hardware concurrency" (the main thread is expected to be doing work too).
+        explicit JobSystem(uint32_t worker_count = 0);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&)            = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        template<typename F>
+        auto submit(F&& job) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+            using result_t = std::invoke_result_t<std::decay_t<F>>;
+
+            auto task   = std::make_shared<std::packaged_task<result_t()>>(std::forward<F>(job));
+            auto future = task->get_future();
+            enqueue([task] { (*task)(); });
+            return future;
+        }
+
+        // Calls fn(begin, end) over [0, count) in batches of at least min_batch elements. Returns once every batch has finished.
+        void parallel_for(std::size_t count, std::size_t min_batch, const std::function<void(std::size_t begin, std::size_t end)>& fn);
+
+        [[nodiscard]] inline uint32_t worker_count() const noexcept { return static_cast<uint32_t>(m_Workers.size()); }
+
+      private:
+        void enqueue(std::function<void()> job);
+        void worker_main();
+
+        std::vector<std::thread>          m_Workers;
+        std::deque<std::function<void()>> m_Jobs;
+        std::mutex                        m_Mutex;
+        std::condition_variable           m_Condition;
+        bool                              m_Stopping = false;
+    };
+
+} // namespace vke
@@ -0,0 +1,63 @@
+//
+// Created by andy on 3/26/2025.
+//
+
+#include "vke/utils/range_allocator.hpp"
+
+#include <algorithm>
+
+namespace vke {
+    RangeAllocator::RangeAllocator(const uint64_t capacity) : m_Capacity(capacity), m_FreeSpace(capacity) {
+        if (capacity > 0) { m_FreeBlocks.emplace(0, capacity); }
+    }
+
+    std::optional<uint64_t> RangeAllocator::allocate(const uint64_t size, const uint64_t alignment) {
+        assert(alignment > 0 && "Alignment must be at least 1");
+        if (size == 0) { return std::nullopt; }
+
+        for (auto it = m_FreeBlocks.begin(); it != m_FreeBlocks.end(); ++it) {
+            const auto [block_offset, block_size] = *it;
+            const uint64_t aligned                = (block_offset + alignment - 1) / alignment * alignment;
+            const uint64_t block_end              = block_offset + block_size;
+            if (aligned + size > block_end) { continue; }
+
+            m_FreeBlocks.erase(it);
+            if (aligned > block_offset) { m_FreeBlocks.emplace(block_offset, aligned - block_offset); }
+            if (aligned + size < block_end) { m_FreeBlocks.emplace(aligned + size, block_end - aligned - size); }
+
+            m_FreeSpace -= size;
+            return aligned;
+        }
+
+        return std::nullopt;
+    }
+
+    void RangeAllocator::free(uint64_t offset, uint64_t size) {
+        if (size == 0) { return; }
+        m_FreeSpace += size;
+
+        auto next = m_FreeBlocks.lower_bound(offset);
+        if (next != m_FreeBlocks.begin()) {
+            if (const auto previous = std::prev(next); previous->first + previous->second == offset) {
+                offset = previous->first;
+                size += previous->second;
+                m_FreeBlocks.erase(previous);
+            }
+        }
+
+        if (next != m_FreeBlocks.end() && offset + size == next->first) {
+            size += next->second;
+            m_FreeBlocks.erase(next);
+        }
+
+        m_FreeBlocks.emplace(offset, size);
+    }
+
+    uint64_t RangeAllocator::largest_free_block() const noexcept {
+        uint64_t largest = 0;
+        for (const auto& [offset, size] : m_FreeBlocks) {
+            largest = std::max(largest, size);
+        }
+        return largest;
+    }
+} // namespace vke
@@ -0,0 +1,36 @@
+//
+// Created by andy on 3/26/2025.
+//
+
+#pragma once
+
+#include "vke/pre.hpp"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+
+namespace vke {
+
+    /**
+     * First-fit sub-allocator over an abstract range [0, capacity) (bytes, vertices, indices, whatever the caller wants). Freed ranges are coalesced
+     * with their neighbours. Not thread safe.
+     */
+    class VKE_API RangeAllocator {
+      public:
+        explicit RangeAllocator(uint64_t capacity);
+
+        [[nodiscard]] std::optional<uint64_t> allocate(uint64_t size, uint64_t alignment = 1);
+        void                                  free(uint64_t offset, uint64_t size);
+
+        [[nodiscard]] inline uint64_t capacity() const noexcept { return m_Capacity; }
+        [[nodiscard]] inline uint64_t free_space() const noexcept { return m_FreeSpace; }
+        [[nodiscard]] uint64_t        largest_free_block() const noexcept;
+
+      private:
+        uint64_t                     m_Capacity;
+        uint64_t                     m_FreeSpace;
+        std::map<uint64_t, uint64_t> m_FreeBlocks; // offset -> size
+    };
+
+} // namespace vke
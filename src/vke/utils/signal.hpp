@@ -0,0 +1,324 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vke {
+    namespace signal_detail {
+        // How a signal hands an argument to its callbacks: small trivially copyable values by value, anything else by const reference, so an
+        // emit doesn't copy a string or a vector once for every callback.
+        template<typename T>
+        using param_t =
+          std::conditional_t<std::is_reference_v<T> || (std::is_trivially_copyable_v<T> && sizeof(T) <= 2 * sizeof(void*)), T, const T&>;
+    } // namespace signal_detail
+
+    template<typename F>
+    class InlineFunction;
+
+    /**
+     * A move-only std::function which stores callables of up to INLINE_SIZE bytes (a lambda capturing a handful of pointers) inside itself,
+     * and only allocates for larger ones, or ones which can't be moved without throwing.
+     */
+    template<typename R, typename... P>
+    class InlineFunction<R(P...)> {
+      public:
+        static constexpr std::size_t INLINE_SIZE = 6 * sizeof(void*);
+
+        InlineFunction() noexcept = default;
+
+        template<typename C>
+            requires(!std::is_same_v<std::remove_cvref_t<C>, InlineFunction> && std::is_invocable_r_v<R, std::decay_t<C>&, P...>)
+        InlineFunction(C&& callable) { // NOLINT(*-explicit-constructor): converts from lambdas like std::function does
+            using T = std::decay_t<C>;
+            if constexpr (stored_inline<T>) {
+                ::new (static_cast<void*>(m_Storage)) T(std::forward<C>(callable));
+                m_Invoke = [](void* storage, P... args) -> R { return (*static_cast<T*>(storage))(std::forward<P>(args)...); };
+                m_Manage = [](const Operation operation, void* storage, void* target) noexcept {
+                    auto* callable = static_cast<T*>(storage);
+                    if (operation == Operation::Move) { ::new (target) T(std::move(*callable)); }
+                    callable->~T();
+                };
+            } else {
+                *reinterpret_cast<T**>(m_Storage) = new T(std::forward<C>(callable));
+                m_Invoke = [](void* storage, P... args) -> R { return (**static_cast<T**>(storage))(std::forward<P>(args)...); };
+                m_Manage = [](const Operation operation, void* storage, void* target) noexcept {
+                    auto* callable = *static_cast<T**>(storage);
+                    if (operation == Operation::Move) {
+                        *static_cast<T**>(target) = callable;
+                    } else {
+                        delete callable;
+                    }
+                };
+            }
+        }
+
+        InlineFunction(InlineFunction&& other) noexcept { take(other); }
+        InlineFunction& operator=(InlineFunction&& other) noexcept {
+            if (this != &other) {
+                reset();
+                take(other);
+            }
+            return *this;
+        }
+
+        InlineFunction(const InlineFunction&)            = delete;
+        InlineFunction& operator=(const InlineFunction&) = delete;
+
+        ~InlineFunction() { reset(); }
+
+        inline R operator()(P... args) const { return m_Invoke(m_Storage, std::forward<P>(args)...); }
+
+        [[nodiscard]] inline explicit operator bool() const noexcept { return m_Invoke != nullptr; }
+
+        void reset() noexcept {
+            if (m_Manage) { m_Manage(Operation::Destroy, m_Storage, nullptr); }
+            m_Invoke = nullptr;
+            m_Manage = nullptr;
+        }
+
+      private:
+        // Move constructs the callable into the target storage, then destroys it where it was.
+        enum class Operation { Move, Destroy };
+
+        template<typename T>
+        static constexpr bool stored_inline =
+          sizeof(T) <= INLINE_SIZE && alignof(T) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<T>;
+
+        void take(InlineFunction& other) noexcept {
+            if (!other.m_Manage) { return; }
+            other.m_Manage(Operation::Move, other.m_Storage, m_Storage);
+            m_Invoke       = other.m_Invoke;
+            m_Manage       = other.m_Manage;
+            other.m_Invoke = nullptr;
+            other.m_Manage = nullptr;
+        }
+
+        alignas(std::max_align_t) mutable std::byte m_Storage[INLINE_SIZE];
+        R (*m_Invoke)(void*, P...)                          = nullptr;
+        void (*m_Manage)(Operation, void*, void*) noexcept = nullptr;
+    };
+
+    template<typename F>
+    class Signal;
+
+    /**
+     * Callbacks called in the order they were appended, for signals emitted on one thread (the lifecycle, windows, surfaces...).
+     *
+     * The callbacks sit next to each other in one vector, each in an InlineFunction, so an emit walks contiguous memory and never allocates.
+     * Arguments reach the callbacks as signal_detail::param_t says, instead of being copied for each of them. Handles carry a generation:
+     * removing is O(1), and removing twice, or with the handle of a callback that is long gone, does nothing.
+     *
+     * Callbacks may append and remove callbacks (themselves included) while the signal is emitting. Appended ones are first called by the next
+     * emit, removed ones aren't called again, and the storage is tidied once the outermost emit returns. Not thread safe: ConcurrentSignal is
+     * for signals which other threads emit or subscribe to.
+     */
+    template<typename... Args>
+    class Signal<void(Args...)> {
+        static_assert((!std::is_rvalue_reference_v<Args> && ...), "Every callback gets the same arguments, so none of them can be moved from");
+
+      public:
+        using callback_t = InlineFunction<void(signal_detail::param_t<Args>...)>;
+
+        struct handle_t {
+            uint32_t id         = UINT32_MAX;
+            uint32_t generation = 0;
+        };
+
+        Signal()                         = default;
+        Signal(const Signal&)            = delete;
+        Signal& operator=(const Signal&) = delete;
+
+        inline void operator()(signal_detail::param_t<Args>... args) { invoke(args...); }
+
+        void invoke(signal_detail::param_t<Args>... args) {
+            // Nothing is erased or appended to m_Slots until the outermost emit is done, so it never moves under a running callback.
+            const EmitScope scope(*this);
+            const std::size_t count = m_Slots.size();
+            for (std::size_t i = 0; i < count; i++) {
+                if (m_Slots[i].alive) { m_Slots[i].callback(args...); }
+            }
+        }
+
+        handle_t append(callback_t callback) {
+            const uint32_t id    = acquire_id();
+            auto&          slots = m_Emitting > 0 ? m_Added : m_Slots;
+            m_Ids[id].index      = static_cast<uint32_t>(slots.size());
+            m_Ids[id].added      = m_Emitting > 0;
+            slots.push_back({std::move(callback), id, true});
+            return {id, m_Ids[id].generation};
+        }
+
+        bool remove(const handle_t& handle) {
+            if (handle.id >= m_Ids.size() || m_Ids[handle.id].generation != handle.generation) { return false; }
+
+            auto& id   = m_Ids[handle.id];
+            auto& slot = (id.added ? m_Added : m_Slots)[id.index];
+            slot.alive = false;
+            id.generation++;
+            m_FreeIds.push_back(handle.id);
+            m_Dead++;
+
+            // A running callback may be the one being removed, it is only destroyed once the emit is over.
+            if (m_Emitting == 0) {
+                slot.callback.reset();
+                if (m_Dead * 2 > m_Slots.size()) { tidy(); }
+            }
+            return true;
+        }
+
+        [[nodiscard]] inline std::size_t size() const noexcept { return m_Slots.size() + m_Added.size() - m_Dead; }
+        [[nodiscard]] inline bool        empty() const noexcept { return size() == 0; }
+
+      private:
+        struct Slot {
+            callback_t callback;
+            uint32_t   id;
+            bool       alive;
+        };
+
+        struct Id {
+            uint32_t index      = 0; // into m_Added if added, else into m_Slots
+            uint32_t generation = 0;
+            bool     added      = false;
+        };
+
+        struct EmitScope {
+            explicit EmitScope(Signal& owner) : owner(owner) { owner.m_Emitting++; }
+            ~EmitScope() {
+                if (--owner.m_Emitting == 0 && (owner.m_Dead > 0 || !owner.m_Added.empty())) { owner.tidy(); }
+            }
+
+            Signal& owner;
+        };
+
+        uint32_t acquire_id() {
+            if (m_FreeIds.empty()) {
+                m_Ids.emplace_back();
+                return static_cast<uint32_t>(m_Ids.size() - 1);
+            }
+
+            const uint32_t id = m_FreeIds.back();
+            m_FreeIds.pop_back();
+            return id;
+        }
+
+        void tidy() {
+            std::erase_if(m_Slots, [](const Slot& slot) { return !slot.alive; });
+            for (auto& slot : m_Added) {
+                if (slot.alive) { m_Slots.push_back(std::move(slot)); }
+            }
+            m_Added.clear();
+            m_Dead = 0;
+
+            for (uint32_t i = 0; i < m_Slots.size(); i++) {
+                m_Ids[m_Slots[i].id].index = i;
+                m_Ids[m_Slots[i].id].added = false;
+            }
+        }
+
+        std::vector<Slot>     m_Slots; // in the order they were appended
+        std::vector<Slot>     m_Added; // during the current emit
+        std::vector<Id>       m_Ids;
+        std::vector<uint32_t> m_FreeIds;
+        std::size_t           m_Dead     = 0; // removed, but still taking up a slot
+        uint32_t              m_Emitting = 0; // nested emits
+    };
+
+    template<typename F>
+    class ConcurrentSignal;
+
+    /**
+     * A signal which any thread may emit, and append to or remove from, at any time.
+     *
+     * Emitting takes no lock: the callbacks are an immutable snapshot, which emits load through an atomic pointer. Appending or removing copies
+     * the snapshot under a mutex and publishes the copy (read-copy-update). Replaced snapshots are freed by the first change which sees no emit
+     * in progress, since only emits which were already running can still be reading them. Changes are expected to be rare next to emits.
+     *
+     * An emit which started before a callback was removed may still call it, on another thread, after remove() returns.
+     */
+    template<typename... Args>
+    class ConcurrentSignal<void(Args...)> {
+        static_assert((!std::is_rvalue_reference_v<Args> && ...), "Every callback gets the same arguments, so none of them can be moved from");
+
+      public:
+        using callback_t = InlineFunction<void(signal_detail::param_t<Args>...)>;
+        using handle_t   = uint64_t;
+
+        ConcurrentSignal() : m_Current(new Snapshot{}) {}
+        ~ConcurrentSignal() { delete m_Current.load(); }
+
+        ConcurrentSignal(const ConcurrentSignal&)            = delete;
+        ConcurrentSignal& operator=(const ConcurrentSignal&) = delete;
+
+        inline void operator()(signal_detail::param_t<Args>... args) const { invoke(args...); }
+
+        void invoke(signal_detail::param_t<Args>... args) const {
+            // Counted in before the snapshot is loaded, see publish().
+            const ReadScope scope(m_Readers);
+            for (const auto& entry : *m_Current.load()) { entry->callback(args...); }
+        }
+
+        handle_t append(callback_t callback) {
+            std::lock_guard lock(m_WriteMutex);
+            const handle_t handle = m_NextHandle++;
+
+            auto next = std::make_unique<Snapshot>(*m_Current.load());
+            next->push_back(std::make_shared<const Entry>(handle, std::move(callback)));
+            publish(std::move(next));
+            return handle;
+        }
+
+        bool remove(const handle_t handle) {
+            std::lock_guard lock(m_WriteMutex);
+            const auto&     current = *m_Current.load();
+            if (std::ranges::none_of(current, [&](const auto& entry) { return entry->handle == handle; })) { return false; }
+
+            auto next = std::make_unique<Snapshot>(current);
+            std::erase_if(*next, [&](const auto& entry) { return entry->handle == handle; });
+            publish(std::move(next));
+            return true;
+        }
+
+      private:
+        struct Entry {
+            Entry(const handle_t handle, callback_t callback) : handle(handle), callback(std::move(callback)) {}
+
+            handle_t   handle;
+            callback_t callback;
+        };
+
+        // Entries are shared between snapshots, so publishing a change copies pointers rather than callables.
+        using Snapshot = std::vector<std::shared_ptr<const Entry>>;
+
+        struct ReadScope {
+            explicit ReadScope(std::atomic<uint32_t>& readers) : readers(readers) { readers.fetch_add(1); }
+            ~ReadScope() { readers.fetch_sub(1); }
+
+            std::atomic<uint32_t>& readers;
+        };
+
+        void publish(std::unique_ptr<Snapshot> next) {
+            m_Retired.emplace_back(m_Current.exchange(next.release()));
+            // An emit which is counted in after this load finds the new snapshot. With none in flight now, nobody holds a retired one.
+            if (m_Readers.load() == 0) { m_Retired.clear(); }
+        }
+
+        std::atomic<const Snapshot*>                 m_Current;
+        mutable std::atomic<uint32_t>                m_Readers = 0; // emits in progress
+        std::mutex                                   m_WriteMutex;
+        std::vector<std::unique_ptr<const Snapshot>> m_Retired;
+        handle_t                                     m_NextHandle = 1;
+    };
+} // namespace vke
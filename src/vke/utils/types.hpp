@@ -24,7 +24,10 @@ namespace vke {
         VKE_API friend std::ostream& operator<<(std::ostream& os, const Version& version);
     };
 
-    struct DeviceOptions {};
+    struct DeviceOptions {
+        // Enables VK_KHR_present_id and VK_KHR_present_wait if the device supports them. Surfaces use them to cap how many frames are queued.
+        bool present_wait = true;
+    };
 
     struct ImageProperties {
         vk::Extent3D  extent;
@@ -8,6 +8,8 @@
 
 #include "vke.hpp"
 
+#include <algorithm>
+
 VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE;
 
 namespace vke {
@@ -175,22 +177,28 @@ namespace vke {
         std::array<float, 1> queue_priorities = {1.0f};
         queue_create_infos.emplace_back(vk::DeviceQueueCreateFlags{}, main_family, queue_priorities);
 
-        vk::StructureChain<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan11Features, vk::PhysicalDeviceVulkan12Features, vk::PhysicalDeviceVulkan13Features, vk::PhysicalDeviceVulkan14Features>
+        vk::StructureChain<
+          vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan11Features, vk::PhysicalDeviceVulkan12Features, vk::PhysicalDeviceVulkan13Features,
+          vk::PhysicalDeviceVulkan14Features, vk::PhysicalDevicePresentIdFeaturesKHR, vk::PhysicalDevicePresentWaitFeaturesKHR>
           features_chain;
 
-        auto& features              = features_chain.get<vk::PhysicalDeviceFeatures2>().features;
-        features.geometryShader     = true;
-        features.tessellationShader = true;
-        features.largePoints        = true;
-        features.wideLines          = true;
-        features.sparseBinding      = true;
-        features.multiDrawIndirect  = true;
+        auto& features                     = features_chain.get<vk::PhysicalDeviceFeatures2>().features;
+        features.geometryShader            = true;
+        features.tessellationShader        = true;
+        features.largePoints               = true;
+        features.wideLines                 = true;
+        features.sparseBinding             = true;
+        features.multiDrawIndirect         = true;
+        features.drawIndirectFirstInstance = true;
 
         auto& v11f                = features_chain.get<vk::PhysicalDeviceVulkan11Features>();
         v11f.shaderDrawParameters = true;
 
-        auto& v12f             = features_chain.get<vk::PhysicalDeviceVulkan12Features>();
-        v12f.timelineSemaphore = true;
+        auto& v12f                                     = features_chain.get<vk::PhysicalDeviceVulkan12Features>();
+        v12f.timelineSemaphore                         = true;
+        v12f.drawIndirectCount                         = true;
+        v12f.descriptorBindingPartiallyBound           = true;
+        v12f.shaderSampledImageArrayNonUniformIndexing = true;
 
         auto& v13f              = features_chain.get<vk::PhysicalDeviceVulkan13Features>();
         v13f.dynamicRendering   = true;
@@ -200,6 +208,34 @@ namespace vke {
         auto& v14f          = features_chain.get<vk::PhysicalDeviceVulkan14Features>();
         v14f.pushDescriptor = true;
 
+        // Present wait needs present ids, and both need the device to support the features, not just to list the extensions.
+        bool present_wait = false;
+        if (options.present_wait) {
+            const auto available = m_PhysicalDevice.enumerateDeviceExtensionProperties();
+            const auto supported = [&](const std::string_view name) {
+                return std::ranges::any_of(available, [&](const vk::ExtensionProperties& properties) {
+                    return std::string_view{properties.extensionName} == name;
+                });
+            };
+
+            if (supported(VK_KHR_PRESENT_ID_EXTENSION_NAME) && supported(VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+                const auto support = m_PhysicalDevice.getFeatures2<
+                  vk::PhysicalDeviceFeatures2, vk::PhysicalDevicePresentIdFeaturesKHR, vk::PhysicalDevicePresentWaitFeaturesKHR>();
+                present_wait = support.get<vk::PhysicalDevicePresentIdFeaturesKHR>().presentId &&
+                               support.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().presentWait;
+            }
+        }
+
+        if (present_wait) {
+            extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+            features_chain.get<vk::PhysicalDevicePresentIdFeaturesKHR>().presentId     = true;
+            features_chain.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().presentWait = true;
+        } else {
+            features_chain.unlink<vk::PhysicalDevicePresentIdFeaturesKHR>();
+            features_chain.unlink<vk::PhysicalDevicePresentWaitFeaturesKHR>();
+        }
+
         create_info.setPEnabledExtensionNames(extensions);
         create_info.setQueueCreateInfos(queue_create_infos);
         create_info.setPNext(&features_chain.get<vk::PhysicalDeviceFeatures2>());
@@ -216,16 +252,72 @@ namespace vke {
           .main = {main_queue, main_family}
         };
 
-        return Device::create(*this, device, queues);
+        return Device::create(*this, device, queues, {extensions.begin(), extensions.end()});
     }
 
-    Device::Device(const PhysicalDevice& physical_device, const vk::Device device, const QueueCollection queue_collection)
-        : m_PhysicalDevice(physical_device), m_Device(device), m_QueueCollection(queue_collection) {}
+    Device::Device(
+      const PhysicalDevice& physical_device, const vk::Device device, const QueueCollection queue_collection, std::vector<std::string> extensions
+    )
+        : m_PhysicalDevice(physical_device), m_Device(device), m_QueueCollection(queue_collection), m_Extensions(std::move(extensions)) {
+        m_MemoryProperties = m_PhysicalDevice.physical_device().getMemoryProperties();
+
+        vk::SemaphoreTypeCreateInfo type_info{vk::SemaphoreType::eTimeline, 0};
+        vk::SemaphoreCreateInfo     create_info{};
+        create_info.pNext = &type_info;
+        m_Timeline        = m_Device.createSemaphore(create_info);
+    }
 
     Device::~Device() {
+        drain();
+
+        m_Device.destroy(m_Timeline);
         m_Device.destroy();
     }
 
+    void Device::defer(std::function<void()> destroy) {
+        std::lock_guard lock(m_DeferredMutex);
+        // Anything submitted up to now is before the next signal.
+        m_Deferred.push_back({m_TimelineValue + 1, std::move(destroy)});
+    }
+
+    void Device::collect() {
+        const uint64_t reached = m_Device.getSemaphoreCounterValue(m_Timeline);
+
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard lock(m_DeferredMutex);
+            while (!m_Deferred.empty() && m_Deferred.front().timeline_value <= reached) {
+                ready.push_back(std::move(m_Deferred.front().destroy));
+                m_Deferred.pop_front();
+            }
+        }
+        // Outside the lock, destroying something may defer more.
+        for (const auto& destroy : ready) { destroy(); }
+    }
+
+    void Device::drain() {
+        m_Device.waitIdle();
+        while (true) {
+            std::function<void()> destroy;
+            {
+                std::lock_guard lock(m_DeferredMutex);
+                if (m_Deferred.empty()) { return; }
+                destroy = std::move(m_Deferred.front().destroy);
+                m_Deferred.pop_front();
+            }
+            destroy();
+        }
+    }
+
+    uint64_t Device::next_timeline_value() {
+        std::lock_guard lock(m_DeferredMutex);
+        return ++m_TimelineValue;
+    }
+
+    bool Device::has_extension(const std::string_view name) const noexcept {
+        return std::ranges::find(m_Extensions, name) != m_Extensions.end();
+    }
+
     vk::Semaphore Device::create_semaphore() const {
         return m_Device.createSemaphore(vk::SemaphoreCreateInfo{});
     }
@@ -246,6 +338,18 @@ namespace vke {
         m_Device.resetFences(fence);
     }
 
+    uint32_t Device::find_memory_type(const uint32_t type_bits, const vk::MemoryPropertyFlags properties) const {
+        for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++) {
+            if ((type_bits & (1u << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties) { return i; }
+        }
+
+        throw std::runtime_error("No suitable memory type");
+    }
+
+    vk::DeviceMemory Device::allocate_memory(const vk::MemoryRequirements& requirements, const vk::MemoryPropertyFlags properties) const {
+        return m_Device.allocateMemory(vk::MemoryAllocateInfo{requirements.size, find_memory_type(requirements.memoryTypeBits, properties)});
+    }
+
     void load_vulkan(const std::shared_ptr<Device>& device) {
         load_vulkan(device->handle());
     }
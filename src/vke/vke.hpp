@@ -11,6 +11,10 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include <deque>
+#include <functional>
+#include <mutex>
+
 namespace vke {
     ////////////////////////
     /// Global Functions ///
@@ -118,11 +122,13 @@ namespace vke {
 
     class VKE_API Device : public std::enable_shared_from_this<Device>,
                            public Ownable {
-        Device(const PhysicalDevice& physical_device, vk::Device device, QueueCollection queue_collection);
+        Device(const PhysicalDevice& physical_device, vk::Device device, QueueCollection queue_collection, std::vector<std::string> extensions);
 
       public:
-        inline static std::shared_ptr<Device> create(const PhysicalDevice& physical_device, const vk::Device device, const QueueCollection queue_collection) {
-            return std::shared_ptr<Device>(new Device(physical_device, device, queue_collection));
+        inline static std::shared_ptr<Device> create(
+          const PhysicalDevice& physical_device, const vk::Device device, const QueueCollection queue_collection, std::vector<std::string> extensions
+        ) {
+            return std::shared_ptr<Device>(new Device(physical_device, device, queue_collection, std::move(extensions)));
         }
 
         ~Device();
@@ -141,8 +147,32 @@ namespace vke {
             handle().destroy(object);
         }
 
+        /**
+         * Destroys the object once the GPU is done with everything submitted so far, instead of right away, so nothing has to wait for the
+         * device to go idle first. Deferred work is stamped with the next value of the device's timeline semaphore and runs in collect() once
+         * the timeline reaches it. The queue executes in order, so a submission signalling the timeline also retires every one before it that
+         * didn't. Thread safe. Whatever is still deferred when the device is destroyed runs after it goes idle.
+         */
+        template<device_destructible T>
+        inline void defer_destroy(T object) {
+            defer([device = m_Device, object] { device.destroy(object); });
+        }
+        void defer(std::function<void()> destroy);
+        void collect();
+
+        // Waits for the device to go idle and runs everything deferred, including what that defers in turn. Deferred work may hold on to the
+        // device itself (through the objects it destroys), so this has to run before the last reference to the device is dropped.
+        void drain();
+
+        // Submissions signal the timeline with next_timeline_value(). Take the value right before the submit: the timeline may only go up.
+        [[nodiscard]] inline vk::Semaphore timeline() const noexcept { return m_Timeline; }
+        [[nodiscard]] uint64_t             next_timeline_value();
+
         [[nodiscard]] inline const QueueCollection& queues() const noexcept { return m_QueueCollection; }
 
+        // Whether the extension was enabled when the device was created.
+        [[nodiscard]] bool has_extension(std::string_view name) const noexcept;
+
         [[nodiscard]] vk::Semaphore create_semaphore() const;
         [[nodiscard]] vk::Fence     create_fence() const;
         [[nodiscard]] vk::Fence     create_fence(bool signaled) const;
@@ -150,10 +180,28 @@ namespace vke {
         void wait_for_fence(vk::Fence fence) const;
         void reset_fence(vk::Fence fence) const;
 
+        [[nodiscard]] inline const vk::PhysicalDeviceMemoryProperties& memory_properties() const noexcept { return m_MemoryProperties; }
+
+        // Throws std::runtime_error if no memory type matches both the type bits and the requested properties.
+        [[nodiscard]] uint32_t         find_memory_type(uint32_t type_bits, vk::MemoryPropertyFlags properties) const;
+        [[nodiscard]] vk::DeviceMemory allocate_memory(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties) const;
+
       private:
-        PhysicalDevice  m_PhysicalDevice;
-        vk::Device      m_Device;
-        QueueCollection m_QueueCollection;
+        PhysicalDevice                     m_PhysicalDevice;
+        vk::Device                         m_Device;
+        QueueCollection                    m_QueueCollection;
+        std::vector<std::string>           m_Extensions;
+        vk::PhysicalDeviceMemoryProperties m_MemoryProperties;
+
+        struct Deferred {
+            uint64_t              timeline_value;
+            std::function<void()> destroy;
+        };
+
+        vk::Semaphore        m_Timeline;
+        std::mutex           m_DeferredMutex;
+        uint64_t             m_TimelineValue = 0; // last handed out
+        std::deque<Deferred> m_Deferred;          // in timeline order
     };
 
 } // namespace vke
@@ -9,6 +9,7 @@
 #include "window_manager.hpp"
 
 #include <iostream>
+#include <windowsx.h>
 
 namespace vke {
     static constexpr wchar_t WC_NAME[] = L"VKE_WC";
@@ -47,7 +48,7 @@ namespace vke {
         }
     }
 
-    Window::Window(const Settings& settings) {
+    Window::Window(const Settings& settings) : m_InitialPresentPolicy(settings.present_policy) {
         register_window_class_if_necessary();
 
         m_hinstance = GetModuleHandle(nullptr);
@@ -83,7 +84,58 @@ namespace vke {
         case WM_SIZE: {
             UINT width  = LOWORD(lParam);
             UINT height = HIWORD(lParam);
-            on_resize({width, height});
+            m_Events.resize({width, height});
+            return 0;
+        }
+        case WM_KEYDOWN:
+        case WM_KEYUP:   {
+            m_Events.input({msg == WM_KEYDOWN ? InputEventType::KeyDown : InputEventType::KeyUp, static_cast<uint32_t>(wParam)});
+            return 0;
+        }
+        case WM_SYSKEYDOWN:
+        case WM_SYSKEYUP:   {
+            // Still handed to DefWindowProc, which handles Alt+F4 and the window menu.
+            m_Events.input({msg == WM_SYSKEYDOWN ? InputEventType::KeyDown : InputEventType::KeyUp, static_cast<uint32_t>(wParam)});
+            break;
+        }
+        case WM_CHAR: {
+            m_Events.input({InputEventType::Char, static_cast<uint32_t>(wParam)});
+            return 0;
+        }
+        case WM_MOUSEMOVE: {
+            m_Events.input({InputEventType::MouseMove, 0, {GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)}});
+            return 0;
+        }
+        case WM_LBUTTONDOWN:
+        case WM_LBUTTONUP:
+        case WM_RBUTTONDOWN:
+        case WM_RBUTTONUP:
+        case WM_MBUTTONDOWN:
+        case WM_MBUTTONUP:
+        case WM_XBUTTONDOWN:
+        case WM_XBUTTONUP:   {
+            const bool down   = msg == WM_LBUTTONDOWN || msg == WM_RBUTTONDOWN || msg == WM_MBUTTONDOWN || msg == WM_XBUTTONDOWN;
+            uint32_t   button = 0;
+            if (msg == WM_RBUTTONDOWN || msg == WM_RBUTTONUP) { button = 1; }
+            if (msg == WM_MBUTTONDOWN || msg == WM_MBUTTONUP) { button = 2; }
+            if (msg == WM_XBUTTONDOWN || msg == WM_XBUTTONUP) { button = GET_XBUTTON_WPARAM(wParam) == XBUTTON1 ? 3 : 4; }
+
+            const auto type = down ? InputEventType::MouseButtonDown : InputEventType::MouseButtonUp;
+            m_Events.input({type, button, {GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)}});
+            return msg == WM_XBUTTONDOWN || msg == WM_XBUTTONUP ? TRUE : 0;
+        }
+        case WM_MOUSEWHEEL: {
+            // Comes with screen coordinates, unlike the other mouse messages.
+            POINT point{GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam)};
+            ScreenToClient(m_Handle, &point);
+
+            const float notches = static_cast<float>(GET_WHEEL_DELTA_WPARAM(wParam)) / WHEEL_DELTA;
+            m_Events.input({InputEventType::MouseWheel, 0, {point.x, point.y}, notches});
+            return 0;
+        }
+        case WM_SETFOCUS:
+        case WM_KILLFOCUS: {
+            m_Events.input({msg == WM_SETFOCUS ? InputEventType::FocusGained : InputEventType::FocusLost});
             return 0;
         }
         default: break;
@@ -127,6 +179,12 @@ namespace vke {
         return {static_cast<uint32_t>(r.right), static_cast<uint32_t>(r.bottom)};
     }
 
+    void Window::dispatch_events() {
+        m_Events.run_posted();
+        if (const auto extent = m_Events.take_resize()) { on_resize(*extent); }
+        if (const auto input = m_Events.take_input(); !input.empty()) { on_input(input); }
+    }
+
     std::shared_ptr<Surface> Window::get_surface() {
         return global::g_WindowManager->get_surface(shared_from_this());
     }
@@ -10,21 +10,33 @@
 #endif
 
 #include "dependency.hpp"
+#include "event_queue.hpp"
 
+#include <span>
 #include <string>
 #include <Windows.h>
 
 #include <glm/glm.hpp>
 
 namespace vke {
+    // What a surface's swapchain is set up for.
+    enum class PresentPolicy {
+        // Input to photon: mailbox, else immediate (tearing), else fifo. One frame may be queued for the display when the next one starts.
+        Latency,
+        // Frame rate: mailbox, else fifo, and no cap on queued frames beyond the renderer's frames in flight.
+        Throughput,
+        // Fifo with as few images as the surface allows, so nothing is rendered that won't be shown. One frame may be queued.
+        PowerSaving,
+    };
 
     class VKE_API Window : public std::enable_shared_from_this<Window>,
                            public ScopedSlotSubscriber,
                            public Ownable {
       public:
         struct Settings {
-            std::wstring title;
-            glm::ivec2   size;
+            std::wstring  title;
+            glm::ivec2    size;
+            PresentPolicy present_policy = PresentPolicy::Throughput; // what the window's surface is created with
         };
 
       private:
@@ -52,14 +64,26 @@ namespace vke {
 
         [[nodiscard]] std::shared_ptr<Surface> get_surface();
 
-        Signal<void(vk::Extent2D)> on_resize;
-        Signal<void(bool&)>        on_close_requested;
-        Signal<void()>             on_closed;
+        // Emits what was queued since the last call: on_resize once with the last size, on_input once with every input event. Called every frame
+        // right after the OS is polled.
+        void dispatch_events();
+
+        [[nodiscard]] inline EventQueue& events() noexcept { return m_Events; }
+
+        // The surface's policy when it was created, it can be changed on the surface afterwards.
+        [[nodiscard]] inline PresentPolicy initial_present_policy() const noexcept { return m_InitialPresentPolicy; }
+
+        Signal<void(vk::Extent2D)>                on_resize;
+        Signal<void(std::span<const InputEvent>)> on_input;
+        Signal<void(bool&)>                       on_close_requested;
+        Signal<void()>                            on_closed;
 
       private:
-        HINSTANCE m_hinstance;
-        HWND      m_Handle;
-        bool      m_IsCloseRequested = false;
+        HINSTANCE     m_hinstance;
+        HWND          m_Handle;
+        bool          m_IsCloseRequested = false;
+        EventQueue    m_Events;
+        PresentPolicy m_InitialPresentPolicy;
     };
 
 } // namespace vke
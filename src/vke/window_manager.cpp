@@ -5,11 +5,11 @@
 #include "vke/window_manager.hpp"
 
 namespace vke {
-    void WindowManager::add(const std::shared_ptr<Window>& window) {
+    void WindowManager::add(const std::shared_ptr<Window>& window, const PresentPolicy present_policy) {
         assert(!m_Windows.contains(window) && "Cannot add a window multiple times");
 
         WindowData data{};
-        data.surface      = Surface::create(window);
+        data.surface      = Surface::create(window, present_policy);
         m_Windows[window] = data;
     }
 
@@ -20,7 +20,7 @@ namespace vke {
 
     class VKE_API WindowManager {
       public:
-        void add(const std::shared_ptr<Window>& window);
+        void add(const std::shared_ptr<Window>& window, PresentPolicy present_policy = PresentPolicy::Throughput);
         void remove(const std::shared_ptr<Window>& window);
 
         [[nodiscard]] std::size_t              count() const noexcept;
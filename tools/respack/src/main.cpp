@@ -0,0 +1,103 @@
+//
+// Created by andy on 3/27/2025.
+//
+
+#include "vke/resource/archive.hpp"
+
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Manifest format: one resource per line, `<marker id> <type> <path>`, with paths relative to the manifest. `#` starts a comment.
+// Resources are packed in manifest order, so list resources which are loaded together next to each other.
+//
+// `compress <type> <none|lz4|zstd> [level]` sets the compression for resources of that type listed after it.
+
+static std::vector<std::byte> read_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) { throw std::runtime_error("Failed to open " + path.string()); }
+
+    std::vector<std::byte> data(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!file) { throw std::runtime_error("Failed to read " + path.string()); }
+
+    return data;
+}
+
+static vke::res::ArchiveCompression parse_compression(const std::string& text, const std::size_t line_number) {
+    if (text == "none") { return vke::res::ArchiveCompression::None; }
+    if (text == "lz4") { return vke::res::ArchiveCompression::Lz4; }
+    if (text == "zstd") { return vke::res::ArchiveCompression::Zstd; }
+    throw std::runtime_error("Line " + std::to_string(line_number) + ": unknown compression " + text);
+}
+
+template <typename T>
+static T parse_number(const std::string& text, const std::size_t line_number) {
+    const bool  hex   = text.starts_with("0x");
+    const char* begin = text.data() + (hex ? 2 : 0);
+
+    T value{};
+    const auto [end, error] = std::from_chars(begin, text.data() + text.size(), value, hex ? 16 : 10);
+    if (error != std::errc{} || end != text.data() + text.size()) { throw std::runtime_error("Line " + std::to_string(line_number) + ": bad number " + text); }
+    return value;
+}
+
+int main(const int argc, char** argv) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "Usage: respack <manifest> <output> [payload alignment]" << std::endl;
+        return 1;
+    }
+
+    try {
+        const std::filesystem::path manifest_path = argv[1];
+        const uint32_t              alignment     = argc == 4 ? parse_number<uint32_t>(argv[3], 0) : vke::res::DEFAULT_ARCHIVE_ALIGNMENT;
+
+        std::ifstream manifest(manifest_path);
+        if (!manifest) { throw std::runtime_error("Failed to open " + manifest_path.string()); }
+
+        vke::res::ArchiveWriter writer(alignment);
+
+        std::string line;
+        std::size_t line_number = 0;
+        while (std::getline(manifest, line)) {
+            line_number++;
+            if (const auto comment = line.find('#'); comment != std::string::npos) { line.erase(comment); }
+
+            std::istringstream stream(line);
+            std::string        marker_id, type, path;
+            if (!(stream >> marker_id)) { continue; }
+
+            if (marker_id == "compress") {
+                std::string compression;
+                int         level = 0;
+                if (!(stream >> type >> compression)) {
+                    throw std::runtime_error("Line " + std::to_string(line_number) + ": expected compress <type> <none|lz4|zstd> [level]");
+                }
+                stream >> level;
+                writer.set_compression(parse_number<uint32_t>(type, line_number), {parse_compression(compression, line_number), level});
+                continue;
+            }
+
+            if (!(stream >> type) || !(stream >> std::ws) || !std::getline(stream, path)) {
+                throw std::runtime_error("Line " + std::to_string(line_number) + ": expected <marker id> <type> <path>");
+            }
+            path.erase(path.find_last_not_of(" \t\r") + 1);
+
+            const auto data = read_file(manifest_path.parent_path() / path);
+            writer.add(parse_number<uint64_t>(marker_id, line_number), parse_number<uint32_t>(type, line_number), data);
+        }
+
+        writer.write(argv[2]);
+        std::cout << "Packed " << writer.entry_count() << " resources into " << argv[2] << " (" << writer.stored_size() << " of "
+                  << writer.uncompressed_size() << " bytes)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "respack: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+//
+// Created by andy on 3/30/2025.
+//
+
+#include "vke/global.hpp"
+#include "vke/renderer/shader_compiler.hpp"
+#include "vke/utils/job_system.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Compiles each source to `<source>.spv` next to it (so res/shaders/test.vert becomes test.vert.spv), in parallel. The stage and language come from
+// the file name, see vke::ShaderSource::from_file.
+//
+// With `--cache <dir>` results also go into (and come from) a shader cache, which can be shipped so the engine never has to compile at startup.
+
+int main(const int argc, char** argv) {
+    std::vector<vke::ShaderDefine>     defines;
+    std::vector<std::filesystem::path> paths;
+    std::filesystem::path              cache_directory;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--cache" && i + 1 < argc) {
+            cache_directory = argv[++i];
+        } else if (argument.starts_with("-D") && argument.size() > 2) {
+            const auto equals = argument.find('=');
+            if (equals == std::string::npos) {
+                defines.push_back({argument.substr(2), "1"});
+            } else {
+                defines.push_back({argument.substr(2, equals - 2), argument.substr(equals + 1)});
+            }
+        } else {
+            paths.emplace_back(argument);
+        }
+    }
+
+    if (paths.empty()) {
+        std::cerr << "Usage: shaderc [-D<name>[=<value>]]... [--cache <dir>] <source>..." << std::endl;
+        return 1;
+    }
+
+    try {
+        vke::global::g_JobSystem = std::make_shared<vke::JobSystem>();
+
+        std::vector<vke::ShaderSource> sources;
+        for (const auto& path : paths) { sources.push_back(vke::ShaderSource::from_file(path, defines)); }
+
+        vke::ShaderCompiler compiler({cache_directory});
+        const auto          results = compiler.compile(sources);
+
+        for (std::size_t i = 0; i < sources.size(); i++) {
+            const auto    output = std::filesystem::path(sources[i].path).concat(".spv");
+            std::ofstream file(output, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(results[i].data()), static_cast<std::streamsize>(results[i].size() * sizeof(uint32_t)));
+            if (!file) { throw std::runtime_error("Failed to write " + output.string()); }
+        }
+
+        std::cout << "Compiled " << sources.size() << " shaders with " << vke::ShaderCompiler::version() << " (" << compiler.cache_hits()
+                  << " from the cache)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "shaderc: " << e.what() << std::endl;
+        vke::global::g_JobSystem.reset();
+        return 1;
+    }
+
+    vke::global::g_JobSystem.reset();
+    return 0;
+}